@@ -0,0 +1,80 @@
+#ifndef RESIN_AABB_HPP
+#define RESIN_AABB_HPP
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <utility>
+
+namespace resin {
+
+/*
+  Axis-aligned bounding box. A default constructed box is empty, expanding it with a point makes it contain the point.
+*/
+struct Aabb {
+  glm::vec3 min{std::numeric_limits<float>::infinity()};
+  glm::vec3 max{-std::numeric_limits<float>::infinity()};
+
+  Aabb() = default;
+  Aabb(const glm::vec3& min_corner, const glm::vec3& max_corner) : min(min_corner), max(max_corner) {}
+
+  bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+  glm::vec3 center() const { return (min + max) * 0.5F; }
+  glm::vec3 size() const { return max - min; }
+
+  void expand(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+  void expand(const Aabb& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  bool contains(const glm::vec3& point) const {
+    return point.x >= min.x && point.y >= min.y && point.z >= min.z && point.x <= max.x && point.y <= max.y &&
+           point.z <= max.z;
+  }
+  bool intersects(const Aabb& other) const {
+    return min.x <= other.max.x && min.y <= other.max.y && min.z <= other.max.z && other.min.x <= max.x &&
+           other.min.y <= max.y && other.min.z <= max.z;
+  }
+
+  // Distance between the closest points of the boxes, 0 if they intersect.
+  float distance(const Aabb& other) const {
+    const glm::vec3 gap = glm::max(glm::max(other.min - max, min - other.max), glm::vec3(0.0F));
+    return glm::length(gap);
+  }
+
+  // Bounds of the box transformed by an affine matrix.
+  Aabb transformed(const glm::mat4& matrix) const {
+    // The extents of the result are the absolute values of the matrix times the extents of the box
+    const glm::vec3 half = size() * 0.5F;
+    const glm::vec3 c    = glm::vec3(matrix * glm::vec4(center(), 1.0F));
+    glm::vec3 extent(0.0F);
+    for (glm::length_t column = 0; column < 3; ++column) {
+      extent += glm::abs(glm::vec3(matrix[column])) * half[column];
+    }
+    return {c - extent, c + extent};
+  }
+
+  // Clips the ray interval [`near`, `far`] to the box and returns whether anything is left of it. `inv_direction` is
+  // the component-wise inverse of the ray direction.
+  bool clip_ray(const glm::vec3& origin, const glm::vec3& inv_direction, float& near, float& far) const {
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+      float t0 = (min[axis] - origin[axis]) * inv_direction[axis];
+      float t1 = (max[axis] - origin[axis]) * inv_direction[axis];
+      if (t0 > t1) {
+        std::swap(t0, t1);
+      }
+      // Written so that NaNs (a zero direction on the box plane) keep the interval unchanged
+      near = t0 > near ? t0 : near;
+      far  = t1 < far ? t1 : far;
+    }
+    return near <= far;
+  }
+};
+
+}  // namespace resin
+#endif  // RESIN_AABB_HPP
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+#include <libresin/core/compact_transform.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/core/transform_batch.hpp>
+#include <libresin/core/transform_hierarchy.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+namespace {
+
+constexpr uint16_t kQuatBits    = 15;
+constexpr uint16_t kQuatMask    = (1U << kQuatBits) - 1;
+constexpr uint16_t kQuatHighBit = 1U << kQuatBits;
+// Symmetric around zero, so that identity rotations are stored exactly
+constexpr float kQuatSteps = 16383.0F;
+// The smallest three components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+constexpr float kQuatRange = 0.70710678118F;
+
+uint16_t quantize(float value) {
+  const float normalized = std::clamp(value / kQuatRange, -1.0F, 1.0F);
+  return static_cast<uint16_t>(std::lround(normalized * kQuatSteps + kQuatSteps));
+}
+
+float dequantize(uint16_t value) {
+  return (static_cast<float>(value & kQuatMask) - kQuatSteps) / kQuatSteps * kQuatRange;
+}
+
+}  // namespace
+
+std::array<uint16_t, 3> pack_quat(const glm::quat& rot) {
+  const glm::quat normalized = glm::normalize(rot);
+  std::array<float, 4> comps = {normalized.x, normalized.y, normalized.z, normalized.w};
+
+  size_t largest = 0;
+  for (size_t i = 1; i < comps.size(); ++i) {
+    if (std::abs(comps[i]) > std::abs(comps[largest])) {
+      largest = i;
+    }
+  }
+
+  // q and -q represent the same rotation, so the sign of the dropped component can be fixed to positive
+  const float sign = comps[largest] < 0.0F ? -1.0F : 1.0F;
+
+  std::array<uint16_t, 3> packed{};
+  for (size_t i = 0, j = 0; i < comps.size(); ++i) {
+    if (i != largest) {
+      packed[j++] = quantize(sign * comps[i]);
+    }
+  }
+
+  // The index of the largest component is stored in the high bits of the first two values
+  packed[0] = static_cast<uint16_t>(packed[0] | ((largest & 2U) != 0 ? kQuatHighBit : 0U));
+  packed[1] = static_cast<uint16_t>(packed[1] | ((largest & 1U) != 0 ? kQuatHighBit : 0U));
+  return packed;
+}
+
+glm::quat unpack_quat(const std::array<uint16_t, 3>& packed) {
+  const size_t largest = ((packed[0] & kQuatHighBit) != 0 ? 2U : 0U) | ((packed[1] & kQuatHighBit) != 0 ? 1U : 0U);
+
+  std::array<float, 4> comps{};
+  float sum_sq = 0.0F;
+  for (size_t i = 0, j = 0; i < comps.size(); ++i) {
+    if (i != largest) {
+      comps[i] = dequantize(packed[j++]);
+      sum_sq += comps[i] * comps[i];
+    }
+  }
+  comps[largest] = std::sqrt(std::max(0.0F, 1.0F - sum_sq));
+
+  return {comps[3], comps[0], comps[1], comps[2]};
+}
+
+AffineMatrix::AffineMatrix(const glm::mat4& mat) {
+  for (glm::length_t r = 0; r < 3; ++r) {
+    rows[static_cast<size_t>(r)] = glm::vec4(mat[0][r], mat[1][r], mat[2][r], mat[3][r]);
+  }
+}
+
+glm::mat4 AffineMatrix::to_mat4() const {
+  glm::mat4 mat(1.0F);
+  for (glm::length_t r = 0; r < 3; ++r) {
+    const glm::vec4& row = rows[static_cast<size_t>(r)];
+    mat[0][r]            = row.x;
+    mat[1][r]            = row.y;
+    mat[2][r]            = row.z;
+    mat[3][r]            = row.w;
+  }
+  return mat;
+}
+
+glm::vec3 AffineMatrix::transform_point(const glm::vec3& point) const {
+  const glm::vec4 p(point, 1.0F);
+  return {glm::dot(rows[0], p), glm::dot(rows[1], p), glm::dot(rows[2], p)};
+}
+
+AffineMatrix AffineMatrix::operator*(const AffineMatrix& other) const {
+  AffineMatrix result;
+  for (size_t r = 0; r < 3; ++r) {
+    const glm::vec4& row = rows[r];
+    result.rows[r] = row.x * other.rows[0] + row.y * other.rows[1] + row.z * other.rows[2] + glm::vec4(0, 0, 0, row.w);
+  }
+  return result;
+}
+
+CompactTransform::CompactTransform(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale)
+    : pos_(pos), rot_(pack_quat(rot)), scale_() {
+  set_local_scale(scale);
+}
+
+CompactTransform::CompactTransform(const Transform& transform)
+    : CompactTransform(transform.local_pos(), transform.local_rot(), transform.local_scale()) {}
+
+glm::vec3 CompactTransform::local_scale() const {
+  return {glm::unpackHalf1x16(scale_[0]), glm::unpackHalf1x16(scale_[1]), glm::unpackHalf1x16(scale_[2])};
+}
+
+void CompactTransform::set_local_scale(const glm::vec3& scale) {
+  scale_ = {glm::packHalf1x16(scale.x), glm::packHalf1x16(scale.y), glm::packHalf1x16(scale.z)};
+}
+
+glm::mat4 CompactTransform::local_to_parent_matrix() const {
+  return compose_trs(pos_, local_rot(), local_scale());
+}
+
+AffineMatrix CompactTransform::local_to_parent_affine() const { return AffineMatrix(local_to_parent_matrix()); }
+
+void CompactTransformArray::assign(const TransformHierarchy& hierarchy) {
+  if (hierarchy.needs_update()) {
+    throw std::invalid_argument("CompactTransformArray: hierarchy has to be updated before it is compacted");
+  }
+
+  const auto parents   = hierarchy.parent_slots();
+  const auto positions = hierarchy.local_positions();
+  const auto rotations = hierarchy.local_rotations();
+  const auto scales    = hierarchy.local_scales();
+
+  clear();
+  locals_.reserve(parents.size());
+  parents_.reserve(parents.size());
+  for (size_t i = 0; i < parents.size(); ++i) {
+    locals_.emplace_back(positions[i], rotations[i], scales[i]);
+    parents_.push_back(parents[i] == TransformHierarchy::kInvalidSlot ? kNoParent : parents[i]);
+  }
+  world_.resize(locals_.size());
+}
+
+uint32_t CompactTransformArray::push_back(const CompactTransform& transform, uint32_t parent) {
+  if (parent != kNoParent && parent >= locals_.size()) {
+    throw std::invalid_argument("CompactTransformArray: parent has to be placed before its children");
+  }
+
+  locals_.push_back(transform);
+  parents_.push_back(parent);
+  world_.emplace_back();
+  return static_cast<uint32_t>(locals_.size() - 1);
+}
+
+void CompactTransformArray::clear() {
+  locals_.clear();
+  parents_.clear();
+  world_.clear();
+}
+
+void CompactTransformArray::update() {
+  for (size_t i = 0; i < locals_.size(); ++i) {
+    const AffineMatrix local = locals_[i].local_to_parent_affine();
+    world_[i]                = parents_[i] == kNoParent ? local : world_[parents_[i]] * local;
+  }
+}
+
+}  // namespace resin
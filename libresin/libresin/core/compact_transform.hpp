@@ -0,0 +1,97 @@
+#ifndef RESIN_COMPACT_TRANSFORM_HPP
+#define RESIN_COMPACT_TRANSFORM_HPP
+#define GLM_ENABLE_EXPERIMENTAL
+#include <array>
+#include <cstdint>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+struct Transform;
+class TransformHierarchy;
+
+// Packs a rotation with the "smallest three" method: 2 bits for the index of the largest component and 15 bits for
+// each of the remaining ones (the maximum error of a component is ~2.2e-5).
+std::array<uint16_t, 3> pack_quat(const glm::quat& rot);
+glm::quat unpack_quat(const std::array<uint16_t, 3>& packed);
+
+/*
+  Affine matrix stored as its upper 3 rows (48 bytes instead of 64 bytes of `glm::mat4`). The layout matches a
+  `mat3x4` with row-major storage, so the arrays can be uploaded to the GPU as they are.
+*/
+struct AffineMatrix {
+  std::array<glm::vec4, 3> rows = {glm::vec4(1, 0, 0, 0), glm::vec4(0, 1, 0, 0), glm::vec4(0, 0, 1, 0)};
+
+  AffineMatrix() = default;
+  explicit AffineMatrix(const glm::mat4& mat);
+
+  glm::mat4 to_mat4() const;
+  glm::vec3 transform_point(const glm::vec3& point) const;
+
+  AffineMatrix operator*(const AffineMatrix& other) const;
+};
+
+/*
+  Local position, rotation and scale of a transform packed into 24 bytes: full precision position, quantized rotation
+  (see `pack_quat`) and half precision scale.
+*/
+class CompactTransform {
+ public:
+  explicit CompactTransform(const glm::vec3& pos = glm::vec3(), const glm::quat& rot = {1, 0, 0, 0},
+                            const glm::vec3& scale = {1, 1, 1});
+  explicit CompactTransform(const Transform& transform);
+
+  const glm::vec3& local_pos() const { return pos_; }
+  glm::quat local_rot() const { return unpack_quat(rot_); }
+  glm::vec3 local_scale() const;
+
+  void set_local_pos(const glm::vec3& pos) { pos_ = pos; }
+  void set_local_rot(const glm::quat& rot) { rot_ = pack_quat(rot); }
+  void set_local_scale(const glm::vec3& scale);
+
+  glm::mat4 local_to_parent_matrix() const;
+  AffineMatrix local_to_parent_affine() const;
+
+ private:
+  glm::vec3 pos_;
+  std::array<uint16_t, 3> rot_;
+  std::array<uint16_t, 3> scale_;
+};
+
+/*
+  Compact, flat snapshot of a transform hierarchy meant for very large scenes. Every transform has to be placed after
+  its parent. World matrices are kept as `AffineMatrix`es and decompressed on demand.
+*/
+class CompactTransformArray {
+ public:
+  static constexpr uint32_t kNoParent = UINT32_MAX;
+
+  // Replaces the content with the depth sorted nodes of the hierarchy (the indices are the hierarchy slots). The
+  // hierarchy has to be updated beforehand.
+  void assign(const TransformHierarchy& hierarchy);
+  uint32_t push_back(const CompactTransform& transform, uint32_t parent = kNoParent);
+  void clear();
+
+  size_t size() const { return locals_.size(); }
+  CompactTransform& local(uint32_t index) { return locals_[index]; }
+  const CompactTransform& local(uint32_t index) const { return locals_[index]; }
+
+  // Recomputes all world matrices in a single linear pass.
+  void update();
+
+  glm::mat4 local_to_world_matrix(uint32_t index) const { return world_[index].to_mat4(); }
+  std::span<const AffineMatrix> world_matrices() const { return world_; }
+
+ private:
+  std::vector<CompactTransform> locals_;
+  std::vector<uint32_t> parents_;
+  std::vector<AffineMatrix> world_;
+};
+
+}  // namespace resin
+#endif  // RESIN_COMPACT_TRANSFORM_HPP
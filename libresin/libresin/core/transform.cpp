@@ -2,156 +2,79 @@
 #include <glm/geometric.hpp>
 #include <glm/gtx/transform.hpp>
 #include <libresin/core/transform.hpp>
+#include <stdexcept>
 
 namespace resin {
 
-Transform::~Transform() {
-  for (const auto child : children_) {
-    child.get().parent_.reset();
+void Transform::set_parent(const std::optional<std::reference_wrapper<Transform>> parent) {
+  if (!parent.has_value()) {
+    hierarchy_->set_parent(id_, std::nullopt);
+    return;
   }
 
-  if (parent_.has_value()) {
-    remove_from_parent();
+  if (parent->get().hierarchy_ != hierarchy_) {
+    throw std::invalid_argument("Cannot parent a transform to a transform of another hierarchy");
   }
+  hierarchy_->set_parent(id_, parent->get().id_);
 }
 
-void Transform::set_parent(const std::optional<std::reference_wrapper<Transform>> parent) {
-  // clear reference from old parent
-  if (parent_.has_value()) {
-    remove_from_parent();
-  }
-
-  mark_dirty();
-  if (!parent.has_value()) {
-    return;
+void Transform::reparent(const std::span<Transform* const> transforms, Transform& parent) {
+  for (Transform* transform : transforms) {
+    transform->set_parent(parent);
   }
-
-  // setup reference in new parent
-  parent_ = parent;
-  parent_->get().children_.emplace_back(*this);
 }
 
 void Transform::rotate(const glm::vec3& axis, const float angle) {
-  rot_ = glm::rotate(rot_, angle, axis);
-  mark_dirty();
+  set_local_rot(glm::rotate(local_rot(), angle, axis));
 }
 
-void Transform::rotate(const glm::quat& rotation) {
-  rot_ = glm::normalize(rotation * rot_);
-  mark_dirty();
-}
+void Transform::rotate(const glm::quat& rotation) { set_local_rot(glm::normalize(rotation * local_rot())); }
 
-void Transform::rotate_local(const glm::quat& rotation) {
-  rot_ = glm::normalize(rot_ * rotation);
-  mark_dirty();
-}
+void Transform::rotate_local(const glm::quat& rotation) { set_local_rot(glm::normalize(local_rot() * rotation)); }
 
 glm::vec3 Transform::pos() const {
-  return parent_.has_value() ? glm::vec3(parent().local_to_world_matrix() * glm::vec4(pos_, 1.0F)) : pos_;
-}
-
-void Transform::set_local_pos(const glm::vec3& pos) {
-  pos_ = pos;
-  mark_dirty();
-}
-
-glm::quat Transform::rot() const { return parent_.has_value() ? parent().rot() * rot_ : rot_; }
-
-void Transform::set_local_rot(const glm::quat& rot) {
-  rot_ = rot;
-  mark_dirty();
+  return has_parent() ? glm::vec3(parent().local_to_world_matrix() * glm::vec4(local_pos(), 1.0F)) : local_pos();
 }
 
-void Transform::set_local_scale(const glm::vec3& scale) {
-  scale_ = scale;
-  mark_dirty();
-}
-
-void Transform::set_local_scale(const float scale) {
-  scale_ = glm::vec3(scale);
-  mark_dirty();
-}
+glm::quat Transform::rot() const { return has_parent() ? parent().rot() * local_rot() : local_rot(); }
 
 glm::mat3 Transform::local_orientation() const {
-  const glm::mat3 local = glm::toMat3(rot_);
+  const glm::mat3 local = glm::toMat3(local_rot());
   return glm::mat3(local[0], local[1], -local[2]);
 }
 
 glm::mat3 Transform::orientation() const {
   const glm::mat3 local = local_orientation();
-  if (!parent_) {
+  if (!has_parent()) {
     return local;
   }
   const glm::mat3 orientation = glm::mat3(parent().local_to_world_matrix()) * local;
   return glm::mat3(glm::normalize(orientation[0]), glm::normalize(orientation[1]), glm::normalize(orientation[2]));
 }
 
-glm::vec3 Transform::front() const {
-  const glm::vec3 local = local_front();
-  return parent_ ? glm::normalize(parent().local_to_world_matrix() * glm::vec4(local, 0.0F)) : local;
-}
+glm::vec3 Transform::front() const { return parent_direction(local_front()); }
 
-glm::vec3 Transform::right() const {
-  const glm::vec3 local = local_right();
-  return parent_ ? glm::normalize(parent().local_to_world_matrix() * glm::vec4(local, 0.0F)) : local;
-}
+glm::vec3 Transform::right() const { return parent_direction(local_right()); }
 
-glm::vec3 Transform::up() const {
-  const glm::vec3 local = local_up();
-  return parent_ ? glm::normalize(parent().local_to_world_matrix() * glm::vec4(local, 0.0F)) : local;
-}
+glm::vec3 Transform::up() const { return parent_direction(local_up()); }
 
-glm::mat4 Transform::local_to_parent_matrix() const {
-  return glm::translate(pos_) * glm::mat4_cast(rot_) * glm::scale(scale_);
+glm::mat4 Transform::local_to_world_matrix() const {
+  hierarchy_->update_if_needed();
+  return hierarchy_->world_matrices()[hierarchy_->slot(id_)];
 }
 
-glm::mat4 Transform::parent_to_local_matrix() const {
-  return glm::scale(1.0F / scale_) * glm::mat4_cast(glm::inverse(rot_)) * glm::translate(-pos_);
+glm::mat4 Transform::world_to_local_matrix() const {
+  hierarchy_->update_if_needed();
+  return hierarchy_->inv_world_matrices()[hierarchy_->slot(id_)];
 }
 
-const glm::mat4& Transform::local_to_world_matrix() const {
-  if (!dirty_) {
-    return model_mat_;
-  }
-
-  model_mat_ = local_to_parent_matrix();
-  if (parent_) {
-    model_mat_ = parent_->get().local_to_world_matrix() * model_mat_;
-  }
-
-  dirty_ = false;
-  return model_mat_;
+uint32_t Transform::generation() const {
+  hierarchy_->update_if_needed();
+  return hierarchy_->generation(id_);
 }
 
-const glm::mat4& Transform::world_to_local_matrix() const {
-  if (!inv_dirty_) {
-    return inv_model_mat_;
-  }
-
-  inv_model_mat_ = parent_to_local_matrix();
-  if (parent_) {
-    inv_model_mat_ *= parent_->get().world_to_local_matrix();
-  }
-
-  inv_dirty_ = false;
-  return inv_model_mat_;
-}
-
-void Transform::mark_dirty() const {
-  if (dirty_ && inv_dirty_) {
-    return;
-  }
-
-  dirty_ = inv_dirty_ = true;
-  for (const auto child : children_) {
-    child.get().mark_dirty();
-  }
-}
-
-void Transform::remove_from_parent() {
-  std::erase_if(parent_->get().children_, [this](auto ref) { return std::addressof(ref.get()) == this; });
-
-  parent_.reset();
+glm::vec3 Transform::parent_direction(const glm::vec3& local) const {
+  return has_parent() ? glm::normalize(parent().local_to_world_matrix() * glm::vec4(local, 0.0F)) : local;
 }
 
 }  // namespace resin
@@ -1,56 +1,84 @@
 #ifndef RESIN_TRANSFORM_HPP
 #define RESIN_TRANSFORM_HPP
 #define GLM_ENABLE_EXPERIMENTAL
+#include <cstdint>
 #include <functional>
 #include <glm/gtx/quaternion.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <libresin/core/transform_hierarchy.hpp>
 #include <optional>
+#include <span>
 
 namespace resin {
 
+/*
+  Lightweight handle to a node of a `TransformHierarchy`, which stores the components and the cached world matrices of
+  all its transforms in contiguous arrays. The node is created with the transform and destroyed with it (the children
+  become roots), so the transform is referenced by address (e.g. by the primitives of an `SdfTree`).
+
+  The world matrices are updated lazily for the whole hierarchy by the first read after a change. The const getters may
+  be called concurrently from many threads (e.g. a parallel culling pass), one of them updates the hierarchy while the
+  others wait for the result. Modifications must not run concurrently with anything else on the same hierarchy.
+*/
 struct Transform final {
  public:
   explicit Transform(const glm::vec3 pos = glm::vec3(), const glm::quat rot = {1, 0, 0, 0},
                      const glm::vec3 scale = {1, 1, 1})
-      : pos_(pos), rot_(rot), scale_(scale), dirty_(true), inv_dirty_(true) {}
-  ~Transform();
+      : Transform(TransformHierarchy::default_instance(), pos, rot, scale) {}
+  explicit Transform(TransformHierarchy& hierarchy, const glm::vec3 pos = glm::vec3(),
+                     const glm::quat rot = {1, 0, 0, 0}, const glm::vec3 scale = {1, 1, 1})
+      : hierarchy_(&hierarchy), id_(hierarchy.create(*this, pos, rot, scale)) {}
+  ~Transform() { hierarchy_->destroy(id_); }
+
+  TransformHierarchy& hierarchy() const { return *hierarchy_; }
+  TransformHierarchy::NodeId id() const { return id_; }
 
-  bool has_parent() const { return parent_.has_value(); }
-  const Transform& parent() const { return *parent_; }
+  bool has_parent() const { return hierarchy_->parent(id_) != TransformHierarchy::kInvalidNode; }
+  const Transform& parent() const { return hierarchy_->transform(hierarchy_->parent(id_)); }
+  // Throws `std::invalid_argument` if the parent belongs to another hierarchy or is this transform or its descendant.
   void set_parent(std::optional<std::reference_wrapper<Transform>> parent);
+  // Moves all the transforms under the new parent. Each move is O(1), regardless of the number of siblings.
+  static void reparent(std::span<Transform* const> transforms, Transform& parent);
 
   void rotate(const glm::vec3& axis, float angle);
   void rotate(const glm::quat& rotation);
   void rotate_local(const glm::quat& rotation);
 
-  const glm::vec3& local_pos() const { return pos_; }
-  glm::vec3& local_pos() { return pos_; }
+  // The non-const accessors mark the transform as changed, the references are valid until a transform of the hierarchy
+  // is created or destroyed or the hierarchy is updated.
+  const glm::vec3& local_pos() const { return hierarchy_->local_pos(id_); }
+  glm::vec3& local_pos() { return hierarchy_->edit_local_pos(id_); }
   glm::vec3 pos() const;
-  void set_local_pos(const glm::vec3& pos);
+  void set_local_pos(const glm::vec3& pos) { hierarchy_->set_local_pos(id_, pos); }
 
-  const glm::quat& local_rot() const { return rot_; }
-  glm::quat& local_rot() { return rot_; }
+  const glm::quat& local_rot() const { return hierarchy_->local_rot(id_); }
+  glm::quat& local_rot() { return hierarchy_->edit_local_rot(id_); }
   glm::quat rot() const;
-  void set_local_rot(const glm::quat& rot);
+  void set_local_rot(const glm::quat& rot) { hierarchy_->set_local_rot(id_, rot); }
 
-  const glm::vec3& local_scale() const { return scale_; }
-  glm::vec3& local_scale() { return scale_; }
-  void set_local_scale(const glm::vec3& scale);
-  void set_local_scale(float scale);
+  const glm::vec3& local_scale() const { return hierarchy_->local_scale(id_); }
+  glm::vec3& local_scale() { return hierarchy_->edit_local_scale(id_); }
+  void set_local_scale(const glm::vec3& scale) { hierarchy_->set_local_scale(id_, scale); }
+  void set_local_scale(float scale) { set_local_scale(glm::vec3(scale)); }
 
   glm::mat3 local_orientation() const;
   glm::mat3 orientation() const;
-  glm::vec3 local_front() const { return rot_ * glm::vec3(0, 0, -1); }
+  glm::vec3 local_front() const { return local_rot() * glm::vec3(0, 0, -1); }
   glm::vec3 front() const;
-  glm::vec3 local_right() const { return rot_ * glm::vec3(1, 0, 0); }
+  glm::vec3 local_right() const { return local_rot() * glm::vec3(1, 0, 0); }
   glm::vec3 right() const;
-  glm::vec3 local_up() const { return rot_ * glm::vec3(0, 1, 0); }
+  glm::vec3 local_up() const { return local_rot() * glm::vec3(0, 1, 0); }
   glm::vec3 up() const;
 
-  glm::mat4 local_to_parent_matrix() const;
-  glm::mat4 parent_to_local_matrix() const;
-  const glm::mat4& local_to_world_matrix() const;
-  const glm::mat4& world_to_local_matrix() const;
+  glm::mat4 local_to_parent_matrix() const { return hierarchy_->local_to_parent_matrix(id_); }
+  glm::mat4 parent_to_local_matrix() const { return hierarchy_->parent_to_local_matrix(id_); }
+  glm::mat4 local_to_world_matrix() const;
+  glm::mat4 world_to_local_matrix() const;
+
+  // Changes every time the world matrices of this transform change.
+  uint32_t generation() const;
 
   Transform(const Transform&)            = delete;
   Transform(Transform&&)                 = delete;
@@ -58,21 +86,11 @@ struct Transform final {
   Transform& operator=(Transform&&)      = delete;
 
  private:
-  void remove_from_parent();
-  void mark_dirty() const;
+  glm::vec3 parent_direction(const glm::vec3& local) const;
 
  private:
-  std::optional<std::reference_wrapper<Transform>> parent_;
-  std::vector<std::reference_wrapper<Transform>> children_;
-
-  glm::vec3 pos_;
-  glm::quat rot_;
-  glm::vec3 scale_;
-
-  mutable bool dirty_              = false;
-  mutable glm::mat4 model_mat_     = glm::mat4(1.0F);
-  mutable bool inv_dirty_          = false;
-  mutable glm::mat4 inv_model_mat_ = glm::mat4(1.0F);
+  TransformHierarchy* hierarchy_;
+  TransformHierarchy::NodeId id_;
 };  // class Transform
 
 }  // namespace resin
@@ -0,0 +1,242 @@
+#include <cstddef>
+#include <libresin/core/transform_batch.hpp>
+#include <libresin/utils/simd.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+namespace {
+
+using namespace simd;  // NOLINT(google-build-using-namespace)
+
+// Memory order of the quaternion components
+#ifdef GLM_FORCE_QUAT_DATA_WXYZ
+constexpr int kQuatX = 1, kQuatY = 2, kQuatZ = 3, kQuatW = 0;
+#else
+constexpr int kQuatX = 0, kQuatY = 1, kQuatZ = 2, kQuatW = 3;
+#endif
+
+static_assert(sizeof(glm::quat) == 4 * sizeof(float), "The SIMD kernels load quaternions as 4 packed floats");
+
+// First component in memory, the lanes loaded from it follow the `kQuat*` order
+inline const float* quat_data(const glm::quat& q) { return reinterpret_cast<const float*>(&q); }
+
+/*
+  The kernels are written once against a "lane" type, which is either `float` (scalar fallback) or one of the thin SIMD
+  wrappers below. Matrices are produced as `m[column][row]` for the upper 3x4 part, the last row is always (0,0,0,1).
+*/
+
+template <typename V>
+void rotation_lanes(const V& x, const V& y, const V& z, const V& w, V (&r)[3][3]) {
+  const V one(1.0F);
+  const V two(2.0F);
+  const V xx = x * x, yy = y * y, zz = z * z;
+  const V xy = x * y, xz = x * z, yz = y * z;
+  const V wx = w * x, wy = w * y, wz = w * z;
+
+  r[0][0] = one - two * (yy + zz);
+  r[0][1] = two * (xy + wz);
+  r[0][2] = two * (xz - wy);
+
+  r[1][0] = two * (xy - wz);
+  r[1][1] = one - two * (xx + zz);
+  r[1][2] = two * (yz + wx);
+
+  r[2][0] = two * (xz + wy);
+  r[2][1] = two * (yz - wx);
+  r[2][2] = one - two * (xx + yy);
+}
+
+template <typename V>
+void trs_lanes(const V (&p)[3], const V (&q)[4], const V (&s)[3], V (&m)[4][3]) {
+  V r[3][3];
+  rotation_lanes(q[kQuatX], q[kQuatY], q[kQuatZ], q[kQuatW], r);
+
+  for (int c = 0; c < 3; ++c) {
+    for (int i = 0; i < 3; ++i) {
+      m[c][i] = r[c][i] * s[c];
+    }
+  }
+  for (int i = 0; i < 3; ++i) {
+    m[3][i] = p[i];
+  }
+}
+
+template <typename V>
+void inverse_trs_lanes(const V (&p)[3], const V (&q)[4], const V (&s)[3], V (&m)[4][3]) {
+  // inverse(q) = conjugate(q) / dot(q, q)
+  const V zero(0.0F);
+  const V one(1.0F);
+  const V& x     = q[kQuatX];
+  const V& y     = q[kQuatY];
+  const V& z     = q[kQuatZ];
+  const V& w     = q[kQuatW];
+  const V inv_sq = one / (x * x + y * y + z * z + w * w);
+
+  V r[3][3];
+  rotation_lanes(zero - x * inv_sq, zero - y * inv_sq, zero - z * inv_sq, w * inv_sq, r);
+
+  // S^-1 * R^-1 scales the rows, T^-1 is folded into the last column
+  const V inv_s[3] = {one / s[0], one / s[1], one / s[2]};
+  for (int c = 0; c < 3; ++c) {
+    for (int i = 0; i < 3; ++i) {
+      m[c][i] = r[c][i] * inv_s[i];
+    }
+  }
+  for (int i = 0; i < 3; ++i) {
+    m[3][i] = zero - (m[0][i] * p[0] + m[1][i] * p[1] + m[2][i] * p[2]);
+  }
+}
+
+template <bool Inverse, typename V>
+void compose_lanes(const V (&p)[3], const V (&q)[4], const V (&s)[3], V (&m)[4][3]) {
+  if constexpr (Inverse) {
+    inverse_trs_lanes(p, q, s, m);
+  } else {
+    trs_lanes(p, q, s, m);
+  }
+}
+
+template <bool Inverse>
+glm::mat4 compose_scalar(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale) {
+  const float p[3] = {pos.x, pos.y, pos.z};
+  const float s[3] = {scale.x, scale.y, scale.z};
+  float q[4];
+  q[kQuatX] = rot.x;
+  q[kQuatY] = rot.y;
+  q[kQuatZ] = rot.z;
+  q[kQuatW] = rot.w;
+
+  float m[4][3];
+  compose_lanes<Inverse>(p, q, s, m);
+  return {glm::vec4(m[0][0], m[0][1], m[0][2], 0.0F), glm::vec4(m[1][0], m[1][1], m[1][2], 0.0F),
+          glm::vec4(m[2][0], m[2][1], m[2][2], 0.0F), glm::vec4(m[3][0], m[3][1], m[3][2], 1.0F)};
+}
+
+#ifdef RESIN_SIMD_SSE
+inline void load_quat_lanes(const glm::quat* src, F4 (&out)[4]) {
+  __m128 q0 = _mm_loadu_ps(quat_data(src[0]));
+  __m128 q1 = _mm_loadu_ps(quat_data(src[1]));
+  __m128 q2 = _mm_loadu_ps(quat_data(src[2]));
+  __m128 q3 = _mm_loadu_ps(quat_data(src[3]));
+  transpose4(q0, q1, q2, q3);
+  out[0] = F4(q0);
+  out[1] = F4(q1);
+  out[2] = F4(q2);
+  out[3] = F4(q3);
+}
+
+inline void store_mat4_lanes(const F4 (&m)[4][3], glm::mat4* dst) {
+  for (int c = 0; c < 4; ++c) {
+    __m128 r0 = m[c][0].v;
+    __m128 r1 = m[c][1].v;
+    __m128 r2 = m[c][2].v;
+    __m128 r3 = c == 3 ? _mm_set1_ps(1.0F) : _mm_setzero_ps();
+    transpose4(r0, r1, r2, r3);
+    _mm_storeu_ps(&dst[0][c].x, r0);
+    _mm_storeu_ps(&dst[1][c].x, r1);
+    _mm_storeu_ps(&dst[2][c].x, r2);
+    _mm_storeu_ps(&dst[3][c].x, r3);
+  }
+}
+
+template <bool Inverse>
+void compose_sse(const glm::vec3* pos, const glm::quat* rot, const glm::vec3* scale, glm::mat4* out) {
+  F4 p[3];
+  F4 q[4];
+  F4 s[3];
+  load_vec3_lanes(pos, p);
+  load_quat_lanes(rot, q);
+  load_vec3_lanes(scale, s);
+
+  F4 m[4][3];
+  compose_lanes<Inverse>(p, q, s, m);
+  store_mat4_lanes(m, out);
+}
+#endif  // RESIN_SIMD_SSE
+
+#ifdef RESIN_SIMD_AVX2
+// The AVX2 kernels process 8 matrices at once, the transforms 0-3 in the lower 128-bit lane and 4-7 in the upper one
+inline void load_quat_lanes(const glm::quat* src, F8 (&out)[4]) {
+  __m256 q0 = combine(_mm_loadu_ps(quat_data(src[0])), _mm_loadu_ps(quat_data(src[4])));
+  __m256 q1 = combine(_mm_loadu_ps(quat_data(src[1])), _mm_loadu_ps(quat_data(src[5])));
+  __m256 q2 = combine(_mm_loadu_ps(quat_data(src[2])), _mm_loadu_ps(quat_data(src[6])));
+  __m256 q3 = combine(_mm_loadu_ps(quat_data(src[3])), _mm_loadu_ps(quat_data(src[7])));
+  transpose4(q0, q1, q2, q3);
+  out[0] = F8(q0);
+  out[1] = F8(q1);
+  out[2] = F8(q2);
+  out[3] = F8(q3);
+}
+
+inline void store_mat4_lanes(const F8 (&m)[4][3], glm::mat4* dst) {
+  for (int c = 0; c < 4; ++c) {
+    __m256 r[4] = {m[c][0].v, m[c][1].v, m[c][2].v, c == 3 ? _mm256_set1_ps(1.0F) : _mm256_setzero_ps()};
+    transpose4(r[0], r[1], r[2], r[3]);
+    for (int k = 0; k < 4; ++k) {
+      _mm_storeu_ps(&dst[k][c].x, _mm256_castps256_ps128(r[k]));
+      _mm_storeu_ps(&dst[k + 4][c].x, _mm256_extractf128_ps(r[k], 1));
+    }
+  }
+}
+
+template <bool Inverse>
+void compose_avx2(const glm::vec3* pos, const glm::quat* rot, const glm::vec3* scale, glm::mat4* out) {
+  F8 p[3];
+  F8 q[4];
+  F8 s[3];
+  load_vec3_lanes(pos, p);
+  load_quat_lanes(rot, q);
+  load_vec3_lanes(scale, s);
+
+  F8 m[4][3];
+  compose_lanes<Inverse>(p, q, s, m);
+  store_mat4_lanes(m, out);
+}
+#endif  // RESIN_SIMD_AVX2
+
+template <bool Inverse>
+void compose_batch(std::span<const glm::vec3> pos, std::span<const glm::quat> rot, std::span<const glm::vec3> scale,
+                   std::span<glm::mat4> out) {
+  const size_t count = out.size();
+  if (pos.size() != count || rot.size() != count || scale.size() != count) {
+    throw std::invalid_argument("All spans passed to compose_trs must have the same size");
+  }
+
+  size_t i = 0;
+#ifdef RESIN_SIMD_AVX2
+  for (; i + 8 <= count; i += 8) {
+    compose_avx2<Inverse>(&pos[i], &rot[i], &scale[i], &out[i]);
+  }
+#endif
+#ifdef RESIN_SIMD_SSE
+  for (; i + 4 <= count; i += 4) {
+    compose_sse<Inverse>(&pos[i], &rot[i], &scale[i], &out[i]);
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = compose_scalar<Inverse>(pos[i], rot[i], scale[i]);
+  }
+}
+
+}  // namespace
+
+glm::mat4 compose_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale) {
+  return compose_scalar<false>(pos, rot, scale);
+}
+
+glm::mat4 compose_inverse_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale) {
+  return compose_scalar<true>(pos, rot, scale);
+}
+
+void compose_trs(std::span<const glm::vec3> pos, std::span<const glm::quat> rot, std::span<const glm::vec3> scale,
+                 std::span<glm::mat4> out) {
+  compose_batch<false>(pos, rot, scale, out);
+}
+
+void compose_inverse_trs(std::span<const glm::vec3> pos, std::span<const glm::quat> rot,
+                         std::span<const glm::vec3> scale, std::span<glm::mat4> out) {
+  compose_batch<true>(pos, rot, scale, out);
+}
+
+}  // namespace resin
@@ -0,0 +1,34 @@
+#ifndef RESIN_TRANSFORM_BATCH_HPP
+#define RESIN_TRANSFORM_BATCH_HPP
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+
+namespace resin {
+
+/*
+  Builds translation * rotation * scale matrices directly from the components, without the intermediate matrix
+  products. Equivalent to `glm::translate(pos) * glm::mat4_cast(rot) * glm::scale(scale)`.
+*/
+glm::mat4 compose_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale);
+
+/*
+  Builds the inverse of `compose_trs`. Equivalent to
+  `glm::scale(1.0F / scale) * glm::mat4_cast(glm::inverse(rot)) * glm::translate(-pos)`.
+*/
+glm::mat4 compose_inverse_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale);
+
+/*
+  Batched versions of the functions above. All spans must have the same size. Uses AVX2 kernels (8 matrices at once)
+  when libresin is compiled with `RESIN_ENABLE_AVX2`, SSE kernels (4 matrices at once) on every x86-64 target and the
+  scalar implementation for the remainder and on other platforms.
+*/
+void compose_trs(std::span<const glm::vec3> pos, std::span<const glm::quat> rot, std::span<const glm::vec3> scale,
+                 std::span<glm::mat4> out);
+void compose_inverse_trs(std::span<const glm::vec3> pos, std::span<const glm::quat> rot,
+                         std::span<const glm::vec3> scale, std::span<glm::mat4> out);
+
+}  // namespace resin
+#endif  // RESIN_TRANSFORM_BATCH_HPP
@@ -0,0 +1,384 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include <algorithm>
+#include <libresin/core/transform_batch.hpp>
+#include <libresin/core/transform_hierarchy.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<uint32_t>& new_slot) {
+  std::vector<T> result(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    result[new_slot[i]] = std::move(values[i]);
+  }
+  values = std::move(result);
+}
+
+}  // namespace
+
+TransformHierarchy& TransformHierarchy::default_instance() {
+  static TransformHierarchy hierarchy;
+  return hierarchy;
+}
+
+TransformHierarchy::NodeId TransformHierarchy::create(Transform& transform, const glm::vec3& pos, const glm::quat& rot,
+                                                      const glm::vec3& scale) {
+  NodeId id = kInvalidNode;
+  if (!free_ids_.empty()) {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  } else {
+    id = static_cast<NodeId>(slot_of_.size());
+    slot_of_.push_back(kInvalidSlot);
+    transforms_.push_back(nullptr);
+    generation_.push_back(0);
+    parent_id_.push_back(kInvalidNode);
+    first_child_.push_back(kInvalidNode);
+    next_sibling_.push_back(kInvalidNode);
+    prev_sibling_.push_back(kInvalidNode);
+  }
+
+  // A new root can be always placed at the end without breaking the parent-before-child order
+  slot_of_[id] = static_cast<uint32_t>(parent_.size());
+  parent_.push_back(kInvalidSlot);
+  pos_.push_back(pos);
+  rot_.push_back(rot);
+  scale_.push_back(scale);
+  world_.emplace_back(1.0F);
+  inv_world_.emplace_back(1.0F);
+  dirty_.push_back(1);
+  id_of_.push_back(id);
+
+  transforms_[id] = &transform;
+  mark_dirty(slot_of_[id]);
+  return id;
+}
+
+void TransformHierarchy::destroy(const NodeId id) {
+  if (!contains(id)) {
+    return;
+  }
+
+  // detach children, they become roots
+  for (NodeId child = first_child_[id]; child != kInvalidNode;) {
+    const NodeId next = next_sibling_[child];
+
+    parent_id_[child]        = kInvalidNode;
+    prev_sibling_[child]     = kInvalidNode;
+    next_sibling_[child]     = kInvalidNode;
+    parent_[slot_of_[child]] = kInvalidSlot;
+    mark_dirty(slot_of_[child]);
+    child = next;
+  }
+  first_child_[id] = kInvalidNode;
+  unlink_child(id);
+
+  // swap remove the node from the hot arrays
+  const uint32_t slot = slot_of_[id];
+  const auto last     = static_cast<uint32_t>(parent_.size() - 1);
+  if (slot != last) {
+    parent_[slot]    = parent_[last];
+    pos_[slot]       = pos_[last];
+    rot_[slot]       = rot_[last];
+    scale_[slot]     = scale_[last];
+    world_[slot]     = world_[last];
+    inv_world_[slot] = inv_world_[last];
+    dirty_[slot]     = dirty_[last];
+    id_of_[slot]     = id_of_[last];
+
+    const NodeId moved = id_of_[slot];
+    slot_of_[moved]    = slot;
+    for (NodeId child = first_child_[moved]; child != kInvalidNode; child = next_sibling_[child]) {
+      parent_[slot_of_[child]] = slot;
+    }
+
+    // the moved node may now be placed before its parent
+    needs_sort_ = true;
+    up_to_date_.store(false, std::memory_order_relaxed);
+  }
+
+  parent_.pop_back();
+  pos_.pop_back();
+  rot_.pop_back();
+  scale_.pop_back();
+  world_.pop_back();
+  inv_world_.pop_back();
+  dirty_.pop_back();
+  id_of_.pop_back();
+
+  slot_of_[id]    = kInvalidSlot;
+  transforms_[id] = nullptr;
+  free_ids_.push_back(id);
+}
+
+void TransformHierarchy::reserve(const size_t capacity) {
+  parent_.reserve(capacity);
+  pos_.reserve(capacity);
+  rot_.reserve(capacity);
+  scale_.reserve(capacity);
+  world_.reserve(capacity);
+  inv_world_.reserve(capacity);
+  dirty_.reserve(capacity);
+  id_of_.reserve(capacity);
+}
+
+TransformHierarchy::NodeId TransformHierarchy::parent(const NodeId id) const { return parent_id_[id]; }
+
+void TransformHierarchy::set_parent(const NodeId id, const std::optional<NodeId> parent) {
+  if (parent.has_value()) {
+    for (NodeId ancestor = *parent; ancestor != kInvalidNode; ancestor = parent_id_[ancestor]) {
+      if (ancestor == id) {
+        throw std::invalid_argument("Cannot parent a transform to itself or to one of its descendants");
+      }
+    }
+  }
+
+  unlink_child(id);
+  mark_dirty(slot_of_[id]);
+  if (!parent.has_value()) {
+    parent_[slot_of_[id]] = kInvalidSlot;
+    return;
+  }
+
+  link_child(*parent, id);
+  parent_[slot_of_[id]] = slot_of_[*parent];
+  if (slot_of_[*parent] > slot_of_[id]) {
+    needs_sort_ = true;
+  }
+}
+
+void TransformHierarchy::set_local_pos(const NodeId id, const glm::vec3& pos) {
+  const uint32_t slot = slot_of_[id];
+  pos_[slot]          = pos;
+  mark_dirty(slot);
+}
+
+void TransformHierarchy::set_local_rot(const NodeId id, const glm::quat& rot) {
+  const uint32_t slot = slot_of_[id];
+  rot_[slot]          = rot;
+  mark_dirty(slot);
+}
+
+void TransformHierarchy::set_local_scale(const NodeId id, const glm::vec3& scale) {
+  const uint32_t slot = slot_of_[id];
+  scale_[slot]        = scale;
+  mark_dirty(slot);
+}
+
+glm::vec3& TransformHierarchy::edit_local_pos(const NodeId id) {
+  const uint32_t slot = slot_of_[id];
+  mark_dirty(slot);
+  return pos_[slot];
+}
+
+glm::quat& TransformHierarchy::edit_local_rot(const NodeId id) {
+  const uint32_t slot = slot_of_[id];
+  mark_dirty(slot);
+  return rot_[slot];
+}
+
+glm::vec3& TransformHierarchy::edit_local_scale(const NodeId id) {
+  const uint32_t slot = slot_of_[id];
+  mark_dirty(slot);
+  return scale_[slot];
+}
+
+glm::mat4 TransformHierarchy::local_to_parent_matrix(const NodeId id) const {
+  const uint32_t slot = slot_of_[id];
+  return compose_trs(pos_[slot], rot_[slot], scale_[slot]);
+}
+
+glm::mat4 TransformHierarchy::parent_to_local_matrix(const NodeId id) const {
+  const uint32_t slot = slot_of_[id];
+  return compose_inverse_trs(pos_[slot], rot_[slot], scale_[slot]);
+}
+
+glm::mat4 TransformHierarchy::local_to_world_matrix(const NodeId id) const {
+  if (!needs_update()) {
+    return world_[slot_of_[id]];
+  }
+
+  glm::mat4 result = local_to_parent_matrix(id);
+  for (NodeId ancestor = parent_id_[id]; ancestor != kInvalidNode; ancestor = parent_id_[ancestor]) {
+    result = local_to_parent_matrix(ancestor) * result;
+  }
+  return result;
+}
+
+glm::mat4 TransformHierarchy::world_to_local_matrix(const NodeId id) const {
+  if (!needs_update()) {
+    return inv_world_[slot_of_[id]];
+  }
+
+  glm::mat4 result = parent_to_local_matrix(id);
+  for (NodeId ancestor = parent_id_[id]; ancestor != kInvalidNode; ancestor = parent_id_[ancestor]) {
+    result *= parent_to_local_matrix(ancestor);
+  }
+  return result;
+}
+
+void TransformHierarchy::update() {
+  if (needs_sort_) {
+    sort_by_depth();
+  }
+
+  if (needs_update_) {
+    // Parents are always placed before their children, so the dirty flag of a parent is final by the time its
+    // children are visited and can be simply propagated down.
+    const size_t count = parent_.size();
+    for (size_t slot = 0; slot < count; ++slot) {
+      const uint32_t parent = parent_[slot];
+      if (parent != kInvalidSlot) {
+        dirty_[slot] |= dirty_[parent];
+      }
+    }
+
+    // Compose the local matrices of consecutive dirty nodes in batches, directly into the world matrices
+    for (size_t begin = 0; begin < count;) {
+      if (!dirty_[begin]) {
+        ++begin;
+        continue;
+      }
+
+      size_t end = begin + 1;
+      while (end < count && dirty_[end]) {
+        ++end;
+      }
+
+      const size_t length = end - begin;
+      const auto pos      = std::span(pos_).subspan(begin, length);
+      const auto rot      = std::span(rot_).subspan(begin, length);
+      const auto scale    = std::span(scale_).subspan(begin, length);
+      compose_trs(pos, rot, scale, std::span(world_).subspan(begin, length));
+      compose_inverse_trs(pos, rot, scale, std::span(inv_world_).subspan(begin, length));
+      begin = end;
+    }
+
+    // Combine with the (already final) world matrices of the parents
+    for (size_t slot = 0; slot < count; ++slot) {
+      if (!dirty_[slot]) {
+        continue;
+      }
+      const uint32_t parent = parent_[slot];
+      if (parent != kInvalidSlot) {
+        world_[slot]     = world_[parent] * world_[slot];
+        inv_world_[slot] = inv_world_[slot] * inv_world_[parent];
+      }
+      ++generation_[id_of_[slot]];
+    }
+
+    std::ranges::fill(dirty_, 0);
+    needs_update_ = false;
+  }
+
+  up_to_date_.store(true, std::memory_order_release);
+}
+
+void TransformHierarchy::update_if_needed() {
+  if (up_to_date_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  const std::lock_guard lock(update_mutex_);
+  if (!up_to_date_.load(std::memory_order_relaxed)) {
+    update();
+  }
+}
+
+void TransformHierarchy::mark_dirty(const uint32_t slot) {
+  dirty_[slot]  = 1;
+  needs_update_ = true;
+  up_to_date_.store(false, std::memory_order_relaxed);
+}
+
+void TransformHierarchy::link_child(const NodeId parent, const NodeId child) {
+  parent_id_[child]    = parent;
+  prev_sibling_[child] = kInvalidNode;
+  next_sibling_[child] = first_child_[parent];
+  if (first_child_[parent] != kInvalidNode) {
+    prev_sibling_[first_child_[parent]] = child;
+  }
+  first_child_[parent] = child;
+}
+
+void TransformHierarchy::unlink_child(const NodeId child) {
+  const NodeId parent = parent_id_[child];
+  if (parent == kInvalidNode) {
+    return;
+  }
+
+  if (prev_sibling_[child] != kInvalidNode) {
+    next_sibling_[prev_sibling_[child]] = next_sibling_[child];
+  } else {
+    first_child_[parent] = next_sibling_[child];
+  }
+  if (next_sibling_[child] != kInvalidNode) {
+    prev_sibling_[next_sibling_[child]] = prev_sibling_[child];
+  }
+
+  parent_id_[child]    = kInvalidNode;
+  prev_sibling_[child] = kInvalidNode;
+  next_sibling_[child] = kInvalidNode;
+}
+
+void TransformHierarchy::sort_by_depth() {
+  const size_t count = parent_.size();
+
+  // compute depths, the slots may be in any order at this point
+  std::vector<uint32_t> depth(count, kInvalidSlot);
+  std::vector<uint32_t> path;
+  uint32_t max_depth = 0;
+  for (size_t slot = 0; slot < count; ++slot) {
+    auto current = static_cast<uint32_t>(slot);
+    while (depth[current] == kInvalidSlot && parent_[current] != kInvalidSlot) {
+      path.push_back(current);
+      current = parent_[current];
+    }
+    if (depth[current] == kInvalidSlot) {
+      depth[current] = 0;
+    }
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+      depth[*it] = depth[parent_[*it]] + 1;
+    }
+    path.clear();
+    max_depth = std::max(max_depth, depth[slot]);
+  }
+
+  // stable counting sort by depth
+  std::vector<uint32_t> offsets(static_cast<size_t>(max_depth) + 2, 0);
+  for (size_t slot = 0; slot < count; ++slot) {
+    ++offsets[depth[slot] + 1];
+  }
+  for (size_t d = 1; d < offsets.size(); ++d) {
+    offsets[d] += offsets[d - 1];
+  }
+  std::vector<uint32_t> new_slot(count);
+  for (size_t slot = 0; slot < count; ++slot) {
+    new_slot[slot] = offsets[depth[slot]]++;
+  }
+
+  for (auto& parent : parent_) {
+    if (parent != kInvalidSlot) {
+      parent = new_slot[parent];
+    }
+  }
+  permute(parent_, new_slot);
+  permute(pos_, new_slot);
+  permute(rot_, new_slot);
+  permute(scale_, new_slot);
+  permute(world_, new_slot);
+  permute(inv_world_, new_slot);
+  permute(dirty_, new_slot);
+  permute(id_of_, new_slot);
+  for (size_t slot = 0; slot < count; ++slot) {
+    slot_of_[id_of_[slot]] = static_cast<uint32_t>(slot);
+  }
+
+  needs_sort_ = false;
+}
+
+}  // namespace resin
@@ -0,0 +1,142 @@
+#ifndef RESIN_TRANSFORM_HIERARCHY_HPP
+#define RESIN_TRANSFORM_HIERARCHY_HPP
+#define GLM_ENABLE_EXPERIMENTAL
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+struct Transform;
+
+/*
+  Data-oriented storage of `Transform`s. Local components and the cached world matrices are stored as contiguous
+  arrays (structure of arrays) sorted by depth, so that every parent is placed before its children. Thanks to that
+  `update()` recomputes all dirty subtrees in a single linear pass without any recursion or pointer chasing.
+
+  Every node is owned by a `Transform`, which is a handle to it: the nodes are created and destroyed together with
+  their transforms and addressed with stable `NodeId`s (ids of destroyed nodes are reused). Transforms constructed
+  without a hierarchy live in `default_instance()`.
+
+  The hierarchy is updated lazily by the first read of a world matrix through a `Transform` after a change, which may
+  run concurrently with other reads. Changes to any transform of the hierarchy must not run concurrently with anything
+  else on it. The hierarchy has to outlive its transforms.
+*/
+class TransformHierarchy final {
+ public:
+  using NodeId                           = uint32_t;
+  static constexpr NodeId kInvalidNode   = std::numeric_limits<NodeId>::max();
+  static constexpr uint32_t kInvalidSlot = std::numeric_limits<uint32_t>::max();
+
+  TransformHierarchy() = default;
+
+  // Hierarchy of the transforms constructed without one.
+  static TransformHierarchy& default_instance();
+
+  void reserve(size_t capacity);
+
+  bool contains(NodeId id) const { return id < slot_of_.size() && slot_of_[id] != kInvalidSlot; }
+  size_t size() const { return parent_.size(); }
+  bool empty() const { return parent_.empty(); }
+
+  // Transform owning the node.
+  Transform& transform(NodeId id) const { return *transforms_[id]; }
+  NodeId parent(NodeId id) const;
+  // Throws `std::invalid_argument` if the parent is the node itself or one of its descendants.
+  void set_parent(NodeId id, std::optional<NodeId> parent);
+
+  const glm::vec3& local_pos(NodeId id) const { return pos_[slot_of_[id]]; }
+  const glm::quat& local_rot(NodeId id) const { return rot_[slot_of_[id]]; }
+  const glm::vec3& local_scale(NodeId id) const { return scale_[slot_of_[id]]; }
+  void set_local_pos(NodeId id, const glm::vec3& pos);
+  void set_local_rot(NodeId id, const glm::quat& rot);
+  void set_local_scale(NodeId id, const glm::vec3& scale);
+  // Mark the node as changed and return its component to be modified in place. The reference is valid until a node is
+  // created or destroyed or the hierarchy is updated.
+  glm::vec3& edit_local_pos(NodeId id);
+  glm::quat& edit_local_rot(NodeId id);
+  glm::vec3& edit_local_scale(NodeId id);
+
+  glm::mat4 local_to_parent_matrix(NodeId id) const;
+  glm::mat4 parent_to_local_matrix(NodeId id) const;
+  // If there are pending changes since the last `update()` the matrices are resolved on the fly by walking up the
+  // hierarchy, otherwise the cached values are returned.
+  glm::mat4 local_to_world_matrix(NodeId id) const;
+  glm::mat4 world_to_local_matrix(NodeId id) const;
+
+  // Changes every time `update()` recomputes the world matrices of the node.
+  uint32_t generation(NodeId id) const { return generation_[id]; }
+
+  // Recomputes the world matrices of all nodes that changed since the last update (along with their subtrees).
+  void update();
+  // Same as above if there are any changes. May be called concurrently with itself and the reads of the matrices.
+  void update_if_needed();
+  bool needs_update() const { return needs_update_ || needs_sort_; }
+
+  // Depth sorted world matrices, valid after `update()`. Use `slot()` to find the matrix of a given node.
+  std::span<const glm::mat4> world_matrices() const { return world_; }
+  std::span<const glm::mat4> inv_world_matrices() const { return inv_world_; }
+  uint32_t slot(NodeId id) const { return slot_of_[id]; }
+
+  // Depth sorted local components and parent slots (`kInvalidSlot` for roots), sorted after `update()`.
+  std::span<const uint32_t> parent_slots() const { return parent_; }
+  std::span<const glm::vec3> local_positions() const { return pos_; }
+  std::span<const glm::quat> local_rotations() const { return rot_; }
+  std::span<const glm::vec3> local_scales() const { return scale_; }
+
+  // The transforms refer to their hierarchy by address
+  TransformHierarchy(const TransformHierarchy&)            = delete;
+  TransformHierarchy(TransformHierarchy&&)                 = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+  TransformHierarchy& operator=(TransformHierarchy&&)      = delete;
+
+ private:
+  friend struct Transform;
+
+  NodeId create(Transform& transform, const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale);
+  // Children of the node become roots.
+  void destroy(NodeId id);
+
+  void mark_dirty(uint32_t slot);
+  void link_child(NodeId parent, NodeId child);
+  void unlink_child(NodeId child);
+  void sort_by_depth();
+
+ private:
+  // Hot data, indexed by slot (depth sorted)
+  std::vector<uint32_t> parent_;
+  std::vector<glm::vec3> pos_;
+  std::vector<glm::quat> rot_;
+  std::vector<glm::vec3> scale_;
+  std::vector<glm::mat4> world_;
+  std::vector<glm::mat4> inv_world_;
+  std::vector<uint8_t> dirty_;
+  std::vector<NodeId> id_of_;
+
+  // Cold data, indexed by node id
+  std::vector<uint32_t> slot_of_;
+  std::vector<Transform*> transforms_;
+  std::vector<uint32_t> generation_;
+  std::vector<NodeId> parent_id_;
+  std::vector<NodeId> first_child_;
+  std::vector<NodeId> next_sibling_;
+  std::vector<NodeId> prev_sibling_;
+  std::vector<NodeId> free_ids_;
+
+  bool needs_update_ = false;
+  bool needs_sort_   = false;
+  // Cleared by every change, the lazy updates check it without taking the lock
+  std::atomic<bool> up_to_date_ = true;
+  std::mutex update_mutex_;
+};  // class TransformHierarchy
+
+}  // namespace resin
+#endif  // RESIN_TRANSFORM_HIERARCHY_HPP
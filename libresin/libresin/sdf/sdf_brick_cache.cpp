@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <libresin/sdf/sdf_brick_cache.hpp>
+#include <libresin/sdf/sdf_bvh.hpp>
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <libresin/utils/job_system.hpp>
+#include <limits>
+#include <stdexcept>
+
+namespace resin {
+
+namespace {
+
+constexpr uint32_t kBrickCells   = SdfBrickCache::kBrickCells;
+constexpr uint32_t kBrickSamples = SdfBrickCache::kBrickSamples;
+constexpr size_t kBrickSize      = SdfBrickCache::kBrickSize;
+
+// Bricks sampled in parallel before they are stored, which bounds the memory taken by the samples in flight
+constexpr size_t kBakeBatch = 256;
+
+// Every brick coordinate is offset by `kMaxBrickCoordinate` into a field of a key
+constexpr uint32_t kKeyBits = 21;
+constexpr uint64_t kKeyMask = (uint64_t{1} << kKeyBits) - 1;
+static_assert(uint64_t{2} * SdfBrickCache::kMaxBrickCoordinate <= kKeyMask + 1);
+
+bool same_instructions(std::span<const SdfInstruction> lhs, std::span<const SdfInstruction> rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](const SdfInstruction& a, const SdfInstruction& b) {
+                      // Any change of the blend counts, so it is compared bitwise
+                      return a.type == b.type && a.out == b.out && a.lhs == b.lhs && a.rhs == b.rhs &&
+                             a.primitive == b.primitive &&
+                             std::bit_cast<uint32_t>(a.blend) == std::bit_cast<uint32_t>(b.blend);
+                    });
+}
+
+bool beyond_band(const SdfInterval& interval, const float band) { return interval.min > band || interval.max < -band; }
+
+/*
+  Samples a brick into `out`, truncated to the band. Returns whether the brick has to be stored, which it does not if
+  its bounds lie beyond the band or all of its samples are truncated to the same side of it: the tape then tells
+  everything the brick would.
+*/
+bool sample_brick(const SdfTape& tape, const SdfBvh& bvh, const glm::ivec3& brick, const float voxel_size,
+                  const float band, std::vector<glm::vec3>& points, std::span<float> out) {
+  // The samples are computed from their integer coordinates, so the neighbors get the same ones on the shared faces
+  const glm::ivec3 first = brick * static_cast<int32_t>(kBrickCells);
+  const glm::vec3 min    = glm::vec3(first) * voxel_size;
+  const glm::vec3 max    = glm::vec3(first + static_cast<int32_t>(kBrickCells)) * voxel_size;
+  const SdfTape pruned   = tape.prune(min, max, bvh);
+  if (beyond_band(pruned.bounds(min, max), band)) {
+    return false;
+  }
+
+  points.clear();
+  for (int32_t z = 0; z < static_cast<int32_t>(kBrickSamples); ++z) {
+    for (int32_t y = 0; y < static_cast<int32_t>(kBrickSamples); ++y) {
+      for (int32_t x = 0; x < static_cast<int32_t>(kBrickSamples); ++x) {
+        points.push_back(glm::vec3(first + glm::ivec3(x, y, z)) * voxel_size);
+      }
+    }
+  }
+  pruned.evaluate(points, out);
+
+  bool outside = true;
+  bool inside  = true;
+  for (float& value : out) {
+    outside = outside && value >= band;
+    inside  = inside && value <= -band;
+    value   = std::clamp(value, -band, band);
+  }
+  return !outside && !inside;
+}
+
+}  // namespace
+
+SdfBrickCache::SdfBrickCache(const SdfEvaluator& evaluator, JobSystem& jobs, const float voxel_size, const float band)
+    : evaluator_(&evaluator), jobs_(&jobs), voxel_size_(voxel_size), band_(band) {
+  if (!(voxel_size > 0.0F) || !std::isfinite(voxel_size)) {
+    throw std::invalid_argument("SdfBrickCache: the voxel size must be positive");
+  }
+  if (!(band > 0.0F) || !std::isfinite(band)) {
+    throw std::invalid_argument("SdfBrickCache: the band must be positive");
+  }
+  snapshot();
+}
+
+uint64_t SdfBrickCache::brick_key(const glm::ivec3& brick) {
+  const auto field = [](const int32_t coordinate) { return static_cast<uint64_t>(coordinate + kMaxBrickCoordinate); };
+  return (field(brick.x) << (2 * kKeyBits)) | (field(brick.y) << kKeyBits) | field(brick.z);
+}
+
+glm::ivec3 SdfBrickCache::key_brick(const uint64_t key) {
+  const auto coordinate = [](const uint64_t field) {
+    return static_cast<int32_t>(field & kKeyMask) - kMaxBrickCoordinate;
+  };
+  return {coordinate(key >> (2 * kKeyBits)), coordinate(key >> kKeyBits), coordinate(key)};
+}
+
+SdfBrickCache::PrimitiveState SdfBrickCache::primitive_state(const size_t primitive) const {
+  const SdfTapePrimitive& tape_primitive = evaluator_->tape().primitives()[primitive];
+  const SdfBvh& bvh                      = evaluator_->bvh();
+
+  // A primitive whose distance is more than the band and the blend reach away from 0 does not affect the distances
+  // within the band, and it is at least the distance ratio times the distance to its bounds away from any point
+  const Aabb& bounds = bvh.primitive_bounds(primitive);
+  const float ratio  = bvh.distance_ratio(primitive);
+  const float margin = ratio > 0.0F ? (band_ + blend_reach_) / ratio : std::numeric_limits<float>::infinity();
+  return {
+      .transform            = tape_primitive.transform,
+      .transform_generation = tape_primitive.transform_generation,
+      .node                 = tape_primitive.node,
+      .type                 = tape_primitive.type,
+      .params               = tape_primitive.params,
+      .reach                = Aabb(bounds.min - margin, bounds.max + margin),
+  };
+}
+
+void SdfBrickCache::snapshot() {
+  const SdfTape& tape = evaluator_->tape();
+  instructions_       = tape.instructions();
+
+  // A child of a smooth operation only matters where it is within the blend of the other child, and the result is at
+  // most a quarter of the blend away from the closer one, so every smooth operation widens the reach by 1.25 blends
+  blend_reach_ = 0.0F;
+  for (const SdfInstruction& instruction : instructions_) {
+    if (is_smooth(instruction.type)) {
+      blend_reach_ += 1.25F * instruction.blend;
+    }
+  }
+
+  primitives_.clear();
+  for (size_t i = 0; i < tape.primitives().size(); ++i) {
+    primitives_.push_back(primitive_state(i));
+  }
+}
+
+std::optional<SdfBrickCache::BrickRange> SdfBrickCache::clip(const BrickRange& range, const Aabb& box) const {
+  // Computed in floating point, which the clamping brings back into the range of the coordinates
+  const float brick_size = voxel_size_ * static_cast<float>(kBrickCells);
+  const glm::vec3 min    = glm::max(glm::ceil(box.min / brick_size) - 1.0F, glm::vec3(range.min));
+  const glm::vec3 max    = glm::min(glm::floor(box.max / brick_size), glm::vec3(range.max));
+  if (!(min.x <= max.x && min.y <= max.y && min.z <= max.z)) {
+    return std::nullopt;
+  }
+  return BrickRange{.min = glm::ivec3(min), .max = glm::ivec3(max)};
+}
+
+Aabb SdfBrickCache::range_bounds(const BrickRange& range) const {
+  const auto brick_cells = static_cast<int32_t>(kBrickCells);
+  return {glm::vec3(range.min * brick_cells) * voxel_size_, glm::vec3((range.max + 1) * brick_cells) * voxel_size_};
+}
+
+void SdfBrickCache::find_bricks(const BrickRange& range, std::span<const BrickRange> baked,
+                                std::vector<uint64_t>& out) const {
+  const Aabb bounds = range_bounds(range);
+  find_bricks(evaluator_->tape().prune(bounds.min, bounds.max, evaluator_->bvh()), range, baked, out);
+}
+
+void SdfBrickCache::find_bricks(const SdfTape& tape, const BrickRange& range, std::span<const BrickRange> baked,
+                                std::vector<uint64_t>& out) const {
+  if (std::ranges::any_of(baked, [&](const BrickRange& other) {
+        return other.contains(range.min) && other.contains(range.max);
+      })) {
+    return;
+  }
+
+  // The tape has been pruned for a range containing this one
+  const Aabb bounds = range_bounds(range);
+  if (beyond_band(tape.bounds(bounds.min, bounds.max), band_)) {
+    return;
+  }
+
+  // Halves along the longest axis, down to single bricks
+  const glm::ivec3 size = range.max - range.min + 1;
+  if (size.x == 1 && size.y == 1 && size.z == 1) {
+    out.push_back(brick_key(range.min));
+    return;
+  }
+  glm::length_t axis = 0;
+  for (glm::length_t i = 1; i < 3; ++i) {
+    axis = size[i] > size[axis] ? i : axis;
+  }
+  BrickRange lower = range;
+  BrickRange upper = range;
+  lower.max[axis]  = range.min[axis] + size[axis] / 2 - 1;
+  upper.min[axis]  = lower.max[axis] + 1;
+
+  const SdfTape pruned = tape.prune(bounds.min, bounds.max);
+  find_bricks(pruned, lower, baked, out);
+  find_bricks(pruned, upper, baked, out);
+}
+
+size_t SdfBrickCache::bake(const Aabb& region) {
+  size_t baked = update();
+  if (region.empty()) {
+    return baked;
+  }
+
+  const float brick_size = voxel_size_ * static_cast<float>(kBrickCells);
+  const glm::vec3 min    = glm::ceil(region.min / brick_size) - 1.0F;
+  const glm::vec3 max    = glm::floor(region.max / brick_size);
+  const auto limit       = static_cast<float>(kMaxBrickCoordinate);
+  for (glm::length_t axis = 0; axis < 3; ++axis) {
+    if (!(min[axis] >= -limit && max[axis] < limit)) {
+      throw std::invalid_argument("SdfBrickCache: the region is too far from the origin");
+    }
+  }
+
+  const BrickRange range{.min = glm::ivec3(min), .max = glm::ivec3(max)};
+  if (std::ranges::any_of(regions_, [&](const BrickRange& other) {
+        return other.contains(range.min) && other.contains(range.max);
+      })) {
+    return baked;
+  }
+
+  std::vector<uint64_t> keys;
+  find_bricks(range, regions_, keys);
+  regions_.push_back(range);
+  baked += bake_bricks(keys);
+  return baked;
+}
+
+size_t SdfBrickCache::update() {
+  evaluator_->check_version();
+  const SdfTape& tape = evaluator_->tape();
+  if (tape.primitives().size() != primitives_.size() || !same_instructions(tape.instructions(), instructions_)) {
+    snapshot();
+    return bake_all();
+  }
+
+  // Both where the primitives were and where they are now
+  std::vector<Aabb> changes;
+  for (size_t i = 0; i < primitives_.size(); ++i) {
+    const SdfTapePrimitive& primitive = tape.primitives()[i];
+    PrimitiveState& state             = primitives_[i];
+    if (state.transform == primitive.transform && state.transform_generation == primitive.transform_generation &&
+        state.node == primitive.node && state.type == primitive.type && state.params == primitive.params) {
+      continue;
+    }
+    changes.push_back(state.reach);
+    state = primitive_state(i);
+    changes.push_back(state.reach);
+  }
+
+  std::vector<BrickRange> dirty;
+  for (const Aabb& change : changes) {
+    for (const BrickRange& region : regions_) {
+      if (const std::optional<BrickRange> range = clip(region, change)) {
+        dirty.push_back(*range);
+      }
+    }
+  }
+  if (dirty.empty()) {
+    return 0;
+  }
+
+  // The bricks that are stored have to be baked again even if they are now beyond the band, to drop them
+  std::vector<uint64_t> keys;
+  for (const BrickRange& range : dirty) {
+    find_bricks(range, {}, keys);
+  }
+  for (const auto& [key, offset] : bricks_) {
+    const glm::ivec3 brick = key_brick(key);
+    if (std::ranges::any_of(dirty, [&](const BrickRange& range) { return range.contains(brick); })) {
+      keys.push_back(key);
+    }
+  }
+  std::ranges::sort(keys);
+  keys.erase(std::ranges::unique(keys).begin(), keys.end());
+  return bake_bricks(keys);
+}
+
+size_t SdfBrickCache::bake_all() {
+  bricks_.clear();
+  samples_.clear();
+  free_offsets_.clear();
+
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < regions_.size(); ++i) {
+    find_bricks(regions_[i], std::span(regions_).first(i), keys);
+  }
+  return bake_bricks(keys);
+}
+
+size_t SdfBrickCache::bake_bricks(std::span<const uint64_t> keys) {
+  const SdfTape& tape = evaluator_->tape();
+  const SdfBvh& bvh   = evaluator_->bvh();
+  std::vector<float> samples(std::min(keys.size(), kBakeBatch) * kBrickSize);
+  std::vector<uint8_t> stored(std::min(keys.size(), kBakeBatch));
+
+  for (size_t first = 0; first < keys.size(); first += kBakeBatch) {
+    const std::span<const uint64_t> batch = keys.subspan(first, std::min(kBakeBatch, keys.size() - first));
+    jobs_->parallel_for(batch.size(), 1, [&](const size_t begin, const size_t end) {
+      std::vector<glm::vec3> points;
+      points.reserve(kBrickSize);
+      for (size_t i = begin; i < end; ++i) {
+        const std::span<float> out = std::span(samples).subspan(i * kBrickSize, kBrickSize);
+        stored[i] = sample_brick(tape, bvh, key_brick(batch[i]), voxel_size_, band_, points, out) ? 1U : 0U;
+      }
+    });
+
+    // The hash map is only modified here, on the calling thread
+    for (size_t i = 0; i < batch.size(); ++i) {
+      const auto found = bricks_.find(batch[i]);
+      if (stored[i] == 0) {
+        if (found != bricks_.end()) {
+          free_offsets_.push_back(found->second);
+          bricks_.erase(found);
+        }
+        continue;
+      }
+
+      size_t offset = 0;
+      if (found != bricks_.end()) {
+        offset = found->second;
+      } else if (!free_offsets_.empty()) {
+        offset = free_offsets_.back();
+        free_offsets_.pop_back();
+      } else {
+        offset = samples_.size();
+        samples_.resize(offset + kBrickSize);
+      }
+      std::copy_n(samples.begin() + static_cast<std::ptrdiff_t>(i * kBrickSize), kBrickSize,
+                  samples_.begin() + static_cast<std::ptrdiff_t>(offset));
+      bricks_.insert_or_assign(batch[i], offset);
+    }
+  }
+  return keys.size();
+}
+
+void SdfBrickCache::clear() {
+  bricks_.clear();
+  samples_.clear();
+  free_offsets_.clear();
+  regions_.clear();
+}
+
+std::optional<float> SdfBrickCache::sample(const glm::vec3& point) const { return interpolate(point, false); }
+
+std::optional<float> SdfBrickCache::interpolate(const glm::vec3& point, const bool within_band) const {
+  const glm::vec3 voxel = point / voxel_size_;
+  const glm::vec3 brick = glm::floor(voxel / static_cast<float>(kBrickCells));
+  const auto limit      = static_cast<float>(kMaxBrickCoordinate);
+  for (glm::length_t axis = 0; axis < 3; ++axis) {
+    // Also rejects NaNs
+    if (!(brick[axis] >= -limit && brick[axis] < limit)) {
+      return std::nullopt;
+    }
+  }
+  const auto found = bricks_.find(brick_key(glm::ivec3(brick)));
+  if (found == bricks_.end()) {
+    return std::nullopt;
+  }
+
+  // Rounding may put the point onto the max faces of the brick, which belong to the last cell
+  const auto brick_cells = static_cast<float>(kBrickCells);
+  const glm::vec3 local  = glm::clamp(voxel - brick * brick_cells, 0.0F, brick_cells);
+  const glm::uvec3 cell  = glm::min(glm::uvec3(local), glm::uvec3(kBrickCells - 1));
+  const glm::vec3 t      = local - glm::vec3(cell);
+
+  constexpr size_t kRow   = kBrickSamples;
+  constexpr size_t kSlice = size_t{kBrickSamples} * kBrickSamples;
+  const float* s          = samples_.data() + found->second + cell.z * kSlice + cell.y * kRow + cell.x;
+  if (within_band) {
+    for (const size_t corner : {size_t{0}, kRow, kSlice, kSlice + kRow}) {
+      if (std::abs(s[corner]) >= band_ || std::abs(s[corner + 1]) >= band_) {
+        return std::nullopt;
+      }
+    }
+  }
+  const float x00         = glm::mix(s[0], s[1], t.x);
+  const float x10         = glm::mix(s[kRow], s[kRow + 1], t.x);
+  const float x01         = glm::mix(s[kSlice], s[kSlice + 1], t.x);
+  const float x11         = glm::mix(s[kSlice + kRow], s[kSlice + kRow + 1], t.x);
+  return glm::mix(glm::mix(x00, x10, t.y), glm::mix(x01, x11, t.y), t.z);
+}
+
+float SdfBrickCache::evaluate(const glm::vec3& point) const {
+  evaluator_->check_version();
+  if (const std::optional<float> cached = interpolate(point, true)) {
+    return *cached;
+  }
+  return evaluator_->tape().evaluate(point);
+}
+
+void SdfBrickCache::evaluate(std::span<const glm::vec3> points, std::span<float> out) const {
+  if (points.size() != out.size()) {
+    throw std::invalid_argument("SdfBrickCache: the points and the output must have the same size");
+  }
+  evaluator_->check_version();
+
+  // The points the bricks do not cover are evaluated together
+  std::vector<size_t> misses;
+  std::vector<glm::vec3> miss_points;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (const std::optional<float> cached = interpolate(points[i], true)) {
+      out[i] = *cached;
+    } else {
+      misses.push_back(i);
+      miss_points.push_back(points[i]);
+    }
+  }
+  if (misses.empty()) {
+    return;
+  }
+
+  std::vector<float> miss_values(misses.size());
+  evaluator_->tape().evaluate(miss_points, miss_values);
+  for (size_t i = 0; i < misses.size(); ++i) {
+    out[misses[i]] = miss_values[i];
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,131 @@
+#ifndef RESIN_SDF_BRICK_CACHE_HPP
+#define RESIN_SDF_BRICK_CACHE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <libresin/core/aabb.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace resin {
+
+class JobSystem;
+class SdfEvaluator;
+struct Transform;
+
+/*
+  Sparse cache of the field of an `SdfEvaluator`, sampled on a grid of voxels with edges of `voxel_size` and queried
+  with trilinear interpolation. The grid is split into bricks of `kBrickCells`^3 voxels, kept in a hash map by their
+  coordinates, and only the bricks within the narrow band around the surface are stored: a brick whose distance bounds
+  (see `SdfTape::bounds`) lie beyond `band` is skipped without being sampled. The stored distances are truncated to
+  [-`band`, `band`], so the distances beyond the band are never needed to keep the cache up to date.
+
+  `bake` samples the bricks of a region in parallel on a `JobSystem`, the cache remembers the baked regions. `update`
+  compares the transform generations and the parameters of the primitives with the ones the bricks were baked with and
+  bakes again only the bricks within the reach of the primitives that have changed, before and after the change. A
+  change of the structure of the tree (or the blends of its operations) bakes every region again.
+
+  The queries may run concurrently with each other, but not with `bake` or `update`. They return the field as of the
+  last `update`, which should follow every `SdfEvaluator::update`.
+*/
+class SdfBrickCache {
+ public:
+  static constexpr uint32_t kBrickCells        = 8;
+  // Samples along every axis of a brick, the samples on the faces are duplicated in the neighbors
+  static constexpr uint32_t kBrickSamples      = kBrickCells + 1;
+  static constexpr size_t kBrickSize           = size_t{kBrickSamples} * kBrickSamples * kBrickSamples;
+  // Bricks along any axis on either side of the origin
+  static constexpr int32_t kMaxBrickCoordinate = 1 << 20;
+
+  // Throws `std::invalid_argument` if the voxel size or the band is not positive. The band should span a few voxels.
+  SdfBrickCache(const SdfEvaluator& evaluator, JobSystem& jobs, float voxel_size, float band);
+
+  // Updates the cache and bakes the bricks of the region that have not been baked yet. Returns the number of bricks
+  // that have been sampled (or found beyond the band). Throws `std::invalid_argument` if the region reaches further
+  // than `kMaxBrickCoordinate` bricks from the origin and `std::logic_error` if the evaluator is not up to date.
+  size_t bake(const Aabb& region);
+  // Bakes again the bricks the changes since the last update may have affected, see above. Returns the number of
+  // bricks that have been baked again. Throws `std::logic_error` if the evaluator is not up to date.
+  size_t update();
+  // Drops all the bricks and the baked regions.
+  void clear();
+
+  // Distance interpolated from the bricks, truncated to the band. Empty if the point is not within a stored brick, in
+  // which case it is outside of the baked regions or at least `band` away from the surface.
+  std::optional<float> sample(const glm::vec3& point) const;
+  // Distance interpolated from the bricks where none of the samples around the point is truncated, evaluated by the
+  // tape elsewhere. Throws `std::logic_error` if the tree has changed since the last `SdfEvaluator::update()`.
+  float evaluate(const glm::vec3& point) const;
+  // `points` and `out` must have the same size.
+  void evaluate(std::span<const glm::vec3> points, std::span<float> out) const;
+
+  size_t brick_count() const { return bricks_.size(); }
+  float voxel_size() const { return voxel_size_; }
+  float band() const { return band_; }
+
+ private:
+  // Bricks between `min` and `max` inclusive
+  struct BrickRange {
+    glm::ivec3 min;
+    glm::ivec3 max;
+
+    bool contains(const glm::ivec3& brick) const {
+      return brick.x >= min.x && brick.y >= min.y && brick.z >= min.z && brick.x <= max.x && brick.y <= max.y &&
+             brick.z <= max.z;
+    }
+  };
+
+  // State of a primitive the bricks have been baked with
+  struct PrimitiveState {
+    const Transform* transform;
+    uint32_t transform_generation;
+    SdfTree::NodeId node;
+    SdfNodeType type;
+    glm::vec4 params;
+    // Region where the primitive may affect the distances within the band
+    Aabb reach;
+  };
+
+  static uint64_t brick_key(const glm::ivec3& brick);
+  static glm::ivec3 key_brick(uint64_t key);
+
+  // Empty also if `within_band` and any of the samples around the point is truncated
+  std::optional<float> interpolate(const glm::vec3& point, bool within_band) const;
+
+  PrimitiveState primitive_state(size_t primitive) const;
+  void snapshot();
+  // Bricks of the range whose bounds intersect the box, empty if there are none
+  std::optional<BrickRange> clip(const BrickRange& range, const Aabb& box) const;
+  Aabb range_bounds(const BrickRange& range) const;
+  // Appends the bricks of the range the surface may pass within the band of, except the ones in the `baked` ranges
+  void find_bricks(const BrickRange& range, std::span<const BrickRange> baked, std::vector<uint64_t>& out) const;
+  void find_bricks(const SdfTape& tape, const BrickRange& range, std::span<const BrickRange> baked,
+                   std::vector<uint64_t>& out) const;
+  size_t bake_all();
+  size_t bake_bricks(std::span<const uint64_t> keys);
+
+ private:
+  const SdfEvaluator* evaluator_;
+  JobSystem* jobs_;
+  float voxel_size_;
+  float band_;
+
+  // Brick coordinates to the offsets of their samples in `samples_`, x first
+  std::unordered_map<uint64_t, size_t> bricks_;
+  std::vector<float> samples_;
+  std::vector<size_t> free_offsets_;
+  std::vector<BrickRange> regions_;
+
+  std::vector<SdfInstruction> instructions_;
+  std::vector<PrimitiveState> primitives_;
+  // Distance beyond the band at which the primitives may still affect the distances within it
+  float blend_reach_ = 0.0F;
+};  // class SdfBrickCache
+
+}  // namespace resin
+#endif  // RESIN_SDF_BRICK_CACHE_HPP
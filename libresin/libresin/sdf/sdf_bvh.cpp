@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_bvh.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+namespace {
+
+// Sphere tracing of a single primitive stops closer than this to its surface or after this many steps
+constexpr float kHitEpsilon  = 1e-4F;
+constexpr int kMaxTraceSteps = 128;
+
+glm::vec3 column_lengths(const glm::mat4& matrix) {
+  return {glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))};
+}
+
+}  // namespace
+
+SdfBvh::SdfBvh(const SdfTape& tape) {
+  compute_bounds(tape);
+  indices_.resize(bounds_.size());
+  for (uint32_t i = 0; i < indices_.size(); ++i) {
+    indices_[i] = i;
+  }
+
+  if (!indices_.empty()) {
+    nodes_.reserve(2 * indices_.size() / kMaxLeafSize + 1);
+    build(0, static_cast<uint32_t>(indices_.size()));
+  }
+}
+
+Aabb SdfBvh::local_bounds(const SdfNodeType type, const glm::vec4& params) {
+  glm::vec3 extent;
+  switch (type) {
+    case SdfNodeType::Sphere:
+      extent = glm::vec3(params.x);
+      break;
+    case SdfNodeType::Box:
+      extent = glm::vec3(params);
+      break;
+    case SdfNodeType::Torus:
+      extent = glm::vec3(params.x + params.y, params.y, params.x + params.y);
+      break;
+    case SdfNodeType::Capsule:
+      extent = glm::vec3(params.y, params.x + params.y, params.y);
+      break;
+    case SdfNodeType::Cylinder:
+      extent = glm::vec3(params.y, params.x, params.y);
+      break;
+    default:
+      throw std::invalid_argument("SdfBvh: an operation has no bounds");
+  }
+  return {-extent, extent};
+}
+
+void SdfBvh::compute_bounds(const SdfTape& tape) {
+  const std::vector<SdfTapePrimitive>& primitives = tape.primitives();
+  bounds_.resize(primitives.size());
+  distance_ratio_.resize(primitives.size());
+  for (size_t i = 0; i < primitives.size(); ++i) {
+    const SdfTapePrimitive& primitive = primitives[i];
+    const glm::mat4 local_to_world    = primitive.transform->local_to_world_matrix();
+    const glm::vec3 scale             = column_lengths(local_to_world);
+    bounds_[i]                        = local_bounds(primitive.type, primitive.params).transformed(local_to_world);
+    distance_ratio_[i]                = std::min({scale.x, scale.y, scale.z}) / std::max({scale.x, scale.y, scale.z});
+  }
+}
+
+uint32_t SdfBvh::build(const uint32_t begin, const uint32_t end) {
+  const auto index = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  Aabb bounds;
+  Aabb centers;
+  for (uint32_t i = begin; i < end; ++i) {
+    bounds.expand(bounds_[indices_[i]]);
+    centers.expand(bounds_[indices_[i]].center());
+  }
+  nodes_[index].bounds = bounds;
+
+  if (end - begin <= kMaxLeafSize) {
+    nodes_[index].offset = begin;
+    nodes_[index].count  = end - begin;
+    return index;
+  }
+
+  // Median split along the axis the centers spread the most
+  const glm::vec3 spread = centers.size();
+  const int axis         = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+  const uint32_t middle  = begin + (end - begin) / 2;
+  std::nth_element(indices_.begin() + begin, indices_.begin() + middle, indices_.begin() + end,
+                   [&](const uint32_t a, const uint32_t b) {
+                     return bounds_[a].center()[axis] < bounds_[b].center()[axis];
+                   });
+
+  build(begin, middle);
+  const uint32_t right = build(middle, end);
+  nodes_[index].offset = right;
+  nodes_[index].count  = 0;
+  return index;
+}
+
+void SdfBvh::refit(const SdfTape& tape) {
+  if (tape.primitives().size() != bounds_.size()) {
+    throw std::invalid_argument("SdfBvh: the tape has different primitives than the hierarchy has been built over");
+  }
+  compute_bounds(tape);
+
+  // The children are placed after their parents
+  for (size_t i = nodes_.size(); i-- > 0;) {
+    Node& node  = nodes_[i];
+    node.bounds = Aabb();
+    if (node.count == 0) {
+      node.bounds.expand(nodes_[i + 1].bounds);
+      node.bounds.expand(nodes_[node.offset].bounds);
+      continue;
+    }
+    for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+      node.bounds.expand(bounds_[indices_[j]]);
+    }
+  }
+}
+
+void SdfBvh::query(const Aabb& region, std::vector<uint32_t>& out) const {
+  if (nodes_.empty()) {
+    return;
+  }
+
+  uint32_t stack[kStackSize] = {0};
+  size_t size                = 1;
+  while (size > 0) {
+    const uint32_t index = stack[--size];
+    const Node& node     = nodes_[index];
+    if (!node.bounds.intersects(region)) {
+      continue;
+    }
+
+    if (node.count == 0) {
+      stack[size++] = index + 1;
+      stack[size++] = node.offset;
+      continue;
+    }
+    for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+      if (bounds_[indices_[j]].intersects(region)) {
+        out.push_back(indices_[j]);
+      }
+    }
+  }
+}
+
+std::optional<SdfHit> SdfBvh::pick(const SdfTape& tape, const glm::vec3& origin, const glm::vec3& direction,
+                                   const float max_distance) const {
+  if (tape.primitives().size() != bounds_.size()) {
+    throw std::invalid_argument("SdfBvh: the tape has different primitives than the hierarchy has been built over");
+  }
+  if (nodes_.empty()) {
+    return std::nullopt;
+  }
+
+  const glm::vec3 dir     = glm::normalize(direction);
+  const glm::vec3 inv_dir = 1.0F / dir;
+  std::optional<SdfHit> hit;
+  float closest = max_distance;
+
+  // Entry distances are kept along the nodes, so that a node behind the closest hit so far is skipped
+  struct Entry {
+    uint32_t node;
+    float near;
+  };
+  Entry stack[kStackSize];
+  size_t size = 0;
+  float near  = 0.0F;
+  float far   = closest;
+  if (nodes_[0].bounds.clip_ray(origin, inv_dir, near, far)) {
+    stack[size++] = {0, near};
+  }
+
+  while (size > 0) {
+    const Entry entry = stack[--size];
+    if (entry.near > closest) {
+      continue;
+    }
+
+    const Node& node = nodes_[entry.node];
+    if (node.count == 0) {
+      Entry first{.node = entry.node + 1, .near = 0.0F};
+      Entry second{.node = node.offset, .near = 0.0F};
+      float first_far       = closest;
+      float second_far      = closest;
+      const bool first_hit  = nodes_[first.node].bounds.clip_ray(origin, inv_dir, first.near, first_far);
+      const bool second_hit = nodes_[second.node].bounds.clip_ray(origin, inv_dir, second.near, second_far);
+      if (first_hit && second_hit && first.near > second.near) {
+        std::swap(first, second);
+      }
+      // The closer child is pushed last, so that it is visited first
+      if (second_hit) {
+        stack[size++] = second;
+      }
+      if (first_hit) {
+        stack[size++] = first;
+      }
+      continue;
+    }
+
+    for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+      const uint32_t primitive = indices_[j];
+      float t                  = 0.0F;
+      float t_far              = closest;
+      if (!bounds_[primitive].clip_ray(origin, inv_dir, t, t_far)) {
+        continue;
+      }
+
+      for (int step = 0; step < kMaxTraceSteps && t <= t_far; ++step) {
+        const glm::vec3 point = origin + dir * t;
+        const float distance  = tape.evaluate_primitive(primitive, point);
+        if (distance < kHitEpsilon) {
+          closest = t;
+          hit     = SdfHit{.primitive = primitive,
+                           .node      = tape.primitives()[primitive].node,
+                           .distance  = t,
+                           .point     = point};
+          break;
+        }
+        t += distance;
+      }
+    }
+  }
+  return hit;
+}
+
+}  // namespace resin
@@ -0,0 +1,89 @@
+#ifndef RESIN_SDF_BVH_HPP
+#define RESIN_SDF_BVH_HPP
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <libresin/core/aabb.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace resin {
+
+class SdfTape;
+
+// Primitive hit by a ray
+struct SdfHit {
+  // Index into `SdfTape::primitives()` and the node of the tree it was compiled from
+  uint32_t primitive;
+  SdfTree::NodeId node;
+  float distance;
+  glm::vec3 point;
+};
+
+/*
+  Bounding volume hierarchy over the primitives of an `SdfTape`, with the world-space bounds derived from the
+  `local_to_world_matrix()` of their transforms. Nodes are stored depth first in a flat array (the left child follows
+  its parent), so the queries walk it with a small stack and `refit` updates all the bounds in a single backward pass.
+
+  Moving the transforms only requires `refit`, which keeps the structure of the hierarchy. The structure degrades when
+  the primitives move far from where they were at build time, rebuilding it restores the quality.
+*/
+class SdfBvh {
+ public:
+  static constexpr uint32_t kMaxLeafSize = 4;
+
+  SdfBvh() = default;
+  explicit SdfBvh(const SdfTape& tape);
+
+  // Recomputes the bounds after the transforms of the tape have moved. The tape has to be the one the hierarchy has
+  // been built over (or have the same primitives), otherwise throws `std::invalid_argument`.
+  void refit(const SdfTape& tape);
+
+  // Appends the indices of the primitives whose bounds intersect the region.
+  void query(const Aabb& region, std::vector<uint32_t>& out) const;
+
+  // Finds the closest primitive hit by the ray, considering every primitive on its own, regardless of the operations it
+  // takes part in. The direction does not have to be normalized.
+  std::optional<SdfHit> pick(const SdfTape& tape, const glm::vec3& origin, const glm::vec3& direction,
+                             float max_distance = std::numeric_limits<float>::infinity()) const;
+
+  // Bounds of a primitive in the local space of its transform.
+  static Aabb local_bounds(SdfNodeType type, const glm::vec4& params);
+
+  // Ratio of the smallest to the largest scale of the transform of a primitive. A primitive is at least this ratio
+  // times the distance to its bounds away from any point outside of them.
+  float distance_ratio(size_t primitive) const { return distance_ratio_[primitive]; }
+  // World-space bounds of a primitive.
+  const Aabb& primitive_bounds(size_t primitive) const { return bounds_[primitive]; }
+
+  const Aabb& bounds() const { return nodes_.empty() ? kEmpty : nodes_.front().bounds; }
+  size_t primitive_count() const { return bounds_.size(); }
+  size_t node_count() const { return nodes_.size(); }
+
+ private:
+  // Interior nodes have no primitives (`count` == 0), `offset` is the index of the right child. Leaves refer to the
+  // `count` primitives starting at `offset` in `indices_`.
+  struct Node {
+    Aabb bounds;
+    uint32_t offset;
+    uint32_t count;
+  };
+
+  void compute_bounds(const SdfTape& tape);
+  uint32_t build(uint32_t begin, uint32_t end);
+
+  static constexpr size_t kStackSize = 64;
+  static inline const Aabb kEmpty{};
+
+ private:
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> indices_;
+  std::vector<Aabb> bounds_;
+  std::vector<float> distance_ratio_;
+};  // class SdfBvh
+
+}  // namespace resin
+#endif  // RESIN_SDF_BVH_HPP
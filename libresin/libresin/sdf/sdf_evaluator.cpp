@@ -0,0 +1,48 @@
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+SdfEvaluator::SdfEvaluator(const SdfTree& tree)
+    : tree_(&tree), tape_(SdfTape::compile(tree)), bvh_(tape_), tree_version_(tree.version()) {}
+
+void SdfEvaluator::update() {
+  if (tree_version_ != tree_->version()) {
+    tape_         = SdfTape::compile(*tree_);
+    bvh_          = SdfBvh(tape_);
+    tree_version_ = tree_->version();
+    return;
+  }
+  if (tape_.refresh_transforms()) {
+    bvh_.refit(tape_);
+  }
+}
+
+void SdfEvaluator::check_version() const {
+  if (tree_version_ != tree_->version()) {
+    throw std::logic_error("SdfEvaluator: the tree has changed since the last update");
+  }
+}
+
+float SdfEvaluator::evaluate(const glm::vec3& point) const {
+  check_version();
+  return tape_.evaluate(point);
+}
+
+void SdfEvaluator::evaluate(std::span<const glm::vec3> points, std::span<float> out) const {
+  check_version();
+  tape_.evaluate(points, out);
+}
+
+std::optional<SdfHit> SdfEvaluator::pick(const glm::vec3& origin, const glm::vec3& direction,
+                                         const float max_distance) const {
+  check_version();
+  return bvh_.pick(tape_, origin, direction, max_distance);
+}
+
+SdfTape SdfEvaluator::prune(const glm::vec3& min, const glm::vec3& max) const {
+  check_version();
+  return tape_.prune(min, max, bvh_);
+}
+
+}  // namespace resin
@@ -0,0 +1,65 @@
+#ifndef RESIN_SDF_EVALUATOR_HPP
+#define RESIN_SDF_EVALUATOR_HPP
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <libresin/sdf/sdf_bvh.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+
+namespace resin {
+
+/*
+  Evaluates the signed distance field of an `SdfTree` on the CPU, for picking, meshing, collisions and export.
+
+  The evaluator compiles the tree into an `SdfTape` with the world-to-local matrices of the primitives baked in, so the
+  evaluation never touches the transforms and may run concurrently on many threads. `update()` refreshes the tape, it
+  has to be called after the tree changes (the tape is compiled again) and after the transforms move (only the
+  matrices of the transforms that have changed are baked again).
+
+  The batched `evaluate` executes the tape once per 8 points with AVX2 (when libresin is compiled with
+  `RESIN_ENABLE_AVX2`), once per 4 points with SSE on every x86-64 target and once per point for the remainder and on
+  other platforms. Evaluating many points within a small region is faster with the tape pruned for the region, see
+  `prune`.
+
+  The evaluator also keeps an `SdfBvh` over the primitives of the tape, refitted by `update()` when the transforms
+  move, which makes picking and pruning scale with the primitives near the ray or the region instead of all of them.
+*/
+class SdfEvaluator {
+ public:
+  explicit SdfEvaluator(const SdfTree& tree);
+
+  // Throws `std::length_error` if the tree has changed and its field needs too many registers (see `SdfTape::compile`),
+  // in which case the evaluator keeps the previous tape.
+  void update();
+
+  // Throws `std::logic_error` if the tree has changed since the last `update()`.
+  float evaluate(const glm::vec3& point) const;
+  // `points` and `out` must have the same size.
+  void evaluate(std::span<const glm::vec3> points, std::span<float> out) const;
+
+  // Closest primitive hit by the ray, see `SdfBvh::pick`.
+  std::optional<SdfHit> pick(const glm::vec3& origin, const glm::vec3& direction,
+                             float max_distance = std::numeric_limits<float>::infinity()) const;
+  // Tape evaluating to the same distances within the axis-aligned box [`min`, `max`], see `SdfTape::prune`.
+  SdfTape prune(const glm::vec3& min, const glm::vec3& max) const;
+
+  const SdfTree& tree() const { return *tree_; }
+  const SdfTape& tape() const { return tape_; }
+  const SdfBvh& bvh() const { return bvh_; }
+
+  // Throws `std::logic_error` if the tree has changed since the last `update()`, in which case the tape and the BVH
+  // must not be used.
+  void check_version() const;
+
+ private:
+  const SdfTree* tree_;
+  SdfTape tape_;
+  SdfBvh bvh_;
+  uint32_t tree_version_;
+};  // class SdfEvaluator
+
+}  // namespace resin
+#endif  // RESIN_SDF_EVALUATOR_HPP
@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <libresin/sdf/sdf_mesher.hpp>
+#include <libresin/utils/job_system.hpp>
+#include <libresin/utils/mesh_writer.hpp>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+constexpr uint32_t kChunkCells = SdfMesher::kChunkCells;
+constexpr uint32_t kBlockCells = SdfMesher::kBlockCells;
+
+// Bits of the edge masks of the cells
+constexpr uint8_t kCrossedEdges = 0b0111U;
+constexpr uint8_t kInsideCorner = 0b1000U;
+
+// Corners of a cell are numbered by their offsets: bit 0 for x, bit 1 for y and bit 2 for z
+constexpr std::array<std::array<uint8_t, 2>, 12> kCellEdges = {{
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},  // along x
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},  // along y
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},  // along z
+}};
+
+struct Grid {
+  glm::vec3 origin;
+  float cell_size;
+  glm::uvec3 cells;
+  glm::uvec3 chunks;
+
+  glm::vec3 point(const glm::uvec3& sample) const { return origin + glm::vec3(sample) * cell_size; }
+
+  // A chunk owns the samples at the min corners of its cells, the last chunk along an axis also the end of the grid
+  glm::uvec3 sample_count(const glm::uvec3& chunk) const {
+    glm::uvec3 count;
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+      const uint32_t begin = chunk[axis] * kChunkCells;
+      count[axis] = chunk[axis] + 1 == chunks[axis] ? cells[axis] + 1 - begin : kChunkCells;
+    }
+    return count;
+  }
+
+  glm::uvec3 cell_count(const glm::uvec3& chunk) const {
+    return glm::min(cells - chunk * kChunkCells, glm::uvec3(kChunkCells));
+  }
+};
+
+struct Chunk {
+  // Samples owned by the chunk, x first. Empty if the surface does not pass through the chunk, all of the samples then
+  // have the sign of `fill`.
+  std::vector<float> samples;
+  float fill = 0.0F;
+  glm::uvec3 sample_count{0};
+  size_t evaluated = 0;
+
+  // Cells with a vertex, as (z * kChunkCells + y) * kChunkCells + x in ascending order, and their edge masks: the edges
+  // starting at the min corner crossed by the surface (`kCrossedEdges`, one bit per axis) and `kInsideCorner`
+  std::vector<uint32_t> cells;
+  std::vector<uint8_t> edges;
+  std::vector<glm::vec3> vertices;
+  uint32_t first_vertex = 0;
+  std::vector<uint32_t> triangles;
+};
+
+// Chunks of a single layer along z, x first
+using Layer = std::vector<Chunk>;
+
+size_t sample_index(const glm::uvec3& count, const glm::uvec3& sample) {
+  return (size_t{sample.z} * count.y + sample.y) * count.x + sample.x;
+}
+
+bool crosses(const SdfInterval& interval) { return interval.min <= 0.0F && interval.max >= 0.0F; }
+
+// Value of the samples that are not evaluated, an infinity with the sign of the whole interval. The samples are
+// evaluated later if they are at the end of an edge crossed by the surface, which the bounds alone cannot place.
+float fill_value(const SdfInterval& interval) {
+  return interval.min > 0.0F ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+}
+
+void sample_chunk(const SdfEvaluator& evaluator, const Grid& grid, const glm::uvec3& index, Chunk& chunk) {
+  const glm::uvec3 begin = index * kChunkCells;
+  chunk.sample_count     = grid.sample_count(index);
+
+  const glm::vec3 min            = grid.point(begin);
+  const glm::vec3 max            = grid.point(begin + chunk.sample_count - 1U);
+  const SdfTape tape             = evaluator.tape().prune(min, max, evaluator.bvh());
+  const SdfInterval chunk_bounds = tape.bounds(min, max);
+  if (!crosses(chunk_bounds)) {
+    chunk.fill = fill_value(chunk_bounds);
+    return;
+  }
+
+  chunk.samples.resize(size_t{chunk.sample_count.x} * chunk.sample_count.y * chunk.sample_count.z);
+  glm::uvec3 blocks;
+  for (glm::length_t axis = 0; axis < 3; ++axis) {
+    // The last block along an axis also takes the end sample of the grid
+    blocks[axis] = std::max(1U, (chunk.sample_count[axis] - 1 + kBlockCells - 1) / kBlockCells);
+  }
+
+  std::vector<glm::vec3> points;
+  std::vector<float> values;
+  for (uint32_t bz = 0; bz < blocks.z; ++bz) {
+    for (uint32_t by = 0; by < blocks.y; ++by) {
+      for (uint32_t bx = 0; bx < blocks.x; ++bx) {
+        const glm::uvec3 block(bx, by, bz);
+        const glm::uvec3 first = block * kBlockCells;
+        glm::uvec3 count;
+        for (glm::length_t axis = 0; axis < 3; ++axis) {
+          count[axis] = block[axis] + 1 == blocks[axis] ? chunk.sample_count[axis] - first[axis] : kBlockCells;
+        }
+
+        const glm::vec3 block_min      = grid.point(begin + first);
+        const glm::vec3 block_max      = grid.point(begin + first + count - 1U);
+        const SdfInterval block_bounds = tape.bounds(block_min, block_max);
+        if (!crosses(block_bounds)) {
+          const float fill = fill_value(block_bounds);
+          for (uint32_t z = 0; z < count.z; ++z) {
+            for (uint32_t y = 0; y < count.y; ++y) {
+              const size_t row = sample_index(chunk.sample_count, first + glm::uvec3(0, y, z));
+              std::fill_n(chunk.samples.begin() + static_cast<std::ptrdiff_t>(row), count.x, fill);
+            }
+          }
+          continue;
+        }
+
+        points.clear();
+        for (uint32_t z = 0; z < count.z; ++z) {
+          for (uint32_t y = 0; y < count.y; ++y) {
+            for (uint32_t x = 0; x < count.x; ++x) {
+              points.push_back(grid.point(begin + first + glm::uvec3(x, y, z)));
+            }
+          }
+        }
+        values.resize(points.size());
+        tape.prune(block_min, block_max).evaluate(points, values);
+        chunk.evaluated += points.size();
+
+        const float* value = values.data();
+        for (uint32_t z = 0; z < count.z; ++z) {
+          for (uint32_t y = 0; y < count.y; ++y) {
+            const size_t row = sample_index(chunk.sample_count, first + glm::uvec3(0, y, z));
+            std::copy_n(value, count.x, chunk.samples.begin() + static_cast<std::ptrdiff_t>(row));
+            value += count.x;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Chunk owning the samples or the cells of the chunk at `index` moved by `offset` (0 or 1 along every axis)
+const Chunk& neighbor(const Grid& grid, const Layer& layer, const Layer& next, const glm::uvec3& index,
+                      const glm::uvec3& offset) {
+  const Layer& source = offset.z == 0 ? layer : next;
+  return source[size_t{index.y + offset.y} * grid.chunks.x + index.x + offset.x];
+}
+
+/*
+  Creates the vertices of the cells of a chunk. The samples at the max faces of the chunk are owned by the neighbors
+  along +x, +y and +z, so the samples of up to 8 chunks are gathered into a window first.
+*/
+void create_vertices(const SdfTape& tape, const Grid& grid, const Layer& layer, const Layer& next,
+                     const glm::uvec3& index, Chunk& chunk, std::vector<float>& window) {
+  const glm::uvec3 cells = grid.cell_count(index);
+  glm::uvec3 last_neighbor;
+  for (glm::length_t axis = 0; axis < 3; ++axis) {
+    // A neighbor owns the samples at the max face only if the chunk is full and not the last one
+    last_neighbor[axis] = cells[axis] == kChunkCells && index[axis] + 1 < grid.chunks[axis] ? 1U : 0U;
+  }
+
+  // Nothing to do if every sample of the window has the same sign and comes from a chunk that is not sampled
+  bool uniform      = true;
+  const bool inside = chunk.fill < 0.0F;
+  for (uint32_t dz = 0; dz <= last_neighbor.z; ++dz) {
+    for (uint32_t dy = 0; dy <= last_neighbor.y; ++dy) {
+      for (uint32_t dx = 0; dx <= last_neighbor.x; ++dx) {
+        const Chunk& other = neighbor(grid, layer, next, index, glm::uvec3(dx, dy, dz));
+        uniform            = uniform && other.samples.empty() && (other.fill < 0.0F) == inside;
+      }
+    }
+  }
+  if (uniform) {
+    return;
+  }
+
+  const glm::uvec3 size = cells + 1U;
+  window.resize(size_t{size.x} * size.y * size.z);
+  for (uint32_t z = 0; z < size.z; ++z) {
+    for (uint32_t y = 0; y < size.y; ++y) {
+      for (uint32_t x = 0; x < size.x; ++x) {
+        const glm::uvec3 local(x, y, z);
+        glm::uvec3 offset;
+        for (glm::length_t axis = 0; axis < 3; ++axis) {
+          offset[axis] = local[axis] == kChunkCells && last_neighbor[axis] != 0 ? 1U : 0U;
+        }
+        const Chunk& owner = neighbor(grid, layer, next, index, offset);
+        const float value  = owner.samples.empty()
+                                 ? owner.fill
+                                 : owner.samples[sample_index(owner.sample_count, local - offset * kChunkCells)];
+        window[sample_index(size, local)] = value;
+      }
+    }
+  }
+
+  const glm::uvec3 begin = index * kChunkCells;
+  for (uint32_t z = 0; z < cells.z; ++z) {
+    for (uint32_t y = 0; y < cells.y; ++y) {
+      for (uint32_t x = 0; x < cells.x; ++x) {
+        std::array<float, 8> corners;
+        uint32_t inside_mask = 0;
+        for (uint32_t corner = 0; corner < 8; ++corner) {
+          const glm::uvec3 offset(corner & 1U, (corner >> 1U) & 1U, corner >> 2U);
+          corners[corner] = window[sample_index(size, glm::uvec3(x, y, z) + offset)];
+          inside_mask |= corners[corner] < 0.0F ? 1U << corner : 0U;
+        }
+        if (inside_mask == 0 || inside_mask == 0xFFU) {
+          continue;
+        }
+
+        // A filled corner is evaluated once, the neighboring cells find its value in the window
+        const auto resolve = [&](const uint32_t corner) {
+          if (!std::isinf(corners[corner])) {
+            return;
+          }
+          const glm::uvec3 sample = glm::uvec3(x, y, z) + glm::uvec3(corner & 1U, (corner >> 1U) & 1U, corner >> 2U);
+          float& value            = window[sample_index(size, sample)];
+          value                   = tape.evaluate(grid.point(begin + sample));
+          corners[corner]         = value;
+          ++chunk.evaluated;
+        };
+
+        // The vertex is placed at the mean of the points where the edges cross the surface
+        glm::vec3 sum(0.0F);
+        uint32_t crossings = 0;
+        for (const auto& [a, b] : kCellEdges) {
+          if (((inside_mask >> a) & 1U) == ((inside_mask >> b) & 1U)) {
+            continue;
+          }
+          resolve(a);
+          resolve(b);
+          // Clamped, an evaluated corner may be a rounding error away from the sign of its bounds
+          const float t         = std::clamp(corners[a] / (corners[a] - corners[b]), 0.0F, 1.0F);
+          const glm::vec3 pos_a = glm::vec3(a & 1U, (a >> 1U) & 1U, a >> 2U);
+          const glm::vec3 pos_b = glm::vec3(b & 1U, (b >> 1U) & 1U, b >> 2U);
+          sum += pos_a + (pos_b - pos_a) * t;
+          ++crossings;
+        }
+        const glm::vec3 cell = glm::vec3(begin + glm::uvec3(x, y, z));
+        chunk.vertices.push_back(grid.origin + (cell + sum / static_cast<float>(crossings)) * grid.cell_size);
+
+        // The corner at the other end of the edge along an axis is the one with the bit of the axis set
+        uint32_t edges = (inside_mask & 1U) != 0 ? kInsideCorner : 0U;
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+          edges |= (inside_mask & 1U) != ((inside_mask >> (1U << axis)) & 1U) ? 1U << axis : 0U;
+        }
+        chunk.cells.push_back((z * kChunkCells + y) * kChunkCells + x);
+        chunk.edges.push_back(static_cast<uint8_t>(edges));
+      }
+    }
+  }
+}
+
+// Index of the vertex of a cell, which is owned either by the layer being meshed or by the previous one
+uint32_t find_vertex(const Grid& grid, const Layer& layer, const Layer& previous, const uint32_t layer_z,
+                     const glm::uvec3& cell) {
+  const glm::uvec3 index = cell / kChunkCells;
+  const Layer& source    = index.z == layer_z ? layer : previous;
+  const Chunk& chunk     = source[size_t{index.y} * grid.chunks.x + index.x];
+  const glm::uvec3 local = cell - index * kChunkCells;
+  const uint32_t key     = (local.z * kChunkCells + local.y) * kChunkCells + local.x;
+
+  const auto it = std::lower_bound(chunk.cells.begin(), chunk.cells.end(), key);
+  if (it == chunk.cells.end() || *it != key) {
+    throw std::logic_error("SdfMesher: a crossed edge has no vertex in one of its cells");
+  }
+  return chunk.first_vertex + static_cast<uint32_t>(it - chunk.cells.begin());
+}
+
+// Creates a quad for every crossed edge starting at the min corner of a cell of the chunk
+void create_triangles(const Grid& grid, const Layer& layer, const Layer& previous, const glm::uvec3& index,
+                      Chunk& chunk) {
+  const glm::uvec3 begin = index * kChunkCells;
+  for (size_t i = 0; i < chunk.cells.size(); ++i) {
+    const uint8_t edges = chunk.edges[i];
+    if ((edges & kCrossedEdges) == 0) {
+      continue;
+    }
+
+    const uint32_t key = chunk.cells[i];
+    const glm::uvec3 cell =
+        begin + glm::uvec3(key % kChunkCells, (key / kChunkCells) % kChunkCells, key / (kChunkCells * kChunkCells));
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+      if ((edges & (1U << static_cast<uint32_t>(axis))) == 0) {
+        continue;
+      }
+      // The 4 cells around the edge, counterclockwise when seen from the +axis direction
+      const glm::length_t v = (axis + 1) % 3;
+      const glm::length_t w = (axis + 2) % 3;
+      if (cell[v] == 0 || cell[w] == 0) {
+        continue;
+      }
+      glm::uvec3 dv(0);
+      glm::uvec3 dw(0);
+      dv[v] = 1;
+      dw[w] = 1;
+
+      const uint32_t a = find_vertex(grid, layer, previous, index.z, cell - dv - dw);
+      const uint32_t b = find_vertex(grid, layer, previous, index.z, cell - dw);
+      const uint32_t c = find_vertex(grid, layer, previous, index.z, cell);
+      const uint32_t d = find_vertex(grid, layer, previous, index.z, cell - dv);
+      // The surface faces away from the inside, which is at the min corner or at the other end of the edge
+      if ((edges & kInsideCorner) != 0) {
+        chunk.triangles.insert(chunk.triangles.end(), {a, b, c, a, c, d});
+      } else {
+        chunk.triangles.insert(chunk.triangles.end(), {a, c, b, a, d, c});
+      }
+    }
+  }
+}
+
+}  // namespace
+
+SdfMesher::SdfMesher(const SdfEvaluator& evaluator, JobSystem& jobs) : evaluator_(&evaluator), jobs_(&jobs) {}
+
+Aabb SdfMesher::scene_bounds() const {
+  evaluator_->check_version();
+  Aabb bounds = evaluator_->bvh().bounds();
+  if (bounds.empty()) {
+    return bounds;
+  }
+
+  // A smooth union reaches up to a quarter of the blend radius further than its children
+  float reach = 0.0F;
+  for (const SdfInstruction& instruction : evaluator_->tape().instructions()) {
+    if (is_smooth(instruction.type)) {
+      reach = std::max(reach, instruction.blend * 0.25F);
+    }
+  }
+  return {bounds.min - reach, bounds.max + reach};
+}
+
+SdfMeshStats SdfMesher::mesh(const float cell_size, MeshWriter& writer) const {
+  if (!(cell_size > 0.0F)) {
+    throw std::invalid_argument("SdfMesher: the cell size must be positive");
+  }
+  const Aabb bounds = scene_bounds();
+  if (bounds.empty()) {
+    return {};
+  }
+  return mesh(Aabb(bounds.min - cell_size, bounds.max + cell_size), cell_size, writer);
+}
+
+SdfMeshStats SdfMesher::mesh(const Aabb& region, const float cell_size, MeshWriter& writer) const {
+  evaluator_->check_version();
+  if (!(cell_size > 0.0F) || !std::isfinite(cell_size)) {
+    throw std::invalid_argument("SdfMesher: the cell size must be positive");
+  }
+  if (region.empty() || evaluator_->tape().empty()) {
+    return {};
+  }
+
+  Grid grid{.origin = region.min, .cell_size = cell_size, .cells = glm::uvec3(1), .chunks = glm::uvec3(1)};
+  for (glm::length_t axis = 0; axis < 3; ++axis) {
+    const float cells = std::ceil(region.size()[axis] / cell_size);
+    if (!(cells <= static_cast<float>(kMaxGridCells))) {
+      throw std::invalid_argument("SdfMesher: the grid has too many cells");
+    }
+    grid.cells[axis]  = std::max(1U, static_cast<uint32_t>(cells));
+    grid.chunks[axis] = (grid.cells[axis] + kChunkCells - 1) / kChunkCells;
+  }
+
+  SdfMeshStats stats;
+  const size_t layer_size   = size_t{grid.chunks.x} * grid.chunks.y;
+  const size_t first_vertex = writer.vertex_count();
+  size_t vertex_count       = 0;
+
+  const auto sample_layer = [&](Layer& layer, const uint32_t z) {
+    layer.assign(layer_size, Chunk());
+    jobs_->parallel_for(layer_size, 1, [&](const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const glm::uvec3 index(static_cast<uint32_t>(i % grid.chunks.x), static_cast<uint32_t>(i / grid.chunks.x), z);
+        sample_chunk(*evaluator_, grid, index, layer[i]);
+      }
+    });
+    for (const Chunk& chunk : layer) {
+      stats.empty_chunk_count += chunk.samples.empty() ? 1U : 0U;
+    }
+    stats.chunk_count += layer_size;
+  };
+
+  Layer previous;
+  Layer layer;
+  Layer next;
+  sample_layer(layer, 0);
+  for (uint32_t z = 0; z < grid.chunks.z; ++z) {
+    if (z + 1 < grid.chunks.z) {
+      sample_layer(next, z + 1);
+    }
+
+    jobs_->parallel_for(layer_size, 1, [&](const size_t begin, const size_t end) {
+      std::vector<float> window;
+      for (size_t i = begin; i < end; ++i) {
+        const glm::uvec3 index(static_cast<uint32_t>(i % grid.chunks.x), static_cast<uint32_t>(i / grid.chunks.x), z);
+        create_vertices(evaluator_->tape(), grid, layer, next, index, layer[i], window);
+      }
+    });
+    // The vertices are numbered in the order of the chunks, which does not depend on the order they were created in
+    for (Chunk& chunk : layer) {
+      stats.sample_count += chunk.evaluated;
+      if (first_vertex + vertex_count + chunk.vertices.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("SdfMesher: the mesh has too many vertices");
+      }
+      chunk.first_vertex = static_cast<uint32_t>(first_vertex + vertex_count);
+      vertex_count += chunk.vertices.size();
+      writer.write_vertices(chunk.vertices);
+      chunk.vertices = {};
+    }
+
+    jobs_->parallel_for(layer_size, 1, [&](const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const glm::uvec3 index(static_cast<uint32_t>(i % grid.chunks.x), static_cast<uint32_t>(i / grid.chunks.x), z);
+        create_triangles(grid, layer, previous, index, layer[i]);
+      }
+    });
+    for (Chunk& chunk : layer) {
+      stats.triangle_count += chunk.triangles.size() / 3;
+      writer.write_triangles(chunk.triangles);
+      chunk.triangles = {};
+      chunk.samples   = {};
+    }
+
+    // The samples of the next layer are still needed, the cells of this one only by the quads of the next one
+    previous = std::move(layer);
+    layer    = std::move(next);
+    next     = Layer();
+  }
+
+  stats.vertex_count = vertex_count;
+  return stats;
+}
+
+}  // namespace resin
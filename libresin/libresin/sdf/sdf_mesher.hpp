@@ -0,0 +1,61 @@
+#ifndef RESIN_SDF_MESHER_HPP
+#define RESIN_SDF_MESHER_HPP
+#include <cstddef>
+#include <cstdint>
+#include <libresin/core/aabb.hpp>
+
+namespace resin {
+
+class JobSystem;
+class MeshWriter;
+class SdfEvaluator;
+
+struct SdfMeshStats {
+  size_t vertex_count      = 0;
+  size_t triangle_count    = 0;
+  size_t chunk_count       = 0;
+  // Chunks whose distance bounds exclude the surface, none of their samples are evaluated
+  size_t empty_chunk_count = 0;
+  size_t sample_count      = 0;
+};
+
+/*
+  Extracts the surface (the zero level set) of the field of an `SdfEvaluator` as a triangle mesh with dual contouring:
+  every grid cell the surface passes through gets one vertex, placed at the mean of the points where the surface
+  crosses the edges of the cell, and every crossed edge becomes a quad between the vertices of the 4 cells around it.
+  The mesh is closed and consistently oriented wherever the surface does not leave the meshed region.
+
+  The grid is sparse: it is split into chunks of `kChunkCells`^3 cells, a chunk whose distance bounds (see
+  `SdfTape::bounds`) exclude the surface is never sampled, and the others are sampled in blocks of `kBlockCells`^3
+  cells with the tape pruned for every block, skipping the empty blocks the same way. Chunks are processed in parallel,
+  one layer of chunks along z at a time, and streamed into the `MeshWriter` before the next layer, so only two layers
+  of chunks are ever in memory. Every sample is evaluated by the chunk that owns it and every vertex is created by the
+  chunk that owns its cell, so the chunks agree on the shared vertices without any locks and the output does not
+  depend on the number of threads.
+*/
+class SdfMesher {
+ public:
+  static constexpr uint32_t kChunkCells = 32;
+  static constexpr uint32_t kBlockCells = 8;
+  // Cells along any axis of the grid
+  static constexpr uint32_t kMaxGridCells = 1U << 20U;
+
+  SdfMesher(const SdfEvaluator& evaluator, JobSystem& jobs);
+
+  // Meshes the surface within the region on a grid of cubic cells with edges of `cell_size`, appending it to the
+  // writer, which is not finished. Throws `std::invalid_argument` if the cell size is not positive or the grid would
+  // have more than `kMaxGridCells` cells along an axis, and `std::logic_error` if the evaluator is not up to date.
+  SdfMeshStats mesh(const Aabb& region, float cell_size, MeshWriter& writer) const;
+  // Same as above, over the whole scene: the bounds of the primitives grown by the reach of the blends and a cell.
+  SdfMeshStats mesh(float cell_size, MeshWriter& writer) const;
+
+  // Region containing the whole surface of the scene, empty if there are no primitives.
+  Aabb scene_bounds() const;
+
+ private:
+  const SdfEvaluator* evaluator_;
+  JobSystem* jobs_;
+};  // class SdfMesher
+
+}  // namespace resin
+#endif  // RESIN_SDF_MESHER_HPP
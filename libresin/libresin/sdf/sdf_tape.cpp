@@ -0,0 +1,552 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <glm/geometric.hpp>
+#include <libresin/core/aabb.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_bvh.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <libresin/utils/simd.hpp>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+/*
+  The distance functions are written once against a lane type (see `simd.hpp`). Points are passed as separate x, y and
+  z lanes.
+*/
+
+template <typename V>
+V length_lanes(const V& x, const V& y) {
+  return simd::sqrt(x * x + y * y);
+}
+
+template <typename V>
+V length_lanes(const V& x, const V& y, const V& z) {
+  return simd::sqrt(x * x + y * y + z * z);
+}
+
+template <typename V>
+V clamp_lanes(const V& x, const V& lo, const V& hi) {
+  return simd::min(simd::max(x, lo), hi);
+}
+
+template <typename V>
+V sphere_lanes(const V (&p)[3], const glm::vec4& params) {
+  return length_lanes(p[0], p[1], p[2]) - V(params.x);
+}
+
+template <typename V>
+V box_lanes(const V (&p)[3], const glm::vec4& params) {
+  const V zero(0.0F);
+  const V qx      = simd::abs(p[0]) - V(params.x);
+  const V qy      = simd::abs(p[1]) - V(params.y);
+  const V qz      = simd::abs(p[2]) - V(params.z);
+  const V outside = length_lanes(simd::max(qx, zero), simd::max(qy, zero), simd::max(qz, zero));
+  const V inside  = simd::min(simd::max(qx, simd::max(qy, qz)), zero);
+  return outside + inside;
+}
+
+template <typename V>
+V torus_lanes(const V (&p)[3], const glm::vec4& params) {
+  const V ring = length_lanes(p[0], p[2]) - V(params.x);
+  return length_lanes(ring, p[1]) - V(params.y);
+}
+
+template <typename V>
+V capsule_lanes(const V (&p)[3], const glm::vec4& params) {
+  const V half_height(params.x);
+  const V y = p[1] - clamp_lanes(p[1], -half_height, half_height);
+  return length_lanes(p[0], y, p[2]) - V(params.y);
+}
+
+template <typename V>
+V cylinder_lanes(const V (&p)[3], const glm::vec4& params) {
+  const V zero(0.0F);
+  const V dr = length_lanes(p[0], p[2]) - V(params.y);
+  const V dy = simd::abs(p[1]) - V(params.x);
+  return simd::min(simd::max(dr, dy), zero) + length_lanes(simd::max(dr, zero), simd::max(dy, zero));
+}
+
+// Polynomial smooth minimum, `sign` is 1 for the union and -1 for the intersection
+template <typename V>
+V smooth_lanes(const V& a, const V& b, float blend, float sign) {
+  const V k(blend);
+  const V half(0.5F);
+  const V h = clamp_lanes(half + V(0.5F * sign) * (b - a) / k, V(0.0F), V(1.0F));
+  return b + (a - b) * h - V(sign) * k * h * (V(1.0F) - h);
+}
+
+template <typename V>
+V primitive_lanes(const SdfNodeType type, const SdfTapePrimitive& primitive, const V (&p)[3]) {
+  V local[3];
+  for (size_t r = 0; r < 3; ++r) {
+    const glm::vec4& row = primitive.world_to_local.rows[r];
+    local[r]             = V(row.x) * p[0] + V(row.y) * p[1] + V(row.z) * p[2] + V(row.w);
+  }
+
+  V distance;
+  switch (type) {
+    case SdfNodeType::Sphere:
+      distance = sphere_lanes(local, primitive.params);
+      break;
+    case SdfNodeType::Box:
+      distance = box_lanes(local, primitive.params);
+      break;
+    case SdfNodeType::Torus:
+      distance = torus_lanes(local, primitive.params);
+      break;
+    case SdfNodeType::Capsule:
+      distance = capsule_lanes(local, primitive.params);
+      break;
+    default:
+      distance = cylinder_lanes(local, primitive.params);
+      break;
+  }
+  return distance * V(primitive.scale);
+}
+
+template <typename V>
+V run_lanes(std::span<const SdfInstruction> instructions, std::span<const SdfTapePrimitive> primitives,
+            const V (&p)[3]) {
+  V registers[SdfTape::kMaxRegisters];
+  for (const SdfInstruction& instruction : instructions) {
+    const V& a = registers[instruction.lhs];
+    const V& b = registers[instruction.rhs];
+    V& out     = registers[instruction.out];
+    switch (instruction.type) {
+      case SdfNodeType::Union:
+        out = simd::min(a, b);
+        break;
+      case SdfNodeType::Intersection:
+        out = simd::max(a, b);
+        break;
+      case SdfNodeType::Subtraction:
+        out = simd::max(a, -b);
+        break;
+      case SdfNodeType::SmoothUnion:
+        out = smooth_lanes(a, b, instruction.blend, 1.0F);
+        break;
+      case SdfNodeType::SmoothIntersection:
+        out = smooth_lanes(a, b, instruction.blend, -1.0F);
+        break;
+      case SdfNodeType::SmoothSubtraction:
+        out = smooth_lanes(a, -b, instruction.blend, -1.0F);
+        break;
+      default:
+        out = primitive_lanes(instruction.type, primitives[instruction.primitive], p);
+        break;
+    }
+  }
+  return registers[instructions.back().out];
+}
+
+#ifdef RESIN_SIMD_SSE
+void run_sse(std::span<const SdfInstruction> instructions, std::span<const SdfTapePrimitive> primitives,
+             const glm::vec3* points, float* out) {
+  simd::F4 p[3];
+  simd::load_vec3_lanes(points, p);
+  simd::store_lanes(run_lanes(instructions, primitives, p), out);
+}
+#endif
+
+#ifdef RESIN_SIMD_AVX2
+void run_avx2(std::span<const SdfInstruction> instructions, std::span<const SdfTapePrimitive> primitives,
+              const glm::vec3* points, float* out) {
+  simd::F8 p[3];
+  simd::load_vec3_lanes(points, p);
+  simd::store_lanes(run_lanes(instructions, primitives, p), out);
+}
+#endif
+
+void bake_transform(SdfTapePrimitive& primitive) {
+  // The columns of the local-to-world matrix are the axes of the primitive scaled to the world
+  const Transform& transform      = *primitive.transform;
+  const glm::mat4 local_to_world  = transform.local_to_world_matrix();
+  primitive.world_to_local        = AffineMatrix(transform.world_to_local_matrix());
+  primitive.scale                 = glm::min(glm::length(glm::vec3(local_to_world[0])),
+                                             glm::min(glm::length(glm::vec3(local_to_world[1])),
+                                                      glm::length(glm::vec3(local_to_world[2]))));
+  primitive.transform_generation  = transform.generation();
+}
+
+}  // namespace
+
+SdfTape SdfTape::compile(const SdfTree& tree) {
+  using NodeId      = SdfTree::NodeId;
+  const NodeId root = tree.root();
+  if (root == SdfTree::kInvalidNode) {
+    return {};
+  }
+
+  // Registers needed by the subtree of every node (Sethi-Ullman numbers), the children are placed before the parents
+  const std::vector<SdfNode>& nodes = tree.nodes();
+  std::vector<uint32_t> needed(root + 1);
+  for (NodeId id = 0; id <= root; ++id) {
+    const SdfNode& node = nodes[id];
+    if (is_primitive(node.type)) {
+      needed[id] = 1;
+    } else {
+      const uint32_t lhs = needed[node.lhs];
+      const uint32_t rhs = needed[node.rhs];
+      needed[id]         = lhs == rhs ? lhs + 1 : std::max(lhs, rhs);
+    }
+  }
+  const auto lhs_first = [&](const SdfNode& node) { return needed[node.lhs] >= needed[node.rhs]; };
+
+  // Post-order walk with an explicit stack, so that deep trees do not overflow the call stack
+  struct Visit {
+    NodeId id;
+    bool children_done;
+  };
+  std::vector<Visit> stack = {{root, false}};
+  std::vector<uint32_t> results;
+  std::vector<Value> values;
+  std::vector<SdfTapePrimitive> primitives;
+  // Value computed by every node, the nodes shared by several operations are compiled once and their value is reused
+  constexpr uint32_t kNoValue = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> value_of(root + 1, kNoValue);
+
+  while (!stack.empty()) {
+    const Visit visit = stack.back();
+    stack.pop_back();
+    const SdfNode& node = nodes[visit.id];
+
+    if (!visit.children_done && value_of[visit.id] != kNoValue) {
+      results.push_back(value_of[visit.id]);
+      continue;
+    }
+
+    if (is_primitive(node.type)) {
+      SdfTapePrimitive& primitive = primitives.emplace_back();
+      primitive.params            = node.params;
+      primitive.type              = node.type;
+      primitive.node              = visit.id;
+      primitive.transform         = node.transform;
+      bake_transform(primitive);
+
+      value_of[visit.id] = static_cast<uint32_t>(values.size());
+      results.push_back(value_of[visit.id]);
+      values.push_back(Value{.type = node.type, .primitive = static_cast<uint32_t>(primitives.size() - 1)});
+      continue;
+    }
+
+    if (!visit.children_done) {
+      // The child needing more registers is evaluated first, while fewer values are held
+      stack.push_back({visit.id, true});
+      stack.push_back({lhs_first(node) ? node.rhs : node.lhs, false});
+      stack.push_back({lhs_first(node) ? node.lhs : node.rhs, false});
+      continue;
+    }
+
+    const uint32_t second = results.back();
+    results.pop_back();
+    const uint32_t first = results.back();
+    results.pop_back();
+
+    value_of[visit.id] = static_cast<uint32_t>(values.size());
+    results.push_back(value_of[visit.id]);
+    values.push_back(Value{.type  = node.type,
+                           .lhs   = lhs_first(node) ? first : second,
+                           .rhs   = lhs_first(node) ? second : first,
+                           .blend = node.params.x});
+  }
+
+  return allocate_registers(values, std::move(primitives));
+}
+
+SdfTape SdfTape::allocate_registers(std::span<const Value> values, std::vector<SdfTapePrimitive> primitives) {
+  // The last value is the result, it is never released
+  std::vector<size_t> last_use(values.size(), values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (!is_primitive(values[i].type)) {
+      last_use[values[i].lhs] = i;
+      last_use[values[i].rhs] = i;
+    }
+  }
+
+  SdfTape tape;
+  tape.primitives_ = std::move(primitives);
+  tape.instructions_.reserve(values.size());
+  std::vector<uint8_t> register_of(values.size());
+  uint32_t used = 0;  // bit mask of the registers holding live values
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    const Value& value = values[i];
+    SdfInstruction instruction{.type = value.type, .out = 0, .lhs = 0, .rhs = 0, .primitive = 0, .blend = 0.0F};
+    if (is_primitive(value.type)) {
+      instruction.primitive = value.primitive;
+    } else {
+      instruction.lhs   = register_of[value.lhs];
+      instruction.rhs   = register_of[value.rhs];
+      instruction.blend = value.blend;
+      // The operands are read before the result is written, so the result may reuse their registers
+      for (const uint32_t operand : {value.lhs, value.rhs}) {
+        if (last_use[operand] == i) {
+          used &= ~(1U << register_of[operand]);
+        }
+      }
+    }
+
+    const auto free = static_cast<size_t>(std::countr_zero(~used));
+    if (free >= kMaxRegisters) {
+      throw std::length_error("SdfTape: the field needs too many registers");
+    }
+    used |= 1U << free;
+    register_of[i]       = static_cast<uint8_t>(free);
+    instruction.out      = register_of[i];
+    tape.register_count_ = std::max(tape.register_count_, free + 1);
+    tape.instructions_.push_back(instruction);
+  }
+  return tape;
+}
+
+std::vector<SdfTape::Value> SdfTape::to_values() const {
+  // Every register read refers to the value most recently written to it
+  std::vector<Value> values;
+  values.reserve(instructions_.size());
+  uint32_t producer[kMaxRegisters] = {};
+  for (const SdfInstruction& instruction : instructions_) {
+    values.push_back(Value{.type      = instruction.type,
+                           .lhs       = producer[instruction.lhs],
+                           .rhs       = producer[instruction.rhs],
+                           .primitive = instruction.primitive,
+                           .blend     = instruction.blend});
+    producer[instruction.out] = static_cast<uint32_t>(values.size() - 1);
+  }
+  return values;
+}
+
+std::vector<SdfInterval> SdfTape::intervals(std::span<const Value> values, const glm::vec3& min, const glm::vec3& max,
+                                            std::span<const SdfInterval> primitive_ranges) const {
+  // The fields are 1-Lipschitz, so a distance within the region differs from the one at its center by at most the
+  // radius of the region
+  const glm::vec3 center = (min + max) * 0.5F;
+  const float radius     = glm::length(max - min) * 0.5F;
+  const float c[3]       = {center.x, center.y, center.z};
+
+  std::vector<SdfInterval> result(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    const Value& value = values[i];
+    if (is_primitive(value.type)) {
+      if (!primitive_ranges.empty()) {
+        result[i] = primitive_ranges[value.primitive];
+      } else {
+        const float distance = primitive_lanes(value.type, primitives_[value.primitive], c);
+        result[i]            = {distance - radius, distance + radius};
+      }
+      continue;
+    }
+
+    const SdfInterval a = result[value.lhs];
+    const SdfInterval b = result[value.rhs];
+    // The smooth union is at most a quarter of the blend radius below the union, the intersection above
+    const float blend = value.blend * 0.25F;
+    switch (value.type) {
+      case SdfNodeType::Union:
+        result[i] = {std::min(a.min, b.min), std::min(a.max, b.max)};
+        break;
+      case SdfNodeType::Intersection:
+        result[i] = {std::max(a.min, b.min), std::max(a.max, b.max)};
+        break;
+      case SdfNodeType::Subtraction:
+        result[i] = {std::max(a.min, -b.max), std::max(a.max, -b.min)};
+        break;
+      case SdfNodeType::SmoothUnion:
+        result[i] = {std::min(a.min, b.min) - blend, std::min(a.max, b.max)};
+        break;
+      case SdfNodeType::SmoothIntersection:
+        result[i] = {std::max(a.min, b.min), std::max(a.max, b.max) + blend};
+        break;
+      default:
+        result[i] = {std::max(a.min, -b.max), std::max(a.max, -b.min) + blend};
+        break;
+    }
+  }
+  return result;
+}
+
+SdfInterval SdfTape::bounds(const glm::vec3& min, const glm::vec3& max) const {
+  if (empty()) {
+    return {std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+  }
+  return intervals(to_values(), min, max).back();
+}
+
+SdfTape SdfTape::prune(const glm::vec3& min, const glm::vec3& max) const {
+  if (empty()) {
+    return {};
+  }
+
+  const std::vector<Value> values = to_values();
+  return prune(values, intervals(values, min, max));
+}
+
+SdfTape SdfTape::prune(const glm::vec3& min, const glm::vec3& max, const SdfBvh& bvh) const {
+  if (empty()) {
+    return {};
+  }
+  if (bvh.primitive_count() != primitives_.size()) {
+    throw std::invalid_argument("SdfTape: the BVH has been built over another tape");
+  }
+
+  // The primitives further than the margin from the region are at least the margin away from every point of it. With
+  // the blend radius included, they cannot be blended with the primitives within the region either.
+  const float diameter = glm::length(max - min);
+  float margin         = diameter;
+  for (const SdfInstruction& instruction : instructions_) {
+    if (is_smooth(instruction.type)) {
+      margin = std::max(margin, diameter + instruction.blend);
+    }
+  }
+
+  std::vector<SdfInterval> ranges(primitives_.size());
+  for (size_t i = 0; i < primitives_.size(); ++i) {
+    ranges[i] = {margin * bvh.distance_ratio(i), std::numeric_limits<float>::infinity()};
+  }
+
+  std::vector<uint32_t> nearby;
+  bvh.query(Aabb(min - glm::vec3(margin), max + glm::vec3(margin)), nearby);
+  const glm::vec3 center = (min + max) * 0.5F;
+  for (const uint32_t i : nearby) {
+    const float distance = evaluate_primitive(i, center);
+    ranges[i]            = {distance - diameter * 0.5F, distance + diameter * 0.5F};
+  }
+
+  const std::vector<Value> values = to_values();
+  return prune(values, intervals(values, min, max, ranges));
+}
+
+SdfTape SdfTape::prune(std::span<const Value> values, std::span<const SdfInterval> ranges) const {
+  // An operation decided by one of its children within the region is replaced with that child. The smooth operations
+  // have to be decided by more than the blend radius, otherwise the children are still blended.
+  std::vector<uint32_t> replacement(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    replacement[i]     = static_cast<uint32_t>(i);
+    const Value& value = values[i];
+    if (is_primitive(value.type)) {
+      continue;
+    }
+
+    const SdfInterval& a = ranges[value.lhs];
+    const SdfInterval& b = ranges[value.rhs];
+    const float margin   = is_smooth(value.type) ? value.blend : 0.0F;
+    switch (value.type) {
+      case SdfNodeType::Union:
+      case SdfNodeType::SmoothUnion:
+        if (a.min >= b.max + margin) {
+          replacement[i] = replacement[value.rhs];
+        } else if (b.min >= a.max + margin) {
+          replacement[i] = replacement[value.lhs];
+        }
+        break;
+      case SdfNodeType::Intersection:
+      case SdfNodeType::SmoothIntersection:
+        if (b.min >= a.max + margin) {
+          replacement[i] = replacement[value.rhs];
+        } else if (a.min >= b.max + margin) {
+          replacement[i] = replacement[value.lhs];
+        }
+        break;
+      default:
+        // The negated right child is never the result on its own, there is no instruction to negate it
+        if (a.min >= -b.min + margin) {
+          replacement[i] = replacement[value.lhs];
+        }
+        break;
+    }
+  }
+
+  // Only the values the result depends on are kept, they are all placed before it
+  const uint32_t result = replacement.back();
+  std::vector<uint8_t> live(values.size(), 0);
+  live[result] = 1;
+  for (size_t i = result + 1; i-- > 0;) {
+    if (live[i] != 0 && !is_primitive(values[i].type)) {
+      live[replacement[values[i].lhs]] = 1;
+      live[replacement[values[i].rhs]] = 1;
+    }
+  }
+
+  std::vector<uint32_t> new_index(values.size());
+  std::vector<Value> pruned;
+  std::vector<SdfTapePrimitive> primitives;
+  for (size_t i = 0; i <= result; ++i) {
+    if (live[i] == 0) {
+      continue;
+    }
+
+    Value value = values[i];
+    if (is_primitive(value.type)) {
+      primitives.push_back(primitives_[value.primitive]);
+      value.primitive = static_cast<uint32_t>(primitives.size() - 1);
+    } else {
+      value.lhs = new_index[replacement[value.lhs]];
+      value.rhs = new_index[replacement[value.rhs]];
+    }
+    new_index[i] = static_cast<uint32_t>(pruned.size());
+    pruned.push_back(value);
+  }
+
+  return allocate_registers(pruned, std::move(primitives));
+}
+
+bool SdfTape::refresh_transforms() {
+  bool changed = false;
+  for (SdfTapePrimitive& primitive : primitives_) {
+    if (primitive.transform_generation != primitive.transform->generation()) {
+      bake_transform(primitive);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+float SdfTape::evaluate_primitive(const size_t index, const glm::vec3& point) const {
+  const SdfTapePrimitive& primitive = primitives_[index];
+  const float p[3]                  = {point.x, point.y, point.z};
+  return primitive_lanes(primitive.type, primitive, p);
+}
+
+float SdfTape::evaluate(const glm::vec3& point) const {
+  if (empty()) {
+    return std::numeric_limits<float>::infinity();
+  }
+
+  const float p[3] = {point.x, point.y, point.z};
+  return run_lanes(std::span(instructions_), std::span(primitives_), p);
+}
+
+void SdfTape::evaluate(std::span<const glm::vec3> points, std::span<float> out) const {
+  const size_t count = out.size();
+  if (points.size() != count) {
+    throw std::invalid_argument("SdfTape: the points and the output must have the same size");
+  }
+  if (empty()) {
+    std::ranges::fill(out, std::numeric_limits<float>::infinity());
+    return;
+  }
+
+  const std::span<const SdfInstruction> instructions(instructions_);
+  const std::span<const SdfTapePrimitive> primitives(primitives_);
+  size_t i = 0;
+#ifdef RESIN_SIMD_AVX2
+  for (; i + 8 <= count; i += 8) {
+    run_avx2(instructions, primitives, &points[i], &out[i]);
+  }
+#endif
+#ifdef RESIN_SIMD_SSE
+  for (; i + 4 <= count; i += 4) {
+    run_sse(instructions, primitives, &points[i], &out[i]);
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = evaluate(points[i]);
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,123 @@
+#ifndef RESIN_SDF_TAPE_HPP
+#define RESIN_SDF_TAPE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <libresin/core/compact_transform.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+class SdfBvh;
+struct Transform;
+
+/*
+  Single instruction of an `SdfTape`. A primitive writes its distance to the `out` register, an operation combines the
+  `lhs` and `rhs` registers into the `out` one.
+*/
+struct SdfInstruction {
+  SdfNodeType type;
+  uint8_t out;
+  uint8_t lhs;
+  uint8_t rhs;
+  // Primitives only, index into `SdfTape::primitives()`
+  uint32_t primitive;
+  // Smooth operations only
+  float blend;
+};
+
+// Primitive of a tape with its transform baked into the world-to-local matrix
+struct SdfTapePrimitive {
+  AffineMatrix world_to_local;
+  glm::vec4 params;
+  // The distance in the local space is multiplied by `scale` to get the one in the world
+  float scale;
+  SdfNodeType type;
+  // Node of the tree the primitive was compiled from
+  SdfTree::NodeId node;
+  const Transform* transform;
+  uint32_t transform_generation;
+};
+
+// Range of the distances within a region
+struct SdfInterval {
+  float min;
+  float max;
+};
+
+/*
+  Signed distance field of an `SdfTree` lowered into a linear list of instructions on a small set of registers. The
+  interpreter executes the list once per batch of points (8 with AVX2, 4 with SSE, see `SdfEvaluator`) without any
+  recursion or pointer chasing, with the primitive data laid out in the order it is read.
+
+  The children of every operation are emitted in the order that needs fewer registers, so a tree with N primitives never
+  needs more than log2(N) + 1 of them. Subtrees shared by several operations are evaluated once and their result stays
+  in its register until the last use, so sharing may need more registers than that.
+
+  `prune` specializes the tape for a region of space: the operations whose result in the region is decided by one of
+  their children are replaced by that child, so the primitives that are too far away to affect the region are not
+  evaluated at all.
+*/
+class SdfTape {
+ public:
+  static constexpr size_t kMaxRegisters = 32;
+
+  // Empty tape, the field is infinitely far away everywhere.
+  SdfTape() = default;
+
+  // Reads the world matrices of the transforms of the primitives, the transforms are only referenced afterwards.
+  // Throws `std::length_error` if the field needs more than `kMaxRegisters` registers at once.
+  static SdfTape compile(const SdfTree& tree);
+
+  // Bakes the world matrices of the transforms that have changed since the tape was compiled or last refreshed. Returns
+  // whether any of them has changed.
+  bool refresh_transforms();
+
+  // Returns the tape evaluating to the same distances within the axis-aligned box [`min`, `max`].
+  SdfTape prune(const glm::vec3& min, const glm::vec3& max) const;
+  // Same as above, but only the primitives the BVH finds close to the region are measured, the others are bounded by
+  // their distance to the region. The BVH has to be built over this tape.
+  SdfTape prune(const glm::vec3& min, const glm::vec3& max, const SdfBvh& bvh) const;
+  // Returns a conservative range of the distances within the axis-aligned box [`min`, `max`]. A region whose range does
+  // not contain 0 does not contain the surface.
+  SdfInterval bounds(const glm::vec3& min, const glm::vec3& max) const;
+
+  float evaluate(const glm::vec3& point) const;
+  // Distance to a single primitive of the tape, regardless of the operations it takes part in.
+  float evaluate_primitive(size_t index, const glm::vec3& point) const;
+  // `points` and `out` must have the same size.
+  void evaluate(std::span<const glm::vec3> points, std::span<float> out) const;
+
+  const std::vector<SdfInstruction>& instructions() const { return instructions_; }
+  const std::vector<SdfTapePrimitive>& primitives() const { return primitives_; }
+  size_t register_count() const { return register_count_; }
+  bool empty() const { return instructions_.empty(); }
+
+ private:
+  // Instruction referring to the values of the previous instructions by their indices, before register allocation
+  struct Value {
+    SdfNodeType type   = SdfNodeType::Sphere;
+    uint32_t lhs       = 0;
+    uint32_t rhs       = 0;
+    uint32_t primitive = 0;
+    float blend        = 0.0F;
+  };
+
+  static SdfTape allocate_registers(std::span<const Value> values, std::vector<SdfTapePrimitive> primitives);
+  std::vector<Value> to_values() const;
+  // Ranges of the values within the region, the ones of the primitives may be given by the caller
+  std::vector<SdfInterval> intervals(std::span<const Value> values, const glm::vec3& min, const glm::vec3& max,
+                                     std::span<const SdfInterval> primitive_ranges = {}) const;
+  SdfTape prune(std::span<const Value> values, std::span<const SdfInterval> ranges) const;
+
+ private:
+  std::vector<SdfInstruction> instructions_;
+  std::vector<SdfTapePrimitive> primitives_;
+  size_t register_count_ = 0;
+};  // class SdfTape
+
+}  // namespace resin
+#endif  // RESIN_SDF_TAPE_HPP
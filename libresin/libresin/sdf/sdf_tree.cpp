@@ -0,0 +1,77 @@
+#include <libresin/sdf/sdf_tree.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+SdfTree::NodeId SdfTree::create_sphere(const Transform& transform, const float radius) {
+  return create_primitive(SdfNodeType::Sphere, transform, glm::vec4(radius, 0.0F, 0.0F, 0.0F));
+}
+
+SdfTree::NodeId SdfTree::create_box(const Transform& transform, const glm::vec3& half_extents) {
+  return create_primitive(SdfNodeType::Box, transform, glm::vec4(half_extents, 0.0F));
+}
+
+SdfTree::NodeId SdfTree::create_torus(const Transform& transform, const float major_radius, const float minor_radius) {
+  return create_primitive(SdfNodeType::Torus, transform, glm::vec4(major_radius, minor_radius, 0.0F, 0.0F));
+}
+
+SdfTree::NodeId SdfTree::create_capsule(const Transform& transform, const float half_height, const float radius) {
+  return create_primitive(SdfNodeType::Capsule, transform, glm::vec4(half_height, radius, 0.0F, 0.0F));
+}
+
+SdfTree::NodeId SdfTree::create_cylinder(const Transform& transform, const float half_height, const float radius) {
+  return create_primitive(SdfNodeType::Cylinder, transform, glm::vec4(half_height, radius, 0.0F, 0.0F));
+}
+
+SdfTree::NodeId SdfTree::create_primitive(const SdfNodeType type, const Transform& transform,
+                                          const glm::vec4& params) {
+  nodes_.push_back(SdfNode{.type = type, .params = params, .transform = &transform});
+  ++version_;
+  return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+SdfTree::NodeId SdfTree::create_operation(const SdfNodeType type, const NodeId lhs, const NodeId rhs,
+                                          const float blend) {
+  if (is_primitive(type)) {
+    throw std::invalid_argument("SdfTree: a primitive is not an operation");
+  }
+  if (!contains(lhs) || !contains(rhs)) {
+    throw std::out_of_range("SdfTree: unknown child node");
+  }
+  if (is_smooth(type) && !(blend > 0.0F)) {
+    throw std::invalid_argument("SdfTree: the blend radius of a smooth operation has to be positive");
+  }
+
+  nodes_.push_back(SdfNode{.type = type, .params = glm::vec4(blend, 0.0F, 0.0F, 0.0F), .lhs = lhs, .rhs = rhs});
+  ++version_;
+  return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void SdfTree::set_params(const NodeId id, const glm::vec4& params) {
+  if (!contains(id)) {
+    throw std::out_of_range("SdfTree: unknown node");
+  }
+  if (is_smooth(nodes_[id].type) && !(params.x > 0.0F)) {
+    throw std::invalid_argument("SdfTree: the blend radius of a smooth operation has to be positive");
+  }
+
+  nodes_[id].params = params;
+  ++version_;
+}
+
+void SdfTree::set_root(const NodeId id) {
+  if (id != kInvalidNode && !contains(id)) {
+    throw std::out_of_range("SdfTree: unknown node");
+  }
+
+  root_ = id;
+  ++version_;
+}
+
+void SdfTree::clear() {
+  nodes_.clear();
+  root_ = kInvalidNode;
+  ++version_;
+}
+
+}  // namespace resin
@@ -0,0 +1,109 @@
+#ifndef RESIN_SDF_TREE_HPP
+#define RESIN_SDF_TREE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <vector>
+
+namespace resin {
+
+struct Transform;
+
+enum class SdfNodeType : uint8_t {
+  // Primitives, centered at the origin of their transform
+  Sphere = 0,  // radius
+  Box,         // half extents
+  Torus,       // major radius, minor radius; lies in the xz plane
+  Capsule,     // half height of the segment, radius; along the y axis
+  Cylinder,    // half height, radius; along the y axis
+
+  // Operations on two child nodes
+  Union,
+  Intersection,
+  Subtraction,  // the right child is subtracted from the left one
+  SmoothUnion,  // smooth variants blend the children over the blend radius
+  SmoothIntersection,
+  SmoothSubtraction,
+};
+
+constexpr bool is_primitive(SdfNodeType type) { return type < SdfNodeType::Union; }
+constexpr bool is_smooth(SdfNodeType type) { return type >= SdfNodeType::SmoothUnion; }
+
+struct SdfNode {
+  SdfNodeType type = SdfNodeType::Sphere;
+  // Dimensions of a primitive in the order listed in `SdfNodeType`, `x` is the blend radius of a smooth operation
+  glm::vec4 params{};
+  // Primitives only, the transform places the primitive in the world
+  const Transform* transform = nullptr;
+  // Operations only
+  uint32_t lhs = 0;
+  uint32_t rhs = 0;
+};
+
+/*
+  Signed distance field built from primitives attached to `Transform`s and combined with CSG operations. Nodes are
+  stored in a flat array in creation order and the children of an operation have to exist when it is created, so every
+  node is placed after its children and the tree never contains cycles. Only the nodes reachable from the root
+  contribute to the field.
+
+  The transforms are referenced, not owned, and have to outlive the tree. A primitive is measured in the local space of
+  its transform, the distance is scaled back to the world by the smallest scale of the transform, which is exact for
+  uniform scale and a lower bound otherwise. Use `SdfEvaluator` to evaluate the field.
+*/
+class SdfTree {
+ public:
+  using NodeId                         = uint32_t;
+  static constexpr NodeId kInvalidNode = std::numeric_limits<NodeId>::max();
+
+  NodeId create_sphere(const Transform& transform, float radius);
+  NodeId create_box(const Transform& transform, const glm::vec3& half_extents);
+  NodeId create_torus(const Transform& transform, float major_radius, float minor_radius);
+  NodeId create_capsule(const Transform& transform, float half_height, float radius);
+  NodeId create_cylinder(const Transform& transform, float half_height, float radius);
+
+  NodeId create_union(NodeId lhs, NodeId rhs) { return create_operation(SdfNodeType::Union, lhs, rhs); }
+  NodeId create_intersection(NodeId lhs, NodeId rhs) { return create_operation(SdfNodeType::Intersection, lhs, rhs); }
+  NodeId create_subtraction(NodeId lhs, NodeId rhs) { return create_operation(SdfNodeType::Subtraction, lhs, rhs); }
+  NodeId create_smooth_union(NodeId lhs, NodeId rhs, float blend) {
+    return create_operation(SdfNodeType::SmoothUnion, lhs, rhs, blend);
+  }
+  NodeId create_smooth_intersection(NodeId lhs, NodeId rhs, float blend) {
+    return create_operation(SdfNodeType::SmoothIntersection, lhs, rhs, blend);
+  }
+  NodeId create_smooth_subtraction(NodeId lhs, NodeId rhs, float blend) {
+    return create_operation(SdfNodeType::SmoothSubtraction, lhs, rhs, blend);
+  }
+  // Throws `std::out_of_range` if a child does not exist and `std::invalid_argument` if a smooth operation has
+  // a non-positive blend radius.
+  NodeId create_operation(SdfNodeType type, NodeId lhs, NodeId rhs, float blend = 0.0F);
+
+  // Changes the dimensions of a primitive or the blend radius of an operation, see `SdfNode::params`.
+  void set_params(NodeId id, const glm::vec4& params);
+
+  // The field of an empty tree (without a root) is infinitely far away everywhere.
+  NodeId root() const { return root_; }
+  void set_root(NodeId id);
+
+  const SdfNode& node(NodeId id) const { return nodes_[id]; }
+  const std::vector<SdfNode>& nodes() const { return nodes_; }
+  size_t size() const { return nodes_.size(); }
+  bool contains(NodeId id) const { return id < nodes_.size(); }
+
+  void clear();
+
+  // Changes with every modification of the tree, so that the evaluators know when to refresh their copies of it.
+  uint32_t version() const { return version_; }
+
+ private:
+  NodeId create_primitive(SdfNodeType type, const Transform& transform, const glm::vec4& params);
+
+ private:
+  std::vector<SdfNode> nodes_;
+  NodeId root_      = kInvalidNode;
+  uint32_t version_ = 0;
+};  // class SdfTree
+
+}  // namespace resin
+#endif  // RESIN_SDF_TREE_HPP
@@ -0,0 +1,198 @@
+#include <array>
+#include <cstring>
+#include <functional>
+#include <libresin/utils/binary_log.hpp>
+#include <libresin/utils/log_args.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace resin {
+
+namespace {
+
+template <typename T>
+std::byte* put(std::byte* out, const T& value) {
+  std::memcpy(out, &value, sizeof(T));
+  return out + sizeof(T);
+}
+
+std::byte* put_string(std::byte* out, std::string_view str) {
+  out = put(out, static_cast<uint32_t>(str.size()));
+  std::memcpy(out, str.data(), str.size());
+  return out + str.size();
+}
+
+constexpr size_t string_size(std::string_view str) { return sizeof(uint32_t) + str.size(); }
+
+// Format of the preformatted messages, which are stored as a single string argument
+constexpr std::string_view kMessageFmt = "{}";
+
+}  // namespace
+
+BinaryLogWriter::BinaryLogWriter(const std::filesystem::path& path) : file_(path) {
+  std::byte* out = file_.append(sizeof(kBinaryLogMagic) + sizeof(kBinaryLogVersion)).data();
+  out            = put(out, kBinaryLogMagic);
+  put(out, kBinaryLogVersion);
+}
+
+size_t BinaryLogWriter::CallsiteKeyHash::operator()(const CallsiteKey& key) const {
+  size_t hash = std::hash<const void*>{}(key.fmt);
+  hash ^= std::hash<const void*>{}(key.file_path) + 0x9e3779b9 + (hash << 6U) + (hash >> 2U);  // NOLINT
+  hash ^= (static_cast<size_t>(key.line) << 16U) ^ key.column;
+  return hash;
+}
+
+uint32_t BinaryLogWriter::intern_callsite(const LogRecord& record, const std::string_view fmt) {
+  const LogLocation& location = record.location();
+  const CallsiteKey key{.fmt       = fmt.data(),
+                        .file_path = location.file_path.data(),
+                        .line      = location.line,
+                        .column    = location.column};
+
+  const auto [it, inserted] = callsites_.try_emplace(key, static_cast<uint32_t>(callsites_.size()));
+  if (!inserted) {
+    return it->second;
+  }
+
+  const size_t size = sizeof(BinaryLogEntry) + sizeof(uint32_t) + 2 * sizeof(uint8_t) + 2 * sizeof(uint32_t) +
+                      string_size(fmt) + string_size(location.file_path) +
+                      string_size(location.function_name);
+
+  std::byte* out = file_.append(size).data();
+  out            = put(out, BinaryLogEntry::Callsite);
+  out            = put(out, it->second);
+  out            = put(out, static_cast<uint8_t>(record.level()));
+  out            = put(out, static_cast<uint8_t>(record.is_debug_msg()));
+  out            = put(out, location.line);
+  out            = put(out, location.column);
+  out            = put_string(out, fmt);
+  out            = put_string(out, location.file_path);
+  put_string(out, location.function_name);
+
+  return it->second;
+}
+
+void BinaryLogWriter::write(const LogRecord& record) {
+  if (timestamp_mode_ != record.timestamp_mode()) {
+    std::byte* out = file_.append(sizeof(BinaryLogEntry) + sizeof(LogTimestampMode)).data();
+    out            = put(out, BinaryLogEntry::TimestampMode);
+    put(out, record.timestamp_mode());
+    timestamp_mode_ = record.timestamp_mode();
+  }
+
+  // The format specs of a preformatted message may not apply to its arguments (e.g. these were truncated)
+  std::array<std::byte, kMaxLogArgsSize> message_args;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+  std::string_view fmt            = record.fmt();
+  std::span<const std::byte> args = record.args();
+  if (record.preformatted()) {
+    fmt  = kMessageFmt;
+    args = std::span(message_args).first(encode_log_args(message_args, record.message()));
+  }
+
+  const uint32_t callsite = intern_callsite(record, fmt);
+  const int64_t ticks =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(record.time_point().time_since_epoch()).count();
+
+  std::byte* out = file_.append(sizeof(BinaryLogEntry) + sizeof(int64_t) + 2 * sizeof(uint32_t) + args.size()).data();
+  out            = put(out, BinaryLogEntry::Message);
+  out            = put(out, ticks);
+  out            = put(out, callsite);
+  out            = put(out, static_cast<uint32_t>(args.size()));
+  std::memcpy(out, args.data(), args.size());
+}
+
+BinaryLogReader::BinaryLogReader(std::span<const std::byte> data) : data_(data) {
+  if (data_.size() < sizeof(kBinaryLogMagic) + sizeof(kBinaryLogVersion) ||
+      std::memcmp(data_.data(), kBinaryLogMagic.data(), kBinaryLogMagic.size()) != 0) {
+    throw std::runtime_error("BinaryLogReader: not a resin binary log");
+  }
+
+  offset_ = sizeof(kBinaryLogMagic);
+  if (const auto version = read<uint32_t>(); version != kBinaryLogVersion) {
+    throw std::runtime_error("BinaryLogReader: unsupported version " + std::to_string(version));
+  }
+}
+
+template <typename T>
+T BinaryLogReader::read() {
+  if (data_.size() - offset_ < sizeof(T)) {
+    throw std::runtime_error("BinaryLogReader: unexpected end of the log");
+  }
+
+  T value;
+  std::memcpy(&value, &data_[offset_], sizeof(T));
+  offset_ += sizeof(T);
+  return value;
+}
+
+std::string_view BinaryLogReader::read_string() {
+  const auto size = read<uint32_t>();
+  if (data_.size() - offset_ < size) {
+    throw std::runtime_error("BinaryLogReader: unexpected end of the log");
+  }
+
+  const std::string_view str(reinterpret_cast<const char*>(&data_[offset_]), size);
+  offset_ += size;
+  return str;
+}
+
+std::optional<BinaryLogMessage> BinaryLogReader::next() {
+  while (offset_ < data_.size()) {
+    const auto entry = read<BinaryLogEntry>();
+    switch (entry) {
+      case BinaryLogEntry::End:
+        return std::nullopt;
+
+      case BinaryLogEntry::Callsite: {
+        const auto id = read<uint32_t>();
+        if (id != callsites_.size()) {
+          throw std::runtime_error("BinaryLogReader: callsites are out of order");
+        }
+
+        BinaryLogCallsite& callsite = callsites_.emplace_back();
+        callsite.level                  = static_cast<LogLevel>(read<uint8_t>());
+        callsite.is_debug_msg           = read<uint8_t>() != 0;
+        callsite.location.line          = read<uint32_t>();
+        callsite.location.column        = read<uint32_t>();
+        callsite.fmt                    = read_string();
+        callsite.location.file_path     = read_string();
+        callsite.location.function_name = read_string();
+        break;
+      }
+
+      case BinaryLogEntry::TimestampMode: {
+        const auto mode = read<uint8_t>();
+        if (mode > static_cast<uint8_t>(LogTimestampMode::Monotonic)) {
+          throw std::runtime_error("BinaryLogReader: unknown timestamp mode");
+        }
+        timestamp_mode_ = static_cast<LogTimestampMode>(mode);
+        break;
+      }
+
+      case BinaryLogEntry::Message: {
+        const auto ticks = read<int64_t>();
+        const auto id    = read<uint32_t>();
+        const auto size  = read<uint32_t>();
+        if (id >= callsites_.size() || data_.size() - offset_ < size) {
+          throw std::runtime_error("BinaryLogReader: corrupted message");
+        }
+
+        const auto args = data_.subspan(offset_, size);
+        offset_ += size;
+        return BinaryLogMessage{
+            .time_point = std::chrono::time_point<std::chrono::system_clock>(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ticks))),
+            .timestamp_mode = timestamp_mode_,
+            .callsite       = &callsites_[id],
+            .args           = args};
+      }
+
+      default:
+        throw std::runtime_error("BinaryLogReader: unknown entry");
+    }
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace resin
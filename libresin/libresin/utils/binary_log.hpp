@@ -0,0 +1,116 @@
+#ifndef RESIN_BINARY_LOG_HPP
+#define RESIN_BINARY_LOG_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <libresin/utils/logger.hpp>
+#include <libresin/utils/mapped_file.hpp>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+
+namespace resin {
+
+/*
+  Binary log format. The file starts with `kBinaryLogMagic` and `kBinaryLogVersion` followed by entries, each one
+  prefixed with its `BinaryLogEntry` kind:
+    - Callsite: u32 id, u8 level, u8 debug flag, u32 line, u32 column and the format string, file path and function
+      name (u32 length + characters each). Written the first time a location logs into the file.
+    - Message: i64 timestamp (nanoseconds since the epoch), u32 callsite id, u32 size and the arguments encoded with
+      `encode_log_args`.
+    - TimestampMode: u8 `LogTimestampMode` of the following messages. Written before the first message and whenever
+      the mode changes.
+  All values use the native byte order. A zero byte in place of an entry kind marks the end of the log.
+*/
+static constexpr std::array<char, 8> kBinaryLogMagic = {'R', 'E', 'S', 'I', 'N', 'L', 'O', 'G'};
+static constexpr uint32_t kBinaryLogVersion          = 2;
+
+enum class BinaryLogEntry : uint8_t {
+  End           = 0,
+  Callsite      = 1,
+  Message       = 2,
+  TimestampMode = 3,
+};
+
+/*
+  Writes `LogRecord`s in the binary log format into a memory mapped file.
+*/
+class BinaryLogWriter {
+ public:
+  // Throws `std::runtime_error` if the file cannot be created.
+  explicit BinaryLogWriter(const std::filesystem::path& path);
+
+  void write(const LogRecord& record);
+  void flush() { file_.flush(); }
+
+  size_t size() const { return file_.size(); }
+
+ private:
+  // Format strings and file paths of the logger point to static strings, so their addresses identify a callsite
+  struct CallsiteKey {
+    const char* fmt;
+    const char* file_path;
+    uint32_t line;
+    uint32_t column;
+
+    bool operator==(const CallsiteKey& other) const = default;
+  };
+
+  struct CallsiteKeyHash {
+    size_t operator()(const CallsiteKey& key) const;
+  };
+
+  uint32_t intern_callsite(const LogRecord& record, std::string_view fmt);
+
+ private:
+  MappedFile file_;
+  std::unordered_map<CallsiteKey, uint32_t, CallsiteKeyHash> callsites_;
+  std::optional<LogTimestampMode> timestamp_mode_;
+};
+
+struct BinaryLogCallsite {
+  LogLocation location;
+  std::string_view fmt;
+  LogLevel level;
+  bool is_debug_msg;
+};
+
+struct BinaryLogMessage {
+  std::chrono::time_point<std::chrono::system_clock> time_point;
+  LogTimestampMode timestamp_mode;
+  const BinaryLogCallsite* callsite;
+  std::span<const std::byte> args;
+};
+
+/*
+  Decodes a binary log. The returned strings and arguments point into the provided data.
+*/
+class BinaryLogReader {
+ public:
+  // Throws `std::runtime_error` if the data does not start with a valid header.
+  explicit BinaryLogReader(std::span<const std::byte> data);
+
+  // Returns the next message or `std::nullopt` at the end of the log. Throws `std::runtime_error` if the log is
+  // corrupted.
+  std::optional<BinaryLogMessage> next();
+
+ private:
+  template <typename T>
+  T read();
+  std::string_view read_string();
+
+ private:
+  std::span<const std::byte> data_;
+  size_t offset_                   = 0;
+  LogTimestampMode timestamp_mode_ = LogTimestampMode::WallClock;
+  // Deque, so that pointers to callsites stay valid
+  std::deque<BinaryLogCallsite> callsites_;
+};
+
+}  // namespace resin
+#endif  // RESIN_BINARY_LOG_HPP
@@ -0,0 +1,120 @@
+#ifndef RESIN_BOUNDED_QUEUE_HPP
+#define RESIN_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace resin {
+
+/*
+  Bounded, lock-free multi-producer multi-consumer FIFO queue (Dmitry Vyukov's algorithm). Every cell carries a
+  sequence number which tells whether it is ready to be written or read, so producers and consumers only contend on
+  the head and tail counters. The capacity is rounded up to a power of two and nothing is allocated after construction.
+*/
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity) : capacity_(std::bit_ceil(capacity)), mask_(capacity_ - 1) {
+    if (capacity == 0) {
+      throw std::invalid_argument("BoundedQueue: capacity must be greater than 0");
+    }
+
+    cells_ = std::make_unique<Cell[]>(capacity_);
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&)            = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  bool try_push(const T& value) {
+    return try_push_with([&value](T& cell) { cell = value; });
+  }
+
+  // Claims a cell and lets `init` write the value in place. `init` must not throw.
+  template <typename Init>
+  bool try_push_with(Init&& init) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell                      = &cells_[pos & mask_];
+      const size_t seq          = cell->sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    std::forward<Init>(init)(cell->value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& out) {
+    return try_pop_with([&out](T& cell) { out = std::move(cell); });
+  }
+
+  // Claims the oldest cell and lets `consume` read the value in place. `consume` must not throw.
+  template <typename Consume>
+  bool try_pop_with(Consume&& consume) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell                      = &cells_[pos & mask_];
+      const size_t seq          = cell->sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // empty
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    std::forward<Consume>(consume)(cell->value);
+    cell->sequence.store(pos + capacity_, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // Only a hint when other threads are pushing or popping at the same time.
+  size_t size_approx() const {
+    const size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+    const size_t dequeued = dequeue_pos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+  bool empty_approx() const { return size_approx() == 0; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_ = 0;
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_ = 0;
+};
+
+}  // namespace resin
+#endif  // RESIN_BOUNDED_QUEUE_HPP
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <libresin/utils/gzip.hpp>
+#include <stdexcept>
+
+namespace resin {
+
+namespace {
+
+constexpr std::array<uint32_t, 256> make_crc32_table() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1U) != 0 ? 0xEDB88320U ^ (crc >> 1U) : crc >> 1U;
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrc32Table = make_crc32_table();
+
+constexpr size_t kWindowSize    = 32768;
+constexpr size_t kMinMatch      = 3;
+constexpr size_t kMaxMatch      = 258;
+constexpr size_t kMaxChainSteps = 64;
+constexpr size_t kHashBits      = 15;
+constexpr uint32_t kNoPosition  = 0xFFFFFFFFU;
+
+constexpr std::array<uint16_t, 29> kLengthBase = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<uint8_t, 29> kLengthExtraBits = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<uint16_t, 30> kDistanceBase = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<uint8_t, 30> kDistanceExtraBits = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Deflate streams are packed starting from the least significant bit, Huffman codes from their most significant bit
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<std::byte>& out) : out_(&out) {}
+
+  void write_bits(uint32_t value, uint32_t count) {
+    buffer_ |= static_cast<uint64_t>(value) << buffered_;
+    buffered_ += count;
+    while (buffered_ >= 8) {
+      out_->push_back(static_cast<std::byte>(buffer_ & 0xFFU));
+      buffer_ >>= 8U;
+      buffered_ -= 8;
+    }
+  }
+
+  void write_code(uint32_t code, uint32_t length) {
+    uint32_t reversed = 0;
+    for (uint32_t i = 0; i < length; ++i) {
+      reversed |= ((code >> i) & 1U) << (length - 1 - i);
+    }
+    write_bits(reversed, length);
+  }
+
+  void finish() {
+    if (buffered_ > 0) {
+      out_->push_back(static_cast<std::byte>(buffer_ & 0xFFU));
+    }
+    buffer_   = 0;
+    buffered_ = 0;
+  }
+
+ private:
+  std::vector<std::byte>* out_;
+  uint64_t buffer_   = 0;
+  uint32_t buffered_ = 0;
+};
+
+// Fixed literal/length code, RFC 1951 section 3.2.6
+void write_literal_length(BitWriter& writer, uint32_t symbol) {
+  if (symbol < 144) {
+    writer.write_code(0x30 + symbol, 8);
+  } else if (symbol < 256) {
+    writer.write_code(0x190 + symbol - 144, 9);
+  } else if (symbol < 280) {
+    writer.write_code(symbol - 256, 7);
+  } else {
+    writer.write_code(0xC0 + symbol - 280, 8);
+  }
+}
+
+void write_match(BitWriter& writer, size_t length, size_t distance) {
+  const auto length_code = static_cast<size_t>(std::ranges::upper_bound(kLengthBase, length) - kLengthBase.begin() - 1);
+  write_literal_length(writer, static_cast<uint32_t>(257 + length_code));
+  writer.write_bits(static_cast<uint32_t>(length - kLengthBase[length_code]), kLengthExtraBits[length_code]);
+
+  const auto distance_code =
+      static_cast<size_t>(std::ranges::upper_bound(kDistanceBase, distance) - kDistanceBase.begin() - 1);
+  writer.write_code(static_cast<uint32_t>(distance_code), 5);
+  writer.write_bits(static_cast<uint32_t>(distance - kDistanceBase[distance_code]), kDistanceExtraBits[distance_code]);
+}
+
+uint32_t hash3(std::span<const std::byte> data, size_t pos) {
+  const uint32_t value = static_cast<uint32_t>(data[pos]) | (static_cast<uint32_t>(data[pos + 1]) << 8U) |
+                         (static_cast<uint32_t>(data[pos + 2]) << 16U);
+  return (value * 2654435761U) >> (32U - kHashBits);
+}
+
+void deflate_fixed(std::span<const std::byte> data, std::vector<std::byte>& out) {
+  BitWriter writer(out);
+  writer.write_bits(1, 1);  // last block
+  writer.write_bits(1, 2);  // fixed Huffman codes
+
+  // Hash chains over the positions in the window
+  std::vector<uint32_t> head(size_t{1} << kHashBits, kNoPosition);
+  std::vector<uint32_t> prev(kWindowSize, kNoPosition);
+  const auto insert = [&](size_t pos) {
+    if (pos + kMinMatch <= data.size()) {
+      const uint32_t hash           = hash3(data, pos);
+      prev[pos & (kWindowSize - 1)] = head[hash];
+      head[hash]                    = static_cast<uint32_t>(pos);
+    }
+  };
+
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t best_length   = 0;
+    size_t best_distance = 0;
+
+    if (pos + kMinMatch <= data.size()) {
+      const size_t max_length = std::min(kMaxMatch, data.size() - pos);
+      uint32_t candidate      = head[hash3(data, pos)];
+      for (size_t step = 0; step < kMaxChainSteps && candidate != kNoPosition; ++step) {
+        const size_t distance = pos - candidate;
+        if (distance > kWindowSize) {
+          break;
+        }
+
+        size_t length = 0;
+        while (length < max_length && data[candidate + length] == data[pos + length]) {
+          ++length;
+        }
+        if (length > best_length) {
+          best_length   = length;
+          best_distance = distance;
+          if (length == max_length) {
+            break;
+          }
+        }
+
+        const uint32_t next = prev[candidate & (kWindowSize - 1)];
+        // The slot may have been reused by a newer position
+        if (next != kNoPosition && next >= candidate) {
+          break;
+        }
+        candidate = next;
+      }
+    }
+
+    if (best_length >= kMinMatch) {
+      write_match(writer, best_length, best_distance);
+      for (size_t i = 0; i < best_length; ++i) {
+        insert(pos + i);
+      }
+      pos += best_length;
+    } else {
+      write_literal_length(writer, static_cast<uint32_t>(data[pos]));
+      insert(pos);
+      ++pos;
+    }
+  }
+
+  write_literal_length(writer, 256);  // end of block
+  writer.finish();
+}
+
+void append_u32_le(std::vector<std::byte>& out, uint32_t value) {
+  for (uint32_t shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<std::byte>((value >> shift) & 0xFFU));
+  }
+}
+
+}  // namespace
+
+uint32_t crc32(std::span<const std::byte> data, uint32_t crc) {
+  crc = ~crc;
+  for (const std::byte byte : data) {
+    crc = kCrc32Table[(crc ^ static_cast<uint32_t>(byte)) & 0xFFU] ^ (crc >> 8U);
+  }
+  return ~crc;
+}
+
+std::vector<std::byte> gzip_compress(std::span<const std::byte> data) {
+  // Magic, deflate, no flags, no modification time, no extra flags, unknown OS
+  static constexpr std::array<uint8_t, 10> kHeader = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+
+  std::vector<std::byte> out;
+  out.reserve(data.size() / 2 + kHeader.size() + 8);
+  std::ranges::transform(kHeader, std::back_inserter(out), [](uint8_t byte) { return static_cast<std::byte>(byte); });
+
+  deflate_fixed(data, out);
+
+  append_u32_le(out, crc32(data));
+  append_u32_le(out, static_cast<uint32_t>(data.size()));
+  return out;
+}
+
+void gzip_file(const std::filesystem::path& source, const std::filesystem::path& destination) {
+  std::ifstream input(source, std::ios::binary);
+  if (!input.is_open()) {
+    throw std::runtime_error("gzip_file: could not open the file \"" + source.string() + "\"");
+  }
+
+  std::vector<std::byte> data(std::filesystem::file_size(source));
+  input.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!input) {
+    throw std::runtime_error("gzip_file: could not read the file \"" + source.string() + "\"");
+  }
+
+  const std::vector<std::byte> compressed = gzip_compress(data);
+
+  std::ofstream output(destination, std::ios::binary | std::ios::trunc);
+  output.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+  if (!output) {
+    throw std::runtime_error("gzip_file: could not write the file \"" + destination.string() + "\"");
+  }
+}
+
+}  // namespace resin
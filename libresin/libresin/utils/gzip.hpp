@@ -0,0 +1,25 @@
+#ifndef RESIN_GZIP_HPP
+#define RESIN_GZIP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+// CRC-32 (ISO-HDLC) as used by gzip. Pass the previous result as `crc` to continue a checksum.
+uint32_t crc32(std::span<const std::byte> data, uint32_t crc = 0);
+
+/*
+  Compresses the data into the gzip format with a single deflate block that uses the fixed Huffman codes. The ratio is
+  below the one of zlib, but the compressor has no dependencies and text logs still shrink several times.
+*/
+std::vector<std::byte> gzip_compress(std::span<const std::byte> data);
+
+// Compresses the file at `source` into `destination`. Throws `std::runtime_error` if a file cannot be read or written.
+void gzip_file(const std::filesystem::path& source, const std::filesystem::path& destination);
+
+}  // namespace resin
+#endif  // RESIN_GZIP_HPP
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <libresin/utils/job_system.hpp>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+// Which system and which of its deques the current thread owns
+thread_local const JobSystem* tls_job_system = nullptr;
+thread_local size_t tls_thread_index         = 0;
+
+// Spins before a worker goes to sleep, since new jobs often follow shortly
+constexpr int kIdleSpins = 64;
+
+}  // namespace
+
+size_t JobSystem::default_worker_count() { return std::max(std::thread::hardware_concurrency(), 2U) - 1; }
+
+JobSystem::JobSystem(size_t worker_count) : injected_(kInjectionQueueCapacity) {
+  deques_.reserve(worker_count + 1);
+  for (size_t i = 0; i <= worker_count; ++i) {
+    deques_.push_back(std::make_unique<WorkStealingDeque<Job*>>(kDequeCapacity));
+  }
+
+  tls_job_system   = this;
+  tls_thread_index = 0;
+
+  workers_.reserve(worker_count);
+  for (size_t i = 1; i <= worker_count; ++i) {
+    workers_.emplace_back([this, i] { run_worker(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  stopping_.store(true, std::memory_order_seq_cst);
+  work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  work_epoch_.notify_all();
+  workers_.clear();
+
+  if (tls_job_system == this) {
+    tls_job_system = nullptr;
+  }
+}
+
+size_t JobSystem::current_thread() const { return tls_job_system == this ? tls_thread_index : kNoThread; }
+
+void JobSystem::schedule(Job& job, JobGroup& group) {
+  job.group = &group;
+  group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+  const size_t thread = current_thread();
+  const bool queued   = thread != kNoThread ? deques_[thread]->push(&job) : injected_.try_push(&job);
+  if (!queued) {
+    execute(job);
+    return;
+  }
+
+  wake_worker();
+}
+
+void JobSystem::wait(JobGroup& group) {
+  const size_t thread = current_thread();
+  while (!group.done()) {
+    if (Job* job = find_job(thread)) {
+      execute(*job);
+    } else {
+      // The remaining jobs of the group are running on other threads
+      std::this_thread::yield();
+    }
+  }
+
+  if (group.failed_.exchange(false, std::memory_order_relaxed)) {
+    std::rethrow_exception(std::exchange(group.exception_, nullptr));
+  }
+}
+
+Job* JobSystem::find_job(size_t thread) {
+  if (thread != kNoThread) {
+    if (const auto job = deques_[thread]->pop()) {
+      return *job;
+    }
+  }
+
+  Job* job = nullptr;
+  if (injected_.try_pop(job)) {
+    return job;
+  }
+
+  // Victims are visited starting after the current thread, so that the thieves spread over the deques
+  const size_t count = deques_.size();
+  const size_t first = thread != kNoThread ? thread + 1 : 0;
+  for (size_t i = 0; i < count; ++i) {
+    const size_t victim = (first + i) % count;
+    if (victim == thread) {
+      continue;
+    }
+    if (const auto stolen = deques_[victim]->steal()) {
+      return *stolen;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Job& job) {
+  // The job may be destroyed as soon as the group is done, so nothing is read from it afterwards
+  JobGroup& group = *job.group;
+  try {
+    job.function();
+  } catch (...) {
+    if (!group.failed_.exchange(true, std::memory_order_relaxed)) {
+      group.exception_ = std::current_exception();
+    }
+  }
+  group.pending_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::run_worker(size_t thread) {
+  tls_job_system   = this;
+  tls_thread_index = thread;
+
+  int idle_spins = 0;
+  while (!stopping_.load(std::memory_order_relaxed)) {
+    if (Job* job = find_job(thread)) {
+      execute(*job);
+      idle_spins = 0;
+      continue;
+    }
+
+    if (++idle_spins < kIdleSpins) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // The epoch is read before the last look for jobs, so a job scheduled after it changes the epoch and the wait
+    // returns immediately instead of missing the wake-up
+    const uint32_t epoch = work_epoch_.load(std::memory_order_seq_cst);
+    if (Job* job = find_job(thread)) {
+      execute(*job);
+      idle_spins = 0;
+      continue;
+    }
+
+    sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    if (!stopping_.load(std::memory_order_seq_cst)) {
+      work_epoch_.wait(epoch, std::memory_order_seq_cst);
+    }
+    sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+    idle_spins = 0;
+  }
+}
+
+void JobSystem::wake_worker() {
+  work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+    work_epoch_.notify_one();
+  }
+}
+
+TaskGraph::TaskId TaskGraph::add(JobFunction function) {
+  tasks_.emplace_back(function);
+  return tasks_.size() - 1;
+}
+
+void TaskGraph::precede(TaskId before, TaskId after) {
+  if (before >= tasks_.size() || after >= tasks_.size()) {
+    throw std::out_of_range("TaskGraph: unknown task");
+  }
+
+  tasks_[before].successors.push_back(after);
+  ++tasks_[after].predecessors;
+}
+
+void TaskGraph::check_acyclic() const {
+  // Kahn's algorithm, every task is visited only if the graph has no cycle
+  std::vector<uint32_t> remaining(tasks_.size());
+  std::vector<TaskId> ready;
+  for (TaskId id = 0; id < tasks_.size(); ++id) {
+    remaining[id] = tasks_[id].predecessors;
+    if (remaining[id] == 0) {
+      ready.push_back(id);
+    }
+  }
+
+  size_t visited = 0;
+  while (!ready.empty()) {
+    const TaskId id = ready.back();
+    ready.pop_back();
+    ++visited;
+    for (const TaskId successor : tasks_[id].successors) {
+      if (--remaining[successor] == 0) {
+        ready.push_back(successor);
+      }
+    }
+  }
+
+  if (visited != tasks_.size()) {
+    throw std::invalid_argument("TaskGraph: the task dependencies form a cycle");
+  }
+}
+
+void TaskGraph::run(JobSystem& system) {
+  check_acyclic();
+
+  JobGroup group;
+  for (TaskId id = 0; id < tasks_.size(); ++id) {
+    Task& task = tasks_[id];
+    task.remaining_predecessors.store(task.predecessors, std::memory_order_relaxed);
+    task.job.function = [this, &system, &group, id] { run_task(system, group, id); };
+  }
+
+  for (Task& task : tasks_) {
+    if (task.predecessors == 0) {
+      system.schedule(task.job, group);
+    }
+  }
+  system.wait(group);
+}
+
+void TaskGraph::run_task(JobSystem& system, JobGroup& group, TaskId id) {
+  Task& task = tasks_[id];
+  task.function();
+
+  // The successors are scheduled before this job finishes, so the group cannot be done in the meantime
+  for (const TaskId successor_id : task.successors) {
+    Task& successor = tasks_[successor_id];
+    if (successor.remaining_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      system.schedule(successor.job, group);
+    }
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,247 @@
+#ifndef RESIN_JOB_SYSTEM_HPP
+#define RESIN_JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <libresin/utils/bounded_queue.hpp>
+#include <libresin/utils/work_stealing_deque.hpp>
+#include <memory>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace resin {
+
+/*
+  Job callable stored in place, without any allocation. The callable has to be small and trivially copyable, which
+  lambdas capturing references or a few values are.
+*/
+class JobFunction {
+ public:
+  static constexpr size_t kStorageSize = 4 * sizeof(void*);
+
+  JobFunction() = default;
+
+  template <typename F>
+    requires(!std::same_as<std::remove_cvref_t<F>, JobFunction> && std::invocable<F&>)
+  JobFunction(const F& fn) {  // NOLINT(google-explicit-constructor)
+    static_assert(sizeof(F) <= kStorageSize && alignof(F) <= alignof(void*),
+                  "Job is too big, capture references instead of objects");
+    static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>,
+                  "Job must be trivially copyable, capture references instead of objects");
+
+    ::new (storage_.data()) F(fn);
+    invoke_ = [](std::byte* storage) { (*std::launder(reinterpret_cast<F*>(storage)))(); };
+  }
+
+  void operator()() { invoke_(storage_.data()); }
+  explicit operator bool() const { return invoke_ != nullptr; }
+
+ private:
+  alignas(void*) std::array<std::byte, kStorageSize> storage_{};
+  void (*invoke_)(std::byte*) = nullptr;
+};
+
+// Counts the unfinished jobs scheduled with it, so that they can be waited for together (see `JobSystem::wait`).
+class JobGroup {
+ public:
+  JobGroup() = default;
+
+  JobGroup(const JobGroup&)            = delete;
+  JobGroup(JobGroup&&)                 = delete;
+  JobGroup& operator=(const JobGroup&) = delete;
+  JobGroup& operator=(JobGroup&&)      = delete;
+
+  bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+ private:
+  friend class JobSystem;
+
+  std::atomic<size_t> pending_ = 0;
+  std::atomic<bool> failed_    = false;
+  // The first exception thrown by the jobs, published by the decrement of `pending_`
+  std::exception_ptr exception_;
+};
+
+// Unit of work. It is owned by the caller and has to outlive its execution, which `JobSystem::wait` guarantees.
+struct Job {
+  JobFunction function;
+  JobGroup* group = nullptr;
+};
+
+/*
+  Work-stealing scheduler of jobs over a pool of worker threads.
+
+  Every worker, and the thread that created the system, has its own deque (see `WorkStealingDeque`). Jobs scheduled
+  by them go to their own deque and are run in LIFO order, an idle thread steals the oldest jobs of the others. Jobs
+  scheduled by any other thread go through a shared lock-free queue. Workers without work sleep on an atomic and are
+  woken only when a job is scheduled while some of them sleep.
+
+  Waiting for a group of jobs does not block, the waiting thread runs the jobs itself until the group is done, so the
+  main thread takes part in the work and jobs may wait for nested jobs without a deadlock.
+
+  Jobs must be waited for before the system is destroyed, the jobs left in the queues are never run.
+*/
+class JobSystem {
+ public:
+  static constexpr size_t kDequeCapacity          = 4096;
+  static constexpr size_t kInjectionQueueCapacity = 4096;
+
+  // One worker less than hardware threads, since the thread that waits for the jobs runs them as well.
+  static size_t default_worker_count();
+
+  explicit JobSystem(size_t worker_count = default_worker_count());
+  ~JobSystem();
+
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem(JobSystem&&)                 = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  JobSystem& operator=(JobSystem&&)      = delete;
+
+  // Number of the threads that run jobs, including the thread that created the system.
+  size_t thread_count() const { return deques_.size(); }
+
+  // Thread-safe. Jobs that do not fit into the queues are run immediately on the calling thread.
+  void schedule(Job& job, JobGroup& group);
+
+  // Runs jobs until every job of the group is finished. Rethrows the first exception thrown by the jobs of the group.
+  void wait(JobGroup& group);
+
+  // Calls `fn(begin, end)` over the chunks of `[0, count)` of at most `grain` indices in parallel and waits for them.
+  // The chunks are claimed from a shared counter by at most `kMaxParallelJobs` jobs kept on the stack, so the call
+  // does not allocate.
+  template <typename F>
+    requires std::invocable<const F&, size_t, size_t>
+  void parallel_for(size_t count, size_t grain, const F& fn) {
+    grain              = std::max<size_t>(grain, 1);
+    const size_t parts = (count + grain - 1) / grain;
+    if (parts <= 1 || thread_count() == 1) {
+      if (count > 0) {
+        fn(size_t{0}, count);
+      }
+      return;
+    }
+
+    Chunks<F> chunks{.fn = &fn, .count = count, .grain = grain, .parts = parts};
+    JobGroup group;
+    std::array<Job, kMaxParallelJobs> jobs;
+    const size_t job_count = std::min({parts - 1, thread_count() - 1, kMaxParallelJobs});
+    for (size_t i = 0; i < job_count; ++i) {
+      jobs[i].function = [&chunks] { chunks.run(); };
+      schedule(jobs[i], group);
+    }
+
+    // The calling thread claims chunks too, the scheduled jobs reference this frame, so they have to finish in any case
+    std::exception_ptr exception;
+    try {
+      chunks.run();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    wait(group);
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  // Calls `fn(chunk)` over the chunks of `items` of at most `grain` elements in parallel and waits for them.
+  template <typename T, typename F>
+    requires std::invocable<const F&, std::span<T>>
+  void parallel_for(std::span<T> items, size_t grain, const F& fn) {
+    parallel_for(items.size(), grain,
+                 [items, &fn](size_t begin, size_t end) { fn(items.subspan(begin, end - begin)); });
+  }
+
+ private:
+  static constexpr size_t kNoThread        = static_cast<size_t>(-1);
+  // Jobs scheduled by a single `parallel_for` besides the calling thread
+  static constexpr size_t kMaxParallelJobs = 63;
+
+  template <typename F>
+  struct Chunks {
+    const F* fn;
+    size_t count;
+    size_t grain;
+    size_t parts;
+    std::atomic<size_t> next = 0;
+
+    void run() {
+      size_t part = 0;
+      while ((part = next.fetch_add(1, std::memory_order_relaxed)) < parts) {
+        const size_t begin = part * grain;
+        (*fn)(begin, std::min(begin + grain, count));
+      }
+    }
+  };
+
+  size_t current_thread() const;
+  Job* find_job(size_t thread);
+  static void execute(Job& job);
+  void run_worker(size_t thread);
+  void wake_worker();
+
+ private:
+  std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> deques_;
+  BoundedQueue<Job*> injected_;
+
+  std::atomic<uint32_t> work_epoch_ = 0;
+  std::atomic<uint32_t> sleeping_   = 0;
+  std::atomic<bool> stopping_       = false;
+
+  std::vector<std::jthread> workers_;
+};
+
+/*
+  Graph of tasks with dependencies, run on a `JobSystem`. A task is scheduled as soon as all the tasks that precede it
+  are finished. The graph may be run many times.
+*/
+class TaskGraph {
+ public:
+  using TaskId = size_t;
+
+  TaskGraph() = default;
+
+  TaskGraph(const TaskGraph&)            = delete;
+  TaskGraph(TaskGraph&&)                 = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+  TaskGraph& operator=(TaskGraph&&)      = delete;
+
+  TaskId add(JobFunction function);
+  // Makes `after` run only once `before` is finished. Throws `std::out_of_range` for unknown tasks.
+  void precede(TaskId before, TaskId after);
+
+  // Runs every task and waits for them. Throws `std::invalid_argument` if the dependencies form a cycle, and rethrows
+  // the first exception thrown by a task, in which case the tasks that depend on it are not run.
+  void run(JobSystem& system);
+
+  size_t size() const { return tasks_.size(); }
+
+ private:
+  struct Task {
+    explicit Task(JobFunction fn) : function(fn) {}
+
+    JobFunction function;
+    std::vector<TaskId> successors;
+    uint32_t predecessors                        = 0;
+    std::atomic<uint32_t> remaining_predecessors = 0;
+    Job job;
+  };
+
+  void check_acyclic() const;
+  void run_task(JobSystem& system, JobGroup& group, TaskId id);
+
+ private:
+  // Deque, so that the tasks do not move when new ones are added
+  std::deque<Task> tasks_;
+};
+
+}  // namespace resin
+#endif  // RESIN_JOB_SYSTEM_HPP
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <iterator>
+#include <libresin/utils/log_args.hpp>
+#include <tuple>
+
+namespace resin {
+
+void LogArgsWriter::write_string(std::string_view str) {
+  if (buffer_.size() - size_ < kStrHeaderSize) {
+    size_ = buffer_.size();
+    return;
+  }
+
+  const size_t length = std::min(str.size(), buffer_.size() - size_ - kStrHeaderSize);
+  std::memcpy(&buffer_[size_ + kStrHeaderSize], str.data(), length);
+  write_string_header(static_cast<uint32_t>(length));
+}
+
+void LogArgsWriter::write_string_header(uint32_t length) {
+  buffer_[size_] = static_cast<std::byte>(LogArgType::Str);
+  std::memcpy(&buffer_[size_ + sizeof(LogArgType)], &length, sizeof(length));
+  size_ += kStrHeaderSize + length;
+}
+
+namespace {
+
+template <typename T>
+bool read_scalar(std::span<const std::byte> buffer, size_t& offset, LogArgValue& out) {
+  if (buffer.size() - offset < sizeof(T)) {
+    return false;
+  }
+
+  T value;
+  std::memcpy(&value, &buffer[offset], sizeof(T));
+  offset += sizeof(T);
+  out.value = value;
+  return true;
+}
+
+bool read_string(std::span<const std::byte> buffer, size_t& offset, LogArgValue& out) {
+  uint32_t length = 0;
+  if (buffer.size() - offset < sizeof(length)) {
+    return false;
+  }
+
+  std::memcpy(&length, &buffer[offset], sizeof(length));
+  offset += sizeof(length);
+  if (buffer.size() - offset < length) {
+    return false;
+  }
+
+  out.value = std::string_view(reinterpret_cast<const char*>(&buffer[offset]), length);
+  offset += length;
+  return true;
+}
+
+}  // namespace
+
+size_t decode_log_args(std::span<const std::byte> buffer, std::span<LogArgValue, kMaxLogArgs> out) {
+  size_t offset = 0;
+  size_t count  = 0;
+  while (offset < buffer.size() && count < out.size()) {
+    const auto type = static_cast<LogArgType>(buffer[offset++]);
+    LogArgValue& arg = out[count];
+
+    bool valid = false;
+    switch (type) {
+      case LogArgType::Bool:
+        valid = read_scalar<bool>(buffer, offset, arg);
+        break;
+      case LogArgType::Char:
+        valid = read_scalar<char>(buffer, offset, arg);
+        break;
+      case LogArgType::I64:
+        valid = read_scalar<int64_t>(buffer, offset, arg);
+        break;
+      case LogArgType::U64:
+        valid = read_scalar<uint64_t>(buffer, offset, arg);
+        break;
+      case LogArgType::F32:
+        valid = read_scalar<float>(buffer, offset, arg);
+        break;
+      case LogArgType::F64:
+        valid = read_scalar<double>(buffer, offset, arg);
+        break;
+      case LogArgType::Str:
+        valid = read_string(buffer, offset, arg);
+        break;
+      case LogArgType::Ptr:
+        valid = read_scalar<const void*>(buffer, offset, arg);
+        break;
+    }
+
+    if (!valid) {
+      break;
+    }
+    ++count;
+  }
+
+  return count;
+}
+
+void format_log_message(std::string& out, std::string_view fmt, std::span<const std::byte> args) {
+  std::array<LogArgValue, kMaxLogArgs> values{};
+  decode_log_args(args, values);
+
+  try {
+    std::apply([&](auto&... value) { std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(value...)); },
+               values);
+  } catch (const std::exception& e) {
+    out.append(" <");
+    out.append(e.what());
+    out.append(">");
+  }
+}
+
+bool has_dynamic_specs(std::string_view fmt) {
+  bool in_field = false;
+  for (size_t i = 0; i < fmt.size(); ++i) {
+    if (fmt[i] == '{') {
+      if (in_field) {
+        return true;
+      }
+      // "{{" is an escaped brace
+      if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+        ++i;
+        continue;
+      }
+      in_field = true;
+    } else if (fmt[i] == '}') {
+      in_field = false;
+    }
+  }
+  return false;
+}
+
+}  // namespace resin
@@ -0,0 +1,273 @@
+#ifndef RESIN_LOG_ARGS_HPP
+#define RESIN_LOG_ARGS_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+namespace resin {
+
+static constexpr size_t kMaxLogArgs     = 16;
+static constexpr size_t kMaxLogArgsSize = 448;
+
+// Tags of the binary log arguments encoding. Every argument is stored as a tag followed by the value, strings as a
+// tag followed by a 32 bit length and the characters.
+enum class LogArgType : uint8_t {
+  Bool = 0,
+  Char = 1,
+  I64  = 2,
+  U64  = 3,
+  F32  = 4,
+  F64  = 5,
+  Str  = 6,
+  Ptr  = 7,
+};
+
+/*
+  Decoded log argument. Formats exactly as the original value, the format spec of the replacement field is forwarded
+  to the formatter of the stored type.
+*/
+struct LogArgValue {
+  std::variant<std::string_view, bool, char, int64_t, uint64_t, float, double, const void*> value;
+};
+
+// Types the encoding stores as they are, so that they format exactly as the original values
+template <typename T>
+concept LogArgStored = std::integral<T> || std::same_as<T, float> || std::same_as<T, double> ||
+                       std::convertible_to<const T&, std::string_view> || std::same_as<T, void*> ||
+                       std::same_as<T, const void*> || std::same_as<T, std::nullptr_t>;
+
+/*
+  Serializes log arguments into a caller provided buffer. Arithmetic types, strings and pointers are copied as they
+  are, values of other types are formatted with their `std::formatter` and the default spec right away and stored as
+  strings, so the spec of their replacement field applies to the string instead (see `LogArgsRef::exact`). When the
+  buffer runs out of space strings are truncated and the remaining arguments are skipped.
+*/
+class LogArgsWriter {
+ public:
+  explicit LogArgsWriter(std::span<std::byte> buffer) : buffer_(buffer) {}
+
+  template <typename T>
+  void write(const T& value) {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (std::same_as<U, bool>) {
+      write_scalar(LogArgType::Bool, value);
+    } else if constexpr (std::same_as<U, char>) {
+      write_scalar(LogArgType::Char, value);
+    } else if constexpr (std::signed_integral<U>) {
+      write_scalar(LogArgType::I64, static_cast<int64_t>(value));
+    } else if constexpr (std::unsigned_integral<U>) {
+      write_scalar(LogArgType::U64, static_cast<uint64_t>(value));
+    } else if constexpr (std::same_as<U, float>) {
+      write_scalar(LogArgType::F32, value);
+    } else if constexpr (std::same_as<U, double>) {
+      write_scalar(LogArgType::F64, value);
+    } else if constexpr (std::convertible_to<const U&, std::string_view>) {
+      write_string(std::string_view(value));
+    } else if constexpr (std::same_as<U, void*> || std::same_as<U, const void*> || std::same_as<U, std::nullptr_t>) {
+      write_scalar(LogArgType::Ptr, static_cast<const void*>(value));
+    } else {
+      write_formatted("{}", value);
+    }
+  }
+
+  // Writes the whole message formatted from the original arguments as a single string.
+  template <typename... Args>
+  void write_message(std::string_view fmt, const Args&... args) {
+    write_formatted(fmt, args...);
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr size_t kStrHeaderSize = sizeof(LogArgType) + sizeof(uint32_t);
+
+  // Output iterator that discards everything past the end of the buffer. Copies share the position, because
+  // `std::vformat_to` is free to copy the iterator.
+  class TruncatingIterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+
+    struct State {
+      std::byte* cur;
+      std::byte* end;
+    };
+
+    explicit TruncatingIterator(State& state) : state_(&state) {}
+
+    TruncatingIterator& operator*() { return *this; }
+    TruncatingIterator& operator++() { return *this; }
+    TruncatingIterator operator++(int) { return *this; }
+    TruncatingIterator& operator=(char c) {
+      if (state_->cur != state_->end) {
+        *state_->cur++ = static_cast<std::byte>(c);
+      }
+      return *this;
+    }
+
+   private:
+    State* state_;
+  };
+
+  template <typename T>
+  void write_scalar(LogArgType type, const T& value) {
+    if (buffer_.size() - size_ < sizeof(LogArgType) + sizeof(T)) {
+      size_ = buffer_.size();
+      return;
+    }
+
+    buffer_[size_] = static_cast<std::byte>(type);
+    std::memcpy(&buffer_[size_ + sizeof(LogArgType)], &value, sizeof(T));
+    size_ += sizeof(LogArgType) + sizeof(T);
+  }
+
+  void write_string(std::string_view str);
+
+  template <typename... Args>
+  void write_formatted(std::string_view fmt, const Args&... args) {
+    if (buffer_.size() - size_ < kStrHeaderSize) {
+      size_ = buffer_.size();
+      return;
+    }
+
+    std::byte* const data = &buffer_[size_ + kStrHeaderSize];
+    TruncatingIterator::State state{.cur = data, .end = buffer_.data() + buffer_.size()};
+    try {
+      std::vformat_to(TruncatingIterator(state), fmt, std::make_format_args(args...));
+    } catch (...) {  // NOLINT(bugprone-empty-catch): keep whatever has been formatted, logging must not throw
+    }
+    write_string_header(static_cast<uint32_t>(state.cur - data));
+  }
+
+  void write_string_header(uint32_t length);
+
+ private:
+  std::span<std::byte> buffer_;
+  size_t size_ = 0;
+};
+
+template <typename... Args>
+size_t encode_log_args(std::span<std::byte> buffer, const Args&... args) {
+  static_assert(sizeof...(Args) <= kMaxLogArgs, "Too many arguments for a single log message");
+
+  LogArgsWriter writer(buffer);
+  (writer.write(args), ...);
+  return writer.size();
+}
+
+// Decodes the arguments written by `encode_log_args`. Strings point into the buffer. Returns the number of arguments.
+size_t decode_log_args(std::span<const std::byte> buffer, std::span<LogArgValue, kMaxLogArgs> out);
+
+// Formats a message from the format string and the encoded arguments. Missing arguments are formatted as empty
+// strings and format errors are appended to the output instead of being thrown.
+void format_log_message(std::string& out, std::string_view fmt, std::span<const std::byte> args);
+
+// Whether a replacement field of the format string takes its width or precision from another argument (e.g. "{:{}}"),
+// which the encoded arguments cannot be formatted with.
+bool has_dynamic_specs(std::string_view fmt);
+
+/*
+  Type-erased reference to the arguments of a log call, that lets non-template code encode them directly into their
+  destination, or format the message from them when the encoding would lose something.
+*/
+class LogArgsRef {
+ public:
+  template <typename... Args>
+  explicit LogArgsRef(const std::tuple<const Args&...>& args)
+      : args_(&args),
+        exact_((LogArgStored<std::remove_cvref_t<Args>> && ...)),
+        encode_(&encode_tuple<Args...>),
+        encode_message_(&encode_message_tuple<Args...>),
+        format_(&format_tuple<Args...>) {}
+
+  // Whether all the arguments are stored as they are (see `LogArgStored`) and the format string has no dynamic specs,
+  // so that the encoding formats with the specs of the format string.
+  bool exact(std::string_view fmt) const { return exact_ && !has_dynamic_specs(fmt); }
+
+  // Returns the size of the encoding, which is the size of the whole buffer if the arguments may not have fit.
+  size_t encode(std::span<std::byte> buffer) const { return encode_(args_, buffer); }
+  // Encodes the message formatted from the arguments as a single string argument, to be formatted with "{}".
+  size_t encode_message(std::span<std::byte> buffer, std::string_view fmt) const {
+    return encode_message_(args_, buffer, fmt);
+  }
+  // Appends the message formatted from the arguments, format errors are appended as in `format_log_message`.
+  void format(std::string& out, std::string_view fmt) const { format_(args_, out, fmt); }
+
+ private:
+  template <typename... Args>
+  static size_t encode_tuple(const void* args, std::span<std::byte> buffer) {
+    return std::apply([buffer](const Args&... values) { return encode_log_args(buffer, values...); },
+                      *static_cast<const std::tuple<const Args&...>*>(args));
+  }
+
+  template <typename... Args>
+  static size_t encode_message_tuple(const void* args, std::span<std::byte> buffer, std::string_view fmt) {
+    LogArgsWriter writer(buffer);
+    std::apply([&writer, fmt](const Args&... values) { writer.write_message(fmt, values...); },
+               *static_cast<const std::tuple<const Args&...>*>(args));
+    return writer.size();
+  }
+
+  template <typename... Args>
+  static void format_tuple(const void* args, std::string& out, std::string_view fmt) {
+    try {
+      std::apply(
+          [&out, fmt](const Args&... values) {
+            std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(values...));
+          },
+          *static_cast<const std::tuple<const Args&...>*>(args));
+    } catch (const std::exception& e) {
+      out.append(" <");
+      out.append(e.what());
+      out.append(">");
+    }
+  }
+
+ private:
+  const void* args_;
+  bool exact_;
+  size_t (*encode_)(const void*, std::span<std::byte>);
+  size_t (*encode_message_)(const void*, std::span<std::byte>, std::string_view);
+  void (*format_)(const void*, std::string&, std::string_view);
+};
+
+}  // namespace resin
+
+template <>
+struct std::formatter<resin::LogArgValue> {
+  constexpr auto parse(std::format_parse_context& ctx) {
+    auto it = ctx.begin();
+    while (it != ctx.end() && *it != '}') {
+      ++it;
+    }
+    spec_ = std::string_view(ctx.begin(), it);
+    return it;
+  }
+
+  std::format_context::iterator format(const resin::LogArgValue& arg, std::format_context& ctx) const {
+    return std::visit([this, &ctx](const auto& value) { return format_as(value, ctx); }, arg.value);
+  }
+
+ private:
+  template <typename T>
+  std::format_context::iterator format_as(const T& value, std::format_context& ctx) const {
+    std::formatter<T> underlying;
+    std::format_parse_context parse_ctx(spec_);
+    parse_ctx.advance_to(underlying.parse(parse_ctx));
+    return underlying.format(value, ctx);
+  }
+
+  std::string_view spec_;
+};
+
+#endif  // RESIN_LOG_ARGS_HPP
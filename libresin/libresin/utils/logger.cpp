@@ -1,17 +1,25 @@
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <deque>
 #include <filesystem>
 #include <iostream>
 #include <iterator>
+#include <libresin/utils/binary_log.hpp>
+#include <libresin/utils/bounded_queue.hpp>
+#include <libresin/utils/gzip.hpp>
 #include <libresin/utils/logger.hpp>
 #include <memory>
 #include <mutex>
 #include <print>
+#include <ranges>
 #include <regex>
-#include <set>
 #include <source_location>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -25,6 +33,16 @@
 
 namespace resin {
 
+std::optional<LogLevel> parse_log_level(std::string_view name) {
+  static constexpr std::array<std::string_view, 4> kNames = {"error", "warn", "info", "debug"};
+
+  const auto* it = std::ranges::find(kNames, name);
+  if (it == kNames.end()) {
+    return std::nullopt;
+  }
+  return static_cast<LogLevel>(it - kNames.begin());
+}
+
 LoggerScribe::LoggerScribe(LogLevel max_level) : max_level_(max_level) {}
 
 TerminalLoggerScribe::TerminalLoggerScribe(bool use_stderr, LogLevel max_level)
@@ -54,56 +72,84 @@ static void end_win_terminal(WORD old_attributes) {
 }
 #endif
 
-static void print_msg(std::ostream& stream, std::string_view prefix, std::string_view usr_fmt,
-                      std::format_args usr_args, const std::chrono::time_point<std::chrono::system_clock>& time_point,
-                      std::string_view file_name, const std::source_location& location, LogLevel level) {
+namespace {
+
+// Looking up the time zone and converting to the local time are expensive, so the zone is looked up once and the text
+// is formatted again only when the second changes.
+class LocalTimeCache {
+ public:
+  std::string_view format(const std::chrono::sys_seconds& seconds) {
+    if (seconds != seconds_) {
+      static const std::chrono::time_zone* const kZone = std::chrono::current_zone();
+
+      const std::chrono::zoned_time local_time{kZone, seconds};
+      const auto result = std::format_to_n(text_.data(), std::ssize(text_), "{:%T}", local_time);
+      size_             = static_cast<size_t>(result.out - text_.data());
+      seconds_          = seconds;
+    }
+    return {text_.data(), size_};
+  }
+
+ private:
+  std::chrono::sys_seconds seconds_ = std::chrono::sys_seconds::min();
+  std::array<char, 16> text_{};
+  size_t size_ = 0;
+};
+
+// Per thread, because `write_log_text` can be called from any thread
+thread_local LocalTimeCache tl_local_time_cache;
+
+}  // namespace
+
+static void append_msg(std::string& out, std::string_view prefix, const LogRecord& record) {
+  static constexpr std::string_view kPadding = "      ";
+  static_assert(kPadding.size() > kMaxLogPrefixSize);
+
   // Print logger message prefix with date
-  auto local_time =
-      std::chrono::zoned_time{std::chrono::current_zone(), std::chrono::floor<std::chrono::seconds>(time_point)};
-  std::print(stream, "[{0:{2}} {1:%T}] ", prefix, local_time, kMaxLogPrefixSize);
+  const auto seconds = std::chrono::floor<std::chrono::seconds>(record.time_point());
+  out.push_back('[');
+  out.append(prefix);
+  out.append(kPadding.substr(0, kMaxLogPrefixSize + 1 - prefix.size()));
+  out.append(tl_local_time_cache.format(seconds));
+  if (record.timestamp_mode() == LogTimestampMode::Monotonic) {
+    std::format_to(std::back_inserter(out), ".{:06}",
+                   std::chrono::floor<std::chrono::microseconds>(record.time_point() - seconds).count());
+  }
+  out.append("] ");
 
   // Print location
-  if (level < LogLevel::Info) {
+  const LogLocation& location = record.location();
+  if (record.level() < LogLevel::Info) {
 #ifdef NDEBUG
-    std::print(stream, "`{0}`: ", location.function_name());
+    std::format_to(std::back_inserter(out), "`{0}`: ", location.function_name);
 #else
-    std::print(stream, "{0}({1}:{2}) `{3}`: ", file_name, location.line(), location.column(), location.function_name());
+    std::format_to(std::back_inserter(out), "{0}({1}:{2}) `{3}`: ", location.file_path, location.line,
+                   location.column, location.function_name);
 #endif
   }
 
   // Print message provided by the user
-  std::vprint_unicode(stream, usr_fmt, usr_args);
+  out.append(record.message());
 }
 
-void TerminalLoggerScribe::vlog(std::string_view usr_fmt, std::format_args usr_args,
-                                const std::chrono::time_point<std::chrono::system_clock>& time_point,
-                                std::string_view file_path, const std::source_location& location, LogLevel level,
-                                bool is_debug_msg) {
-#ifndef NDEBUG
-  if (is_debug_msg) {
-#ifdef IS_UNIX
-    begin_unix_terminal("[34m");  // Blue
-#else
-    WORD old_win_terminal_attributes = begin_win_terminal(FOREGROUND_BLUE);
-#endif
-
-    print_msg(*std_stream_, kDebugLogPrefix, usr_fmt, usr_args, time_point, file_path, location, level);
+static void print_msg(std::ostream& stream, std::string_view prefix, const LogRecord& record) {
+  thread_local std::string text;
 
-#ifdef IS_UNIX
-    end_unix_terminal();
-#else
-    end_win_terminal(old_win_terminal_attributes);
-#endif
-    return;
-  }
-#endif
+  text.clear();
+  append_msg(text, prefix, record);
+  stream << text;
+}
 
+void TerminalLoggerScribe::log(const LogRecord& record) {
+  const LogLevel level = record.level();
   if (level > max_level_) {
     return;
   }
 
 #ifdef IS_UNIX
-  if (level == LogLevel::Err) {
+  if (record.is_debug_msg()) {
+    begin_unix_terminal("[34m");  // Blue
+  } else if (level == LogLevel::Err) {
     begin_unix_terminal("[1;31m");  // Red bold
   } else if (level == LogLevel::Warn) {
     begin_unix_terminal("[1;33m");  // Yellow bold
@@ -112,7 +158,9 @@ void TerminalLoggerScribe::vlog(std::string_view usr_fmt, std::format_args usr_a
   }
 #else
   WORD old_win_terminal_attributes = 0;
-  if (level == LogLevel::Err) {
+  if (record.is_debug_msg()) {
+    old_win_terminal_attributes = begin_win_terminal(FOREGROUND_BLUE);
+  } else if (level == LogLevel::Err) {
     old_win_terminal_attributes = begin_win_terminal(FOREGROUND_RED);
   } else if (level == LogLevel::Warn) {
     old_win_terminal_attributes = begin_win_terminal(FOREGROUND_RED | FOREGROUND_GREEN);
@@ -121,7 +169,7 @@ void TerminalLoggerScribe::vlog(std::string_view usr_fmt, std::format_args usr_a
   }
 #endif
 
-  print_msg(*std_stream_, get_log_prefix(level), usr_fmt, usr_args, time_point, file_path, location, level);
+  print_msg(*std_stream_, record.is_debug_msg() ? kDebugLogPrefix : get_log_prefix(level), record);
 
 #ifdef IS_UNIX
   end_unix_terminal();
@@ -130,106 +178,342 @@ void TerminalLoggerScribe::vlog(std::string_view usr_fmt, std::format_args usr_a
 #endif
 }
 
-RotatedFileLoggerScribe::RotatedFileLoggerScribe(std::filesystem::path base_path, size_t max_backups,
-                                                 LogLevel max_level)
-    : LoggerScribe(max_level), file_stream_(std::nullopt), base_path_(std::move(base_path)), max_backups_(max_backups) {
-  namespace fs = std::filesystem;
-  namespace ch = std::chrono;
-
-  static const std::regex kFileNameRegexp(R"(resin_logs_(\d{4})-(\d{2})-(\d{2})T(\d{2})-(\d{2})-(\d{2}).txt)");
-  static constexpr std::string_view kDateFormat           = "resin_logs_%Y-%m-%dT%H-%M-%S.txt";
-  static constexpr std::string_view kOutputFileDateFormat = "resin_logs_{0:%FT%H-%M-%S}.txt";
+void TerminalLoggerScribe::flush() {
+  std_stream_->flush();
+  std::fflush(stdout);
+}
 
-  if (!fs::exists(base_path_)) {
+static bool check_log_directory(const std::filesystem::path& base_path) {
+  if (!std::filesystem::exists(base_path)) {
     Logger::err("File logger scribe could not open the directory \"{0}\": Directory does not exists.",
-                base_path_.string());
-    return;
+                base_path.string());
+    return false;
   }
 
-  if (!fs::is_directory(base_path_)) {
+  if (!std::filesystem::is_directory(base_path)) {
     Logger::err("File logger scribe could not open the directory \"{0}\": Provided path is not a directory.",
-                base_path_.string());
+                base_path.string());
+    return false;
+  }
+
+  return true;
+}
+
+// Returns the log files with the given extension, compressed or not, from the oldest to the newest. File names start
+// with the creation time, so the lexicographical order is the chronological one.
+static std::deque<std::filesystem::path> find_log_files(const std::filesystem::path& base_path,
+                                                        std::string_view extension) {
+  const std::regex file_name_regexp(
+      std::format(R"(resin_logs_\d{{4}}-\d{{2}}-\d{{2}}T\d{{2}}-\d{{2}}-\d{{2}}(_\d+)?\.{}(\.gz)?)", extension));
+
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(base_path)) {
+    if (entry.is_regular_file() && std::regex_match(entry.path().filename().string(), file_name_regexp)) {
+      files.push_back(entry.path());
+    }
+  }
+
+  std::ranges::sort(files);
+  return {files.begin(), files.end()};
+}
+
+// Returns a path of a new log file named after the current local time, that sorts after the existing `files`.
+static std::filesystem::path make_log_file_path(const std::filesystem::path& base_path, std::string_view extension,
+                                                const std::deque<std::filesystem::path>& files) {
+  const auto local_time = std::chrono::zoned_time{
+      std::chrono::current_zone(), std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now())};
+  const std::string stem = std::format("resin_logs_{0:%FT%H-%M-%S}", local_time);
+
+  // Files may be rotated more than once per second
+  const auto is_taken = [&files](const std::filesystem::path& path) {
+    return std::filesystem::exists(path) || (!files.empty() && path.filename() <= files.back().filename());
+  };
+  auto file_path = base_path / std::format("{}.{}", stem, extension);
+  for (size_t i = 1; is_taken(file_path); ++i) {
+    file_path = base_path / std::format("{}_{:03}.{}", stem, i, extension);
+  }
+  return file_path;
+}
+
+// Removes the file together with its compressed version.
+static bool remove_log_file(const std::filesystem::path& path) {
+  std::error_code error;
+  std::error_code compressed_error;
+  std::filesystem::remove(path, error);
+  std::filesystem::remove(path.string() + ".gz", compressed_error);
+  return !error && !compressed_error;
+}
+
+// Removes the oldest files until at most `max_files` are left and reports every removal.
+template <typename Report>
+static void remove_old_log_files(std::deque<std::filesystem::path>& files, size_t max_files, const Report& report) {
+  while (files.size() > max_files) {
+    report(files.front(), remove_log_file(files.front()));
+    files.pop_front();
+  }
+}
+
+static void report_log_file_removal(const std::filesystem::path& path, bool removed) {
+  if (removed) {
+    Logger::info("Deleted old log backup file \"{}\".", path.filename().string());
+  } else {
+    Logger::warn("Could not delete old log backup file \"{}\".", path.filename().string());
+  }
+}
+
+// Removes the oldest log files with the given extension from the directory, so that together with the new one there
+// are at most `max_backups` files, and returns the path of the new file.
+static std::optional<std::filesystem::path> prepare_log_file(const std::filesystem::path& base_path,
+                                                             size_t max_backups, std::string_view extension) {
+  if (!check_log_directory(base_path)) {
+    return std::nullopt;
+  }
+
+  auto files = find_log_files(base_path, extension);
+  remove_old_log_files(files, std::max<size_t>(max_backups, 1) - 1, report_log_file_removal);
+  return make_log_file_path(base_path, extension, files);
+}
+
+// Runs on a background thread, so errors cannot be logged without the risk of waiting for the logger lock held by the
+// thread that joins this one.
+static void compress_log_file(const std::filesystem::path& path) {
+  const std::filesystem::path compressed_path = path.string() + ".gz";
+  try {
+    gzip_file(path, compressed_path);
+    std::filesystem::remove(path);
+  } catch (const std::exception& e) {
+    std::println(std::cerr, "Could not compress the log file \"{}\": {}", path.string(), e.what());
+    std::error_code error;
+    std::filesystem::remove(compressed_path, error);
+  }
+}
+
+RotatedFileLoggerScribe::RotatedFileLoggerScribe(std::filesystem::path base_path, size_t max_backups,
+                                                 LogLevel max_level)
+    : RotatedFileLoggerScribe(std::move(base_path), LogRotation{.max_backups = max_backups}, max_level) {}
+
+RotatedFileLoggerScribe::RotatedFileLoggerScribe(std::filesystem::path base_path, const LogRotation& rotation,
+                                                 LogLevel max_level)
+    : LoggerScribe(max_level),
+      write_buffer_(kWriteBufferSize),
+      file_stream_(std::nullopt),
+      base_path_(std::move(base_path)),
+      rotation_(rotation) {
+  if (!check_log_directory(base_path_)) {
     return;
   }
 
-  using file_tp = std::tuple<fs::path, ch::system_clock::time_point>;
+  // The directory is scanned only once, rotation keeps track of the files on its own
+  files_ = find_log_files(base_path_, "txt");
+  remove_old_log_files(files_, std::max<size_t>(rotation_.max_backups, 1) - 1, report_log_file_removal);
+
+  const auto file_path = make_log_file_path(base_path_, "txt", files_);
+  files_.push_back(file_path);
+  if (!open_file(file_path, std::chrono::system_clock::now())) {
+    Logger::err("File logger scribe could not create/open a file \"{0}\"", file_path.string());
+  }
+}
+
+bool RotatedFileLoggerScribe::open_file(const std::filesystem::path& path,
+                                        const std::chrono::time_point<std::chrono::system_clock>& time_point) {
+  file_stream_.emplace();
+  // Has to be set before the file is opened
+  file_stream_->rdbuf()->pubsetbuf(write_buffer_.data(), static_cast<std::streamsize>(write_buffer_.size()));
+  file_stream_->open(path);
 
-  auto cmp = [](const file_tp& a, const file_tp& b) -> bool { return std::get<1>(a) > std::get<1>(b); };
-  std::set<file_tp, decltype(cmp)> curr_files;
+  file_size_      = 0;
+  file_open_time_ = time_point;
+  return file_stream_->is_open();
+}
 
-  for (const auto& entry : fs::directory_iterator(base_path_)) {
-    if (!entry.is_regular_file()) {
-      continue;
-    }
+void RotatedFileLoggerScribe::rotate(const std::chrono::time_point<std::chrono::system_clock>& time_point) {
+  const std::filesystem::path closed_path = files_.back();
+  file_stream_.reset();
 
-    auto curr_name = entry.path().filename().string();
+  // The previous compression must finish before its file can be removed
+  if (compressor_.joinable()) {
+    compressor_.join();
+  }
 
-    if (std::regex_match(curr_name, kFileNameRegexp)) {
-      std::tm tm = {};
-      std::stringstream ss(curr_name);
-      ss >> std::get_time(&tm, kDateFormat.data());
+  // The logger is locked here, so errors cannot be logged
+  const auto file_path = make_log_file_path(base_path_, "txt", files_);
+  files_.push_back(file_path);
+  remove_old_log_files(files_, std::max<size_t>(rotation_.max_backups, 1),
+                       [](const std::filesystem::path& path, bool removed) {
+                         if (!removed) {
+                           std::println(std::cerr, "Could not delete old log backup file \"{}\".",
+                                        path.filename().string());
+                         }
+                       });
+
+  if (rotation_.compress && std::ranges::find(files_, closed_path) != files_.end()) {
+    compressor_ = std::jthread([closed_path] { compress_log_file(closed_path); });
+  }
 
-      curr_files.insert(std::make_tuple(entry.path(), ch::system_clock::from_time_t(std::mktime(&tm))));
-    }
+  if (!open_file(file_path, time_point)) {
+    std::println(std::cerr, "File logger scribe could not create/open a file \"{}\"", file_path.string());
   }
+}
 
-  if (curr_files.size() > max_backups_ - 1) {
-    auto it = curr_files.begin();
-    std::advance(it, max_backups_ - 1);
+void append_log_text(std::string& out, const LogRecord& record) {
+  append_msg(out, record.is_debug_msg() ? kDebugLogPrefix : get_log_prefix(record.level()), record);
+  out.push_back('\n');
+}
 
-    for (; it != curr_files.end(); ++it) {
-      if (fs::remove(std::get<0>(*it))) {
-        Logger::info("Deleted old log backup file \"{}\".", std::get<0>(*it).filename().string());
-      } else {
-        Logger::warn("Could not delete old log backup file \"{}\".", std::get<0>(*it).filename().string());
-      }
+void write_log_text(std::ostream& stream, const LogRecord& record) {
+  print_msg(stream, record.is_debug_msg() ? kDebugLogPrefix : get_log_prefix(record.level()), record);
+  stream << '\n';
+}
+
+void RotatedFileLoggerScribe::log(const LogRecord& record) {
+  if (!file_stream_.has_value() || !file_stream_->is_open() || record.level() > max_level_) {
+    return;
+  }
+
+  const bool size_exceeded = rotation_.max_file_size > 0 && file_size_ >= rotation_.max_file_size;
+  const bool age_exceeded  = rotation_.max_file_age > std::chrono::seconds::zero() &&
+                            record.time_point() - file_open_time_ >= rotation_.max_file_age;
+  if (size_exceeded || age_exceeded) {
+    rotate(record.time_point());
+    if (!file_stream_->is_open()) {
+      return;
     }
   }
 
-  auto local_time = std::chrono::zoned_time{std::chrono::current_zone(),
-                                            std::chrono::floor<std::chrono::seconds>(ch::system_clock::now())};
-  auto file_path  = base_path_;
-  file_path.append(std::format(kOutputFileDateFormat, local_time));
+  line_.clear();
+  append_log_text(line_, record);
+  file_stream_->write(line_.data(), static_cast<std::streamsize>(line_.size()));
+  file_size_ += line_.size();
+}
 
-  file_stream_.emplace(file_path.string());
-  if (!file_stream_->is_open()) {
-    Logger::err("File logger scribe could not create/open a file \"{0}\"", file_path.string());
+void RotatedFileLoggerScribe::flush() {
+  if (file_stream_.has_value() && file_stream_->is_open()) {
+    file_stream_->flush();
   }
 }
 
-void RotatedFileLoggerScribe::vlog(std::string_view usr_fmt, std::format_args usr_args,
-                                   const std::chrono::time_point<std::chrono::system_clock>& time_point,
-                                   std::string_view file_path, const std::source_location& location, LogLevel level,
-                                   bool is_debug_msg) {
-  if (!file_stream_.has_value() || !file_stream_->is_open()) {
+BinaryFileLoggerScribe::BinaryFileLoggerScribe(const std::filesystem::path& base_path, size_t max_backups,
+                                               LogLevel max_level)
+    : LoggerScribe(max_level) {
+  const auto file_path = prepare_log_file(base_path, max_backups, "rlog");
+  if (!file_path.has_value()) {
     return;
   }
 
-#ifdef NDEBUG
-  if (level <= max_level_) {
-    print_msg(file_stream_.value(), get_log_prefix(level), usr_fmt, usr_args, time_point, file_path, location, level);
-    std::print(file_stream_.value(), "\n");
+  try {
+    writer_ = std::make_unique<BinaryLogWriter>(*file_path);
+  } catch (const std::runtime_error& e) {
+    Logger::err("Binary file logger scribe could not create/open a file \"{0}\": {1}", file_path->string(), e.what());
   }
-#else
-  if (is_debug_msg) {
-    print_msg(file_stream_.value(), kDebugLogPrefix, usr_fmt, usr_args, time_point, file_path, location, level);
-    std::print(file_stream_.value(), "\n");
+}
+
+BinaryFileLoggerScribe::~BinaryFileLoggerScribe() = default;
+
+void BinaryFileLoggerScribe::log(const LogRecord& record) {
+  if (writer_ == nullptr || record.level() > max_level_) {
     return;
   }
 
-  if (level <= max_level_) {
-    print_msg(file_stream_.value(), get_log_prefix(level), usr_fmt, usr_args, time_point, file_path, location, level);
-    std::print(file_stream_.value(), "\n");
+  try {
+    writer_->write(record);
+  } catch (const std::runtime_error& e) {
+    // The logger is locked here, so the error cannot be logged
+    std::println(std::cerr, "Binary file logger scribe stopped: {}", e.what());
+    writer_.reset();
   }
-#endif
 }
 
-Logger::Logger() : file_name_start_pos_(0) {}
+void BinaryFileLoggerScribe::flush() {
+  if (writer_ != nullptr) {
+    writer_->flush();
+  }
+}
+
+std::string_view LogRecord::message() const {
+  if (!formatted_) {
+    message_buffer_->clear();
+    format_log_message(*message_buffer_, fmt_, args_);
+    formatted_ = true;
+  }
+  return *message_buffer_;
+}
+
+struct Logger::AsyncRecord {
+  std::chrono::time_point<std::chrono::system_clock> time_point;
+  LogTimestampMode timestamp_mode;
+  std::source_location location;
+  std::string_view fmt;
+  LogLevel level;
+  bool is_debug_msg;
+  uint32_t args_size;
+  std::array<std::byte, kMaxLogArgsSize> args;
+};
+
+struct Logger::AsyncQueue {
+  explicit AsyncQueue(size_t capacity) : records(capacity) {}
+
+  BoundedQueue<AsyncRecord> records;
+  // Set when the owning thread exits, the queue is released once it has been drained
+  std::atomic<bool> orphaned = false;
+};
+
+namespace {
+
+constexpr auto kBackendPollInterval = std::chrono::milliseconds(10);
+// Format of the queued messages with arguments the encoding would not format exactly, see `LogArgsRef::exact`. These
+// are formatted on the calling thread and queued as a single string.
+constexpr std::string_view kMessageFmt = "{}";
+
+// Set on the thread that currently writes queued messages into the scribes, so that messages logged by the scribes
+// themselves never wait for free space.
+thread_local bool tl_draining = false;
+
+// Registers the calling thread in a counter for the lifetime of the object.
+class ScopedCount {
+ public:
+  explicit ScopedCount(std::atomic<uint32_t>& count) : count_(count) { count_.fetch_add(1); }
+  ~ScopedCount() { count_.fetch_sub(1, std::memory_order_release); }
+
+  ScopedCount(const ScopedCount&)            = delete;
+  ScopedCount(ScopedCount&&)                 = delete;
+  ScopedCount& operator=(const ScopedCount&) = delete;
+  ScopedCount& operator=(ScopedCount&&)      = delete;
+
+ private:
+  std::atomic<uint32_t>& count_;
+};  // class ScopedCount
+
+}  // namespace
+
+LogCategory::LogCategory(std::string_view name) : LogCategory(name, true) {
+  Logger::get_instance().register_category(*this);
+}
+
+LogCategory::LogCategory(std::string_view name, bool registered) : name_(name), registered_(registered) {}
+
+LogCategory::~LogCategory() {
+  if (registered_) {
+    Logger::get_instance().unregister_category(*this);
+  }
+}
+
+Logger::Logger()
+    : file_name_start_pos_(0),
+      start_system_time_(std::chrono::system_clock::now()),
+      start_steady_time_(std::chrono::steady_clock::now()),
+      default_category_("default", false) {}
+
+Logger::~Logger() { disable_async(); }
 
 void Logger::add_scribe(std::unique_ptr<LoggerScribe> scribe) {
   const std::lock_guard lock(mutex_);
 
+  const LogLevel scribe_level = scribe->max_level();
   scribes_.push_back(std::move(scribe));
+
+  const std::lock_guard categories_lock(categories_mutex_);
+  max_scribe_level_ = std::max(max_scribe_level_.value_or(LogLevel::Err), scribe_level);
+  update_categories();
 }
 
 void Logger::set_abs_build_path(const std::filesystem::path& abs_build_path) {
@@ -244,4 +528,308 @@ void Logger::set_abs_build_path(const std::filesystem::path& abs_build_path) {
   }
 }
 
+void Logger::set_level(LogLevel level) {
+  const std::lock_guard lock(categories_mutex_);
+
+  level_ = level;
+  update_categories();
+}
+
+void Logger::set_category_level(std::string_view category, LogLevel level) {
+  const std::lock_guard lock(categories_mutex_);
+
+  category_levels_.insert_or_assign(std::string(category), level);
+  update_categories();
+}
+
+void Logger::reset_category_level(std::string_view category) {
+  const std::lock_guard lock(categories_mutex_);
+
+  if (const auto it = category_levels_.find(category); it != category_levels_.end()) {
+    category_levels_.erase(it);
+    update_categories();
+  }
+}
+
+void Logger::set_levels(std::string_view levels) {
+  std::optional<LogLevel> level;
+  std::vector<std::pair<std::string_view, LogLevel>> category_levels;
+
+  for (const auto entry_range : std::views::split(levels, ',')) {
+    const std::string_view entry(entry_range.begin(), entry_range.end());
+    if (entry.empty()) {
+      continue;
+    }
+
+    const size_t separator = entry.find('=');
+    const auto parsed      = parse_log_level(separator == std::string_view::npos ? entry : entry.substr(separator + 1));
+    if (!parsed.has_value() || separator == 0) {
+      throw std::invalid_argument(std::format("Logger: invalid level entry \"{}\"", entry));
+    }
+
+    if (separator == std::string_view::npos) {
+      level = parsed;
+    } else {
+      category_levels.emplace_back(entry.substr(0, separator), *parsed);
+    }
+  }
+
+  const std::lock_guard lock(categories_mutex_);
+  level_ = level.value_or(level_);
+  for (const auto& [category, category_level] : category_levels) {
+    category_levels_.insert_or_assign(std::string(category), category_level);
+  }
+  update_categories();
+}
+
+void Logger::register_category(LogCategory& category) {
+  const std::lock_guard lock(categories_mutex_);
+
+  categories_.push_back(&category);
+  update_category(category);
+}
+
+void Logger::unregister_category(LogCategory& category) {
+  const std::lock_guard lock(categories_mutex_);
+
+  std::erase(categories_, &category);
+}
+
+void Logger::update_category(LogCategory& category) const {
+  uint32_t enabled_levels = 0;
+  if (max_scribe_level_.has_value()) {
+    const auto it = category_levels_.find(category.name());
+    // There is no point in letting through messages that no scribe writes
+    const LogLevel level = std::min(it != category_levels_.end() ? it->second : level_, *max_scribe_level_);
+    enabled_levels       = (2U << static_cast<uint32_t>(level)) - 1;
+  }
+
+  category.enabled_levels_.store(enabled_levels, std::memory_order_relaxed);
+}
+
+void Logger::update_categories() {
+  update_category(default_category_);
+  for (LogCategory* category : categories_) {
+    update_category(*category);
+  }
+}
+
+void Logger::enable_async(size_t queue_capacity, LogQueuePolicy policy) {
+  if (queue_capacity == 0) {
+    throw std::invalid_argument("Logger: queue capacity must be greater than 0");
+  }
+
+  disable_async();
+
+  {
+    const std::lock_guard lock(mutex_);
+    queue_capacity_.store(queue_capacity, std::memory_order_relaxed);
+    policy_.store(policy, std::memory_order_relaxed);
+    // Queues created for the previous configuration are replaced on the next message
+    async_epoch_.fetch_add(1, std::memory_order_relaxed);
+    backend_ = std::jthread([this](const std::stop_token& stop) { backend_loop(stop); });
+  }
+
+  async_.store(true, std::memory_order_release);
+}
+
+void Logger::disable_async() {
+  if (!async_.exchange(false)) {
+    return;
+  }
+
+  // A thread that has seen the flag set may still be pushing, its message must not be left behind the final drain
+  while (async_pushers_.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  backend_.request_stop();
+  backend_.join();
+  flush();
+}
+
+void Logger::flush() {
+  const std::lock_guard lock(mutex_);
+
+  drain_queues();
+  for (const auto& scribe : scribes_) {
+    scribe->flush();
+  }
+}
+
+void Logger::log_record(LogLevel level, bool debug, const std::source_location& location, std::string_view fmt,
+                        LogArgsRef args) {
+  const LogTimestampMode timestamp_mode = timestamp_mode_.load(std::memory_order_relaxed);
+  const auto now = timestamp_mode == LogTimestampMode::Monotonic ? monotonic_now() : std::chrono::system_clock::now();
+  if (async_.load(std::memory_order_acquire)) {
+    const ScopedCount pusher(async_pushers_);
+    // Checked again once registered, `disable_async` clears the flag before it waits for the registered pushers
+    if (async_.load()) {
+      push_async(level, debug, location, now, timestamp_mode, fmt, args);
+      return;
+    }
+  }
+
+  std::array<std::byte, kMaxLogArgsSize> args_buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+  const size_t args_size = args.encode(args_buffer);
+  // A truncated encoding or one that has lost format specs is only passed along, the message is formatted right away
+  const bool lossy = args_size == args_buffer.size() || !args.exact(fmt);
+
+  const std::lock_guard lock(mutex_);
+  if (lossy) {
+    message_buffer_.clear();
+    args.format(message_buffer_, fmt);
+  }
+  dispatch(LogRecord(now, timestamp_mode, to_log_location(location), level, debug, fmt,
+                     std::span(args_buffer).first(args_size), message_buffer_, lossy));
+}
+
+std::chrono::time_point<std::chrono::system_clock> Logger::monotonic_now() const {
+  return start_system_time_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                  std::chrono::steady_clock::now() - start_steady_time_);
+}
+
+LogLocation Logger::to_log_location(const std::source_location& location) const {
+  return {.file_path     = std::string_view(location.file_name() + file_name_start_pos_),
+          .function_name = location.function_name(),
+          .line          = location.line(),
+          .column        = location.column()};
+}
+
+void Logger::dispatch(const LogRecord& record) {
+  for (const auto& scribe : scribes_) {
+    scribe->log(record);
+  }
+}
+
+void Logger::push_async(LogLevel level, bool debug, const std::source_location& location,
+                        const std::chrono::time_point<std::chrono::system_clock>& time_point,
+                        LogTimestampMode timestamp_mode, std::string_view fmt, LogArgsRef args) {
+  AsyncQueue& queue = thread_queue();
+  const bool exact  = args.exact(fmt);
+
+  const auto fill = [&](AsyncRecord& record) noexcept {
+    record.time_point     = time_point;
+    record.timestamp_mode = timestamp_mode;
+    record.location       = location;
+    record.fmt            = exact ? fmt : kMessageFmt;
+    record.level          = level;
+    record.is_debug_msg   = debug;
+    record.args_size      = static_cast<uint32_t>(exact ? args.encode(record.args)
+                                                        : args.encode_message(record.args, fmt));
+  };
+
+  if (!queue.records.try_push_with(fill)) {
+    const LogQueuePolicy policy = tl_draining ? LogQueuePolicy::Drop : policy_.load(std::memory_order_relaxed);
+    switch (policy) {
+      case LogQueuePolicy::Block:
+        do {
+          wake_backend();
+          std::this_thread::yield();
+        } while (!queue.records.try_push_with(fill));
+        break;
+      case LogQueuePolicy::Drop:
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      case LogQueuePolicy::Overwrite:
+        do {
+          if (queue.records.try_pop_with([](const AsyncRecord&) noexcept {})) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+          }
+        } while (!queue.records.try_push_with(fill));
+        break;
+    }
+  }
+
+  // Do not wait for the next poll when the queue fills up quickly
+  if (queue.records.size_approx() > queue.records.capacity() / 2) {
+    wake_backend();
+  }
+}
+
+Logger::AsyncQueue& Logger::thread_queue() {
+  struct ThreadQueue {
+    std::shared_ptr<AsyncQueue> queue;
+    const Logger* owner = nullptr;
+    uint32_t epoch      = 0;
+
+    ~ThreadQueue() {
+      if (queue != nullptr) {
+        queue->orphaned.store(true, std::memory_order_release);
+      }
+    }
+  };
+  thread_local ThreadQueue local;
+
+  const uint32_t epoch = async_epoch_.load(std::memory_order_relaxed);
+  if (local.queue == nullptr || local.owner != this || local.epoch != epoch) {
+    if (local.queue != nullptr) {
+      local.queue->orphaned.store(true, std::memory_order_release);
+    }
+
+    auto queue = std::make_shared<AsyncQueue>(queue_capacity_.load(std::memory_order_relaxed));
+    {
+      const std::lock_guard lock(queues_mutex_);
+      queues_.push_back(queue);
+    }
+    local.queue = std::move(queue);
+    local.owner = this;
+    local.epoch = epoch;
+  }
+
+  return *local.queue;
+}
+
+void Logger::backend_loop(const std::stop_token& stop) {
+  while (!stop.stop_requested()) {
+    {
+      std::unique_lock lock(wake_mutex_);
+      wake_cv_.wait_for(lock, stop, kBackendPollInterval, [this] { return wake_requested_; });
+      wake_requested_ = false;
+    }
+
+    const std::lock_guard lock(mutex_);
+    drain_queues();
+  }
+}
+
+void Logger::wake_backend() {
+  {
+    const std::lock_guard lock(wake_mutex_);
+    wake_requested_ = true;
+  }
+  wake_cv_.notify_one();
+}
+
+void Logger::drain_queues() {
+  {
+    const std::lock_guard lock(queues_mutex_);
+    std::erase_if(queues_, [this](const std::shared_ptr<AsyncQueue>& queue) {
+      const bool orphaned = queue->orphaned.load(std::memory_order_acquire);
+      // Reserved up front, the records are copied out by a callback that must not throw
+      pending_.reserve(pending_.size() + queue->records.capacity());
+      // Bounded, so that a thread that logs continuously cannot starve the others
+      for (size_t i = 0; i < queue->records.capacity(); ++i) {
+        if (!queue->records.try_pop_with([this](const AsyncRecord& record) noexcept { pending_.push_back(record); })) {
+          break;
+        }
+      }
+      return orphaned && queue->records.empty_approx();
+    });
+  }
+
+  // Messages of different threads are merged in chronological order
+  std::ranges::stable_sort(pending_, {}, &AsyncRecord::time_point);
+
+  tl_draining = true;
+  for (const AsyncRecord& record : pending_) {
+    dispatch(LogRecord(record.time_point, record.timestamp_mode, to_log_location(record.location), record.level,
+                       record.is_debug_msg, record.fmt, std::span(record.args).first(record.args_size),
+                       message_buffer_));
+  }
+  tl_draining = false;
+
+  pending_.clear();
+}
+
 }  // namespace resin
@@ -2,32 +2,124 @@
 #define RESIN_UTIL_LOGGER_HPP
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <libresin/utils/log_args.hpp>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <print>
 #include <source_location>
+#include <span>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace resin {
 
 enum class LogLevel : uint32_t {
-  Err  = 0,
-  Warn = 1,
-  Info = 2,
+  Err   = 0,
+  Warn  = 1,
+  Info  = 2,
+  Debug = 3,
 };
 
-static constexpr std::array<std::string_view, 3> kLogPrefixes = {"ERROR", "WARN", "INFO"};
-static constexpr std::string_view kDebugLogPrefix             = "DEBUG";
+static constexpr std::array<std::string_view, 4> kLogPrefixes = {"ERROR", "WARN", "INFO", "DEBUG"};
+static constexpr std::string_view kDebugLogPrefix             = kLogPrefixes[3];
 static constexpr uint32_t kMaxLogPrefixSize                   = 5;
 
 inline std::string_view get_log_prefix(LogLevel level) { return kLogPrefixes[static_cast<uint32_t>(level)]; }
 
+// Parses "error", "warn", "info" or "debug".
+std::optional<LogLevel> parse_log_level(std::string_view name);
+
+// Messages above `RESIN_LOG_LEVEL` (the numeric value of a `LogLevel`) are removed at compile time. By default debug
+// messages are kept only in debug builds.
+#ifndef RESIN_LOG_LEVEL
+#ifdef NDEBUG
+#define RESIN_LOG_LEVEL 2
+#else
+#define RESIN_LOG_LEVEL 3
+#endif
+#endif
+
+static constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(RESIN_LOG_LEVEL);
+static_assert(kCompiledLogLevel <= LogLevel::Debug, "RESIN_LOG_LEVEL must be between 0 and 3");
+
+enum class LogTimestampMode : uint8_t {
+  WallClock = 0,  // system clock, printed with second precision
+  Monotonic = 1,  // steady clock anchored at the system time of the logger start, printed with microsecond precision
+};
+
+// Where a message has been logged. Strings have to outlive the `LogRecord`s referring to them.
+struct LogLocation {
+  std::string_view file_path;
+  std::string_view function_name;
+  uint32_t line;
+  uint32_t column;
+};
+
+/*
+  Single message passed to the `LoggerScribe`s. The arguments are kept in the binary form produced by
+  `encode_log_args` and are formatted on the first call to `message()`, so a message is formatted at most once no
+  matter how many scribes write it. When `formatted` is set the buffer already holds the message, formatted from the
+  original arguments because their encoding is lossy, and `args()` is only the best effort encoding of them.
+*/
+class LogRecord {
+ public:
+  LogRecord(const std::chrono::time_point<std::chrono::system_clock>& time_point, LogTimestampMode timestamp_mode,
+            const LogLocation& location, LogLevel level, bool is_debug_msg, std::string_view fmt,
+            std::span<const std::byte> args, std::string& message_buffer, bool preformatted = false)
+      : time_point_(time_point),
+        timestamp_mode_(timestamp_mode),
+        location_(location),
+        level_(level),
+        is_debug_msg_(is_debug_msg),
+        fmt_(fmt),
+        args_(args),
+        message_buffer_(&message_buffer),
+        preformatted_(preformatted),
+        formatted_(preformatted) {}
+
+  const std::chrono::time_point<std::chrono::system_clock>& time_point() const { return time_point_; }
+  LogTimestampMode timestamp_mode() const { return timestamp_mode_; }
+  const LogLocation& location() const { return location_; }
+  LogLevel level() const { return level_; }
+  bool is_debug_msg() const { return is_debug_msg_; }
+  std::string_view fmt() const { return fmt_; }
+  std::span<const std::byte> args() const { return args_; }
+  // Whether the message was formatted from the original arguments, because `fmt()` and `args()` may not reproduce it
+  // (see `LogArgsRef::exact`).
+  bool preformatted() const { return preformatted_; }
+
+  std::string_view message() const;
+
+ private:
+  std::chrono::time_point<std::chrono::system_clock> time_point_;
+  LogTimestampMode timestamp_mode_;
+  LogLocation location_;
+  LogLevel level_;
+  bool is_debug_msg_;
+  std::string_view fmt_;
+  std::span<const std::byte> args_;
+  std::string* message_buffer_;
+  bool preformatted_;
+  mutable bool formatted_;
+};
+
+// Writes the record followed by a new line in the text format used by `RotatedFileLoggerScribe`.
+void write_log_text(std::ostream& stream, const LogRecord& record);
+void append_log_text(std::string& out, const LogRecord& record);
+
 class LoggerScribe {
  public:
   explicit LoggerScribe(LogLevel max_level);
@@ -36,9 +128,12 @@ class LoggerScribe {
   LoggerScribe& operator=(const LoggerScribe&) = delete;
   virtual ~LoggerScribe()                      = default;
 
-  virtual void vlog(std::string_view usr_fmt, std::format_args usr_args,
-                    const std::chrono::time_point<std::chrono::system_clock>& time_point, std::string_view file_path,
-                    const std::source_location& location, LogLevel level, bool is_debug_msg) = 0;
+  virtual void log(const LogRecord& record) = 0;
+
+  // Pushes buffered output to the underlying device.
+  virtual void flush() {}
+
+  LogLevel max_level() const { return max_level_; }
 
  protected:
   const LogLevel max_level_;
@@ -49,42 +144,152 @@ class LoggerScribe {
 */
 class TerminalLoggerScribe : public LoggerScribe {
  public:
-  explicit TerminalLoggerScribe(bool use_stderr = false, LogLevel max_level = LogLevel::Info);
+  explicit TerminalLoggerScribe(bool use_stderr = false, LogLevel max_level = LogLevel::Debug);
 
-  void vlog(std::string_view usr_fmt, std::format_args usr_args,
-            const std::chrono::time_point<std::chrono::system_clock>& time_point, std::string_view file_path,
-            const std::source_location& location, LogLevel level, bool is_debug_msg) override;
+  void log(const LogRecord& record) override;
+  void flush() override;
 
  private:
   std::ostream* std_stream_;
 };
 
+// When `RotatedFileLoggerScribe` starts a new file and what happens to the old ones.
+struct LogRotation {
+  size_t max_backups                = 4;                              // including the current file
+  size_t max_file_size              = 0;                              // in bytes, 0 disables rotation by size
+  std::chrono::seconds max_file_age = std::chrono::seconds::zero();  // 0 disables rotation by time
+  bool compress                     = false;                          // gzip closed files on a background thread
+};
+
 /*
-  Logs messages to files in the specified directory. If the number of log files exceeds the maximum number of backups
-  the older ones will be deleted.
+  Logs messages to files in the specified directory. A new file is started when the current one grows too big or too
+  old (see `LogRotation`) and if the number of log files exceeds the maximum number of backups the older ones will be
+  deleted. The directory is scanned only once, when the scribe is created. Writes go through a large buffer, so
+  `flush` should be called (e.g. through `Logger::flush`) before the application may abort.
 */
 class RotatedFileLoggerScribe : public LoggerScribe {
  public:
+  static constexpr size_t kWriteBufferSize = size_t{256} << 10U;
+
   explicit RotatedFileLoggerScribe(std::filesystem::path base_path, size_t max_backups,
-                                   LogLevel max_level = LogLevel::Info);
+                                   LogLevel max_level = LogLevel::Debug);
+  RotatedFileLoggerScribe(std::filesystem::path base_path, const LogRotation& rotation,
+                          LogLevel max_level = LogLevel::Debug);
+
+  void log(const LogRecord& record) override;
+  void flush() override;
 
-  void vlog(std::string_view usr_fmt, std::format_args usr_args,
-            const std::chrono::time_point<std::chrono::system_clock>& time_point, std::string_view file_path,
-            const std::source_location& location, LogLevel level, bool is_debug_msg) override;
+ private:
+  bool open_file(const std::filesystem::path& path,
+                 const std::chrono::time_point<std::chrono::system_clock>& time_point);
+  void rotate(const std::chrono::time_point<std::chrono::system_clock>& time_point);
 
  private:
+  // Declared before the stream, which writes its buffered contents into the file when it is destroyed
+  std::vector<char> write_buffer_;
   std::optional<std::ofstream> file_stream_;
   std::filesystem::path base_path_;
-  size_t max_backups_;
+  LogRotation rotation_;
+  std::string line_;
+  size_t file_size_ = 0;
+  std::chrono::time_point<std::chrono::system_clock> file_open_time_;
+  // Log files from the oldest one to the current one
+  std::deque<std::filesystem::path> files_;
+  std::jthread compressor_;
+};
+
+class BinaryLogWriter;
+
+/*
+  Logs messages in the compact binary format (see `binary_log.hpp`) to memory mapped files in the specified directory.
+  Only the timestamp, the callsite id and the raw arguments are written per message, the messages are never formatted.
+  The files can be converted to the text format with the `resin-logcat` tool. Old files are deleted the same way as by
+  `RotatedFileLoggerScribe`.
+*/
+class BinaryFileLoggerScribe : public LoggerScribe {
+ public:
+  explicit BinaryFileLoggerScribe(const std::filesystem::path& base_path, size_t max_backups,
+                                  LogLevel max_level = LogLevel::Debug);
+  ~BinaryFileLoggerScribe() override;
+
+  void log(const LogRecord& record) override;
+  void flush() override;
+
+ private:
+  std::unique_ptr<BinaryLogWriter> writer_;
+};
+
+/*
+  Named group of messages with its own level, e.g. a subsystem or a module. Categories are meant to live as long as
+  the module that logs into them:
+
+    static const resin::LogCategory kSdfLog("sdf");
+    resin::Logger::debug(kSdfLog, "Evaluated {} nodes", count);
+
+  The level of a category is set with `Logger::set_category_level`, also before the category is created, and
+  defaults to the level of the logger. Either way a message is written only by the scribes that accept its level.
+*/
+class LogCategory {
+ public:
+  explicit LogCategory(std::string_view name);
+  ~LogCategory();
+
+  LogCategory(const LogCategory&)            = delete;
+  LogCategory& operator=(const LogCategory&) = delete;
+
+  const std::string& name() const { return name_; }
+
+  // A single relaxed load, so that disabled messages are dropped before any other work is done
+  bool is_enabled(LogLevel level) const {
+    return (enabled_levels_.load(std::memory_order_relaxed) & (1U << static_cast<uint32_t>(level))) != 0;
+  }
+
+ private:
+  friend class Logger;
+
+  // The default category is owned by the logger and is not registered
+  LogCategory(std::string_view name, bool registered);
+
+ private:
+  std::string name_;
+  bool registered_;
+  // Bit `i` is set if messages of level `i` are written
+  std::atomic<uint32_t> enabled_levels_ = 0;
+};
+
+// What an asynchronous `Logger` does when the queue of the logging thread is full.
+enum class LogQueuePolicy : uint8_t {
+  Block     = 0,  // wait until the background thread makes room
+  Drop      = 1,  // discard the new message
+  Overwrite = 2,  // discard the oldest queued message
 };
 
 /*
   Singleton thread-safe class that forwards messages to the provided `LoggerScribe`s.
+
+  Messages above `kCompiledLogLevel` are compiled out and the rest are dropped right away if their category or all the
+  scribes reject their level. Otherwise a log call only copies the format string pointer, the source location and the
+  encoded arguments (see `encode_log_args`), the message is formatted later, once for all scribes. Format strings must
+  therefore outlive the logger, which string literals do. By default the record is written synchronously on the
+  calling thread. In the asynchronous mode (`enable_async`) it is pushed into a lock-free queue owned by the calling
+  thread and a background thread drains all the queues into the scribes, so logging never waits for formatting, the
+  terminal or the disk.
+
+  Calls with arguments the encoding does not store as they are (see `LogArgsRef::exact`) are formatted on the calling
+  thread, so that the format specs apply to the original values. Synchronous calls whose arguments do not fit in
+  `kMaxLogArgsSize` bytes are formatted on the calling thread as well, queued messages are truncated to that size.
 */
 class Logger {
  public:
+  static constexpr size_t kDefaultQueueCapacity = 1024;
+#ifdef NDEBUG
+  static constexpr LogLevel kDefaultLevel = LogLevel::Info;
+#else
+  static constexpr LogLevel kDefaultLevel = LogLevel::Debug;
+#endif
+
   Logger();
-  ~Logger() = default;
+  ~Logger();
 
   struct FormatWithLocation {
     const char* value;
@@ -96,49 +301,158 @@ class Logger {
 
   template <typename... Args>
   static inline void err(FormatWithLocation fmt_loc, Args&&... args) {
-    get_instance().log(LogLevel::Err, false, fmt_loc.loc, fmt_loc.value, args...);
+    log_to<LogLevel::Err>(get_instance().default_category_, fmt_loc, args...);
+  }
+
+  template <typename... Args>
+  static inline void err(const LogCategory& category, FormatWithLocation fmt_loc, Args&&... args) {
+    log_to<LogLevel::Err>(category, fmt_loc, args...);
   }
 
   template <typename... Args>
   static inline void warn(FormatWithLocation fmt_loc, Args&&... args) {
-    get_instance().log(LogLevel::Warn, false, fmt_loc.loc, fmt_loc.value, args...);
+    log_to<LogLevel::Warn>(get_instance().default_category_, fmt_loc, args...);
+  }
+
+  template <typename... Args>
+  static inline void warn(const LogCategory& category, FormatWithLocation fmt_loc, Args&&... args) {
+    log_to<LogLevel::Warn>(category, fmt_loc, args...);
   }
 
   template <typename... Args>
   static inline void info(FormatWithLocation fmt_loc, Args&&... args) {
-    get_instance().log(LogLevel::Info, false, fmt_loc.loc, fmt_loc.value, args...);
+    log_to<LogLevel::Info>(get_instance().default_category_, fmt_loc, args...);
+  }
+
+  template <typename... Args>
+  static inline void info(const LogCategory& category, FormatWithLocation fmt_loc, Args&&... args) {
+    log_to<LogLevel::Info>(category, fmt_loc, args...);
   }
 
   template <typename... Args>
   static inline void debug(FormatWithLocation fmt_loc, Args&&... args) {
-#ifndef NDEBUG
-    get_instance().log(LogLevel::Info, true, fmt_loc.loc, fmt_loc.value, args...);
-#endif
+    log_to<LogLevel::Debug>(get_instance().default_category_, fmt_loc, args...);
+  }
+
+  template <typename... Args>
+  static inline void debug(const LogCategory& category, FormatWithLocation fmt_loc, Args&&... args) {
+    log_to<LogLevel::Debug>(category, fmt_loc, args...);
   }
 
   template <typename... Args>
   void log(const LogLevel level, const bool debug, const std::source_location& location, const std::string_view fmt,
-           Args&... args) {
-    const std::lock_guard lock(mutex_);
-    const auto file_path = std::string_view(location.file_name() + file_name_start_pos_);
-    const auto now       = std::chrono::system_clock::now();
-    for (const auto& scribe : scribes_) {
-      scribe->vlog(fmt, std::make_format_args(args...), now, file_path, location, level, debug);
-    }
+           const Args&... args) {
+    static_assert(sizeof...(Args) <= kMaxLogArgs, "Too many arguments for a single log message");
+
+    const std::tuple<const Args&...> arg_refs(args...);
+    log_record(level, debug, location, fmt, LogArgsRef(arg_refs));
   }
 
   void add_scribe(std::unique_ptr<LoggerScribe> scribe);
   void set_abs_build_path(const std::filesystem::path& abs_build_path);
 
+  // Sets the level of the default category and of the categories without their own level.
+  void set_level(LogLevel level);
+  void set_category_level(std::string_view category, LogLevel level);
+  void reset_category_level(std::string_view category);
+  // Applies a comma separated list of levels, e.g. "warn,sdf=debug,transform=info". An entry without a category sets
+  // the level of the logger. Throws `std::invalid_argument` if the list is malformed, in which case nothing is changed.
+  void set_levels(std::string_view levels);
+
+  const LogCategory& default_category() const { return default_category_; }
+
+  // Starts the background thread. Every logging thread gets its own queue of `queue_capacity` messages.
+  void enable_async(size_t queue_capacity = kDefaultQueueCapacity, LogQueuePolicy policy = LogQueuePolicy::Block);
+  // Stops the background thread after writing all queued messages.
+  void disable_async();
+  bool is_async() const { return async_.load(std::memory_order_relaxed); }
+
+  // Writes all queued messages and flushes the scribes. Safe to call from any thread, e.g. before aborting
+  // on a fatal error.
+  void flush();
+
+  void set_timestamp_mode(LogTimestampMode mode) { timestamp_mode_.store(mode, std::memory_order_relaxed); }
+  LogTimestampMode timestamp_mode() const { return timestamp_mode_.load(std::memory_order_relaxed); }
+
+  // Number of messages discarded because of the `Drop` or `Overwrite` policy.
+  size_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
   static Logger& get_instance() {
     static Logger instance;
     return instance;
   }
 
+ private:
+  friend class LogCategory;
+
+  struct AsyncRecord;
+  struct AsyncQueue;
+
+  template <LogLevel Level, typename... Args>
+  static inline void log_to(const LogCategory& category, const FormatWithLocation& fmt_loc, const Args&... args) {
+    if constexpr (Level <= kCompiledLogLevel) {
+      if (category.is_enabled(Level)) {
+        get_instance().log(Level, Level == LogLevel::Debug, fmt_loc.loc, fmt_loc.value, args...);
+      }
+    }
+  }
+
+  void register_category(LogCategory& category);
+  void unregister_category(LogCategory& category);
+  // Both must be called with `categories_mutex_` locked
+  void update_category(LogCategory& category) const;
+  void update_categories();
+
+  void log_record(LogLevel level, bool debug, const std::source_location& location, std::string_view fmt,
+                  LogArgsRef args);
+  void push_async(LogLevel level, bool debug, const std::source_location& location,
+                  const std::chrono::time_point<std::chrono::system_clock>& time_point, LogTimestampMode timestamp_mode,
+                  std::string_view fmt, LogArgsRef args);
+  std::chrono::time_point<std::chrono::system_clock> monotonic_now() const;
+  AsyncQueue& thread_queue();
+  void backend_loop(const std::stop_token& stop);
+  void wake_backend();
+  // Must be called with `mutex_` locked
+  void drain_queues();
+  void dispatch(const LogRecord& record);
+  LogLocation to_log_location(const std::source_location& location) const;
+
  private:
   std::vector<std::unique_ptr<LoggerScribe>> scribes_;
   std::mutex mutex_;
   size_t file_name_start_pos_;
+  std::string message_buffer_;
+
+  std::atomic<LogTimestampMode> timestamp_mode_ = LogTimestampMode::WallClock;
+  const std::chrono::time_point<std::chrono::system_clock> start_system_time_;
+  const std::chrono::steady_clock::time_point start_steady_time_;
+
+  // Levels
+  std::mutex categories_mutex_;
+  std::vector<LogCategory*> categories_;
+  std::map<std::string, LogLevel, std::less<>> category_levels_;
+  LogLevel level_ = kDefaultLevel;
+  std::optional<LogLevel> max_scribe_level_;
+  LogCategory default_category_;
+
+  // Asynchronous mode
+  std::atomic<bool> async_            = false;
+  std::atomic<uint32_t> async_epoch_  = 0;
+  std::atomic<size_t> dropped_        = 0;
+  // Threads between seeing `async_` set and finishing their push
+  std::atomic<uint32_t> async_pushers_ = 0;
+  // Written under `mutex_`, read by the logging threads without it
+  std::atomic<size_t> queue_capacity_ = kDefaultQueueCapacity;
+  std::atomic<LogQueuePolicy> policy_ = LogQueuePolicy::Block;
+
+  std::mutex queues_mutex_;
+  std::vector<std::shared_ptr<AsyncQueue>> queues_;
+  std::vector<AsyncRecord> pending_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable_any wake_cv_;
+  bool wake_requested_ = false;
+  std::jthread backend_;
 };
 
 }  // namespace resin
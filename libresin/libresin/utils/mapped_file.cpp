@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <libresin/utils/mapped_file.hpp>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace resin {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t capacity) {
+  file_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                      FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    throw std::runtime_error("MappedFile: could not create the file \"" + path.string() + "\"");
+  }
+
+  try {
+    map(std::max<size_t>(capacity, 1));
+  } catch (...) {
+    CloseHandle(file_);
+    throw;
+  }
+}
+
+MappedFile::~MappedFile() {
+  unmap();
+
+  LARGE_INTEGER size;
+  size.QuadPart = static_cast<LONGLONG>(size_);
+  SetFilePointerEx(file_, size, nullptr, FILE_BEGIN);
+  SetEndOfFile(file_);
+  CloseHandle(file_);
+}
+
+void MappedFile::map(size_t capacity) {
+  // Mapping more than the current file size extends the file
+  const auto size = static_cast<uint64_t>(capacity);
+  mapping_        = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32U),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFU), nullptr);
+  if (mapping_ == nullptr) {
+    throw std::runtime_error("MappedFile: could not map the file");
+  }
+
+  data_ = static_cast<std::byte*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, capacity));
+  if (data_ == nullptr) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+    throw std::runtime_error("MappedFile: could not map the file");
+  }
+  capacity_ = capacity;
+}
+
+void MappedFile::unmap() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+    data_ = nullptr;
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+  }
+}
+
+void MappedFile::flush() {
+  if (data_ != nullptr) {
+    FlushViewOfFile(data_, size_);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t capacity) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("MappedFile: could not create the file \"" + path.string() + "\"");
+  }
+
+  try {
+    map(std::max<size_t>(capacity, 1));
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+}
+
+MappedFile::~MappedFile() {
+  unmap();
+  // Drop the zero-filled tail that has not been written
+  if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+    // Nothing to do, the reader stops at the zero-filled tail anyway
+  }
+  ::close(fd_);
+}
+
+void MappedFile::map(size_t capacity) {
+  if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+    throw std::runtime_error("MappedFile: could not resize the file");
+  }
+
+  void* data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    throw std::runtime_error("MappedFile: could not map the file");
+  }
+
+  data_     = static_cast<std::byte*>(data);
+  capacity_ = capacity;
+}
+
+void MappedFile::unmap() {
+  if (data_ != nullptr) {
+    ::munmap(data_, capacity_);
+    data_ = nullptr;
+  }
+}
+
+void MappedFile::flush() {
+  if (data_ != nullptr) {
+    ::msync(data_, capacity_, MS_ASYNC);
+  }
+}
+
+#endif
+
+std::span<std::byte> MappedFile::append(size_t size) {
+  if (size_ + size > capacity_) {
+    const size_t capacity = std::max(capacity_ * 2, size_ + size);
+    unmap();
+    map(capacity);
+  }
+
+  const std::span<std::byte> region(data_ + size_, size);
+  size_ += size;
+  return region;
+}
+
+void MappedFile::write(std::span<const std::byte> bytes) {
+  const std::span<std::byte> region = append(bytes.size());
+  std::memcpy(region.data(), bytes.data(), bytes.size());
+}
+
+}  // namespace resin
@@ -0,0 +1,54 @@
+#ifndef RESIN_MAPPED_FILE_HPP
+#define RESIN_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace resin {
+
+/*
+  Append-only file written through a shared memory mapping. Writes are plain memory copies and the operating system
+  writes the pages back in the background. The mapping grows geometrically when it runs out of space and the file is
+  truncated to the written size when it is closed. Space that has been mapped but not written yet is zero-filled.
+*/
+class MappedFile {
+ public:
+  static constexpr size_t kDefaultCapacity = size_t{4} << 20U;
+
+  // Creates (or truncates) the file. Throws `std::runtime_error` if the file cannot be created or mapped.
+  explicit MappedFile(const std::filesystem::path& path, size_t capacity = kDefaultCapacity);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns a writable region of `size` bytes at the end of the file. The region is valid until the next call.
+  std::span<std::byte> append(size_t size);
+  void write(std::span<const std::byte> bytes);
+
+  // Schedules the written pages to be stored on the disk.
+  void flush();
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  void map(size_t capacity);
+  void unmap();
+
+ private:
+  std::byte* data_ = nullptr;
+  size_t size_     = 0;
+  size_t capacity_ = 0;
+
+#ifdef _WIN32
+  void* file_    = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
+
+}  // namespace resin
+#endif  // RESIN_MAPPED_FILE_HPP
@@ -0,0 +1,310 @@
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <glm/common.hpp>
+#include <libresin/utils/mesh_writer.hpp>
+#include <limits>
+#include <stdexcept>
+
+namespace resin {
+
+// The binary formats are little-endian, vertices and indices are copied into them as they are
+static_assert(std::endian::native == std::endian::little, "Mesh writers support only little-endian targets");
+
+namespace {
+
+constexpr uint32_t kGlbMagic     = 0x46546C67U;  // "glTF"
+constexpr uint32_t kGlbVersion   = 2;
+constexpr uint32_t kGlbJsonChunk = 0x4E4F534AU;  // "JSON"
+constexpr uint32_t kGlbBinChunk  = 0x004E4942U;  // "BIN\0"
+constexpr size_t kGlbHeaderSize  = 12;
+constexpr size_t kGlbChunkHeader = 8;
+
+template <typename T>
+void write_raw(std::ostream& stream, std::span<const T> data) {
+  stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+}
+
+void write_u32(std::ostream& stream, const uint32_t value) { write_raw(stream, std::span(&value, 1)); }
+
+void check_stream(const std::ios& stream, const std::filesystem::path& path) {
+  if (!stream) {
+    throw std::runtime_error("MeshWriter: could not write the file \"" + path.string() + "\"");
+  }
+}
+
+std::ofstream open_output(const std::filesystem::path& path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("MeshWriter: could not create the file \"" + path.string() + "\"");
+  }
+  return file;
+}
+
+// Temporary file next to the output for the data stored after everything that is streamed into the output
+std::fstream open_spool(const std::filesystem::path& path) {
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("MeshWriter: could not create the file \"" + path.string() + "\"");
+  }
+  return file;
+}
+
+void append_spool(std::fstream& spool, std::ofstream& out, const size_t size) {
+  // Inserting an empty buffer sets the failbit of the output
+  if (size == 0) {
+    return;
+  }
+  spool.flush();
+  spool.seekg(0);
+  out << spool.rdbuf();
+}
+
+void remove_spool(std::fstream& spool, const std::filesystem::path& path) {
+  if (spool.is_open()) {
+    spool.close();
+  }
+  std::error_code error;
+  std::filesystem::remove(path, error);
+}
+
+void check_triangles(std::span<const uint32_t> indices, const size_t vertex_count, const size_t triangle_count) {
+  if (indices.size() % 3 != 0) {
+    throw std::invalid_argument("MeshWriter: triangles need 3 indices each");
+  }
+  if (triangle_count + indices.size() / 3 > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("MeshWriter: too many triangles");
+  }
+  for (const uint32_t index : indices) {
+    if (index >= vertex_count) {
+      throw std::out_of_range("MeshWriter: a triangle refers to a vertex that has not been written");
+    }
+  }
+}
+
+void check_vertices(std::span<const glm::vec3> vertices, const size_t vertex_count) {
+  if (vertex_count + vertices.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("MeshWriter: too many vertices");
+  }
+}
+
+void append_float(std::string& out, const float value) {
+  std::array<char, 32> digits{};
+  const auto [end, error] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+  out.append(digits.data(), end);
+}
+
+void append_uint(std::string& out, const size_t value) {
+  std::array<char, 24> digits{};
+  const auto [end, error] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+  out.append(digits.data(), end);
+}
+
+}  // namespace
+
+PlyMeshWriter::PlyMeshWriter(const std::filesystem::path& path)
+    : path_(path), faces_path_(std::filesystem::path(path).concat(".faces")), file_(open_output(path)),
+      faces_(open_spool(faces_path_)) {
+  // The header is written again with the final counts, which keep their width
+  file_ << header();
+}
+
+PlyMeshWriter::~PlyMeshWriter() { remove_spool(faces_, faces_path_); }
+
+std::string PlyMeshWriter::header() const {
+  return std::format(
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex {:010}\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "element face {:010}\n"
+      "property list uchar uint vertex_indices\n"
+      "end_header\n",
+      vertex_count_, triangle_count_);
+}
+
+void PlyMeshWriter::write_vertices(std::span<const glm::vec3> vertices) {
+  check_vertices(vertices, vertex_count_);
+  write_raw(file_, vertices);
+  vertex_count_ += vertices.size();
+}
+
+void PlyMeshWriter::write_triangles(std::span<const uint32_t> indices) {
+  check_triangles(indices, vertex_count_, triangle_count_);
+
+  // Every face is the vertex count followed by the indices, without any padding
+  constexpr size_t kFaceSize = 1 + 3 * sizeof(uint32_t);
+  buffer_.resize(indices.size() / 3 * kFaceSize);
+  char* out = buffer_.data();
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    *out = 3;
+    std::memcpy(out + 1, &indices[i], 3 * sizeof(uint32_t));
+    out += kFaceSize;
+  }
+  faces_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  triangle_count_ += indices.size() / 3;
+}
+
+void PlyMeshWriter::finish() {
+  if (!file_.is_open()) {
+    return;
+  }
+
+  append_spool(faces_, file_, triangle_count_);
+  file_.seekp(0);
+  file_ << header();
+  file_.close();
+  check_stream(faces_, faces_path_);
+  check_stream(file_, path_);
+  remove_spool(faces_, faces_path_);
+}
+
+ObjMeshWriter::ObjMeshWriter(const std::filesystem::path& path) : path_(path), file_(open_output(path)) {}
+
+void ObjMeshWriter::write_vertices(std::span<const glm::vec3> vertices) {
+  check_vertices(vertices, vertex_count_);
+  buffer_.clear();
+  for (const glm::vec3& vertex : vertices) {
+    buffer_ += "v ";
+    append_float(buffer_, vertex.x);
+    buffer_ += ' ';
+    append_float(buffer_, vertex.y);
+    buffer_ += ' ';
+    append_float(buffer_, vertex.z);
+    buffer_ += '\n';
+  }
+  file_ << buffer_;
+  vertex_count_ += vertices.size();
+}
+
+void ObjMeshWriter::write_triangles(std::span<const uint32_t> indices) {
+  check_triangles(indices, vertex_count_, triangle_count_);
+  buffer_.clear();
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    // OBJ indices start from 1
+    buffer_ += "f ";
+    append_uint(buffer_, size_t{indices[i]} + 1);
+    buffer_ += ' ';
+    append_uint(buffer_, size_t{indices[i + 1]} + 1);
+    buffer_ += ' ';
+    append_uint(buffer_, size_t{indices[i + 2]} + 1);
+    buffer_ += '\n';
+  }
+  file_ << buffer_;
+  triangle_count_ += indices.size() / 3;
+}
+
+void ObjMeshWriter::finish() {
+  if (!file_.is_open()) {
+    return;
+  }
+  file_.close();
+  check_stream(file_, path_);
+}
+
+GlbMeshWriter::GlbMeshWriter(const std::filesystem::path& path)
+    : path_(path), indices_path_(std::filesystem::path(path).concat(".indices")), file_(open_output(path)),
+      indices_(open_spool(indices_path_)), min_(std::numeric_limits<float>::infinity()),
+      max_(-std::numeric_limits<float>::infinity()) {
+  // The headers and the JSON are written by `finish`, once the sizes are known
+  const std::string placeholder(kGlbHeaderSize + kGlbChunkHeader + kJsonCapacity + kGlbChunkHeader, ' ');
+  file_ << placeholder;
+}
+
+GlbMeshWriter::~GlbMeshWriter() { remove_spool(indices_, indices_path_); }
+
+std::string GlbMeshWriter::json() const {
+  if (triangle_count_ == 0) {
+    return R"({"asset":{"version":"2.0","generator":"resin"}})";
+  }
+
+  const size_t positions_size = vertex_count_ * sizeof(glm::vec3);
+  const size_t indices_size   = triangle_count_ * 3 * sizeof(uint32_t);
+  return std::format(
+      R"({{"asset":{{"version":"2.0","generator":"resin"}},"scene":0,"scenes":[{{"nodes":[0]}}],)"
+      R"("nodes":[{{"mesh":0}}],"meshes":[{{"primitives":[{{"attributes":{{"POSITION":0}},"indices":1}}]}}],)"
+      R"("buffers":[{{"byteLength":{}}}],)"
+      R"("bufferViews":[{{"buffer":0,"byteOffset":0,"byteLength":{},"target":34962}},)"
+      R"({{"buffer":0,"byteOffset":{},"byteLength":{},"target":34963}}],)"
+      R"("accessors":[{{"bufferView":0,"componentType":5126,"count":{},"type":"VEC3",)"
+      R"("min":[{},{},{}],"max":[{},{},{}]}},{{"bufferView":1,"componentType":5125,"count":{},"type":"SCALAR"}}]}})",
+      positions_size + indices_size, positions_size, positions_size, indices_size, vertex_count_, min_.x, min_.y,
+      min_.z, max_.x, max_.y, max_.z, triangle_count_ * 3);
+}
+
+void GlbMeshWriter::write_vertices(std::span<const glm::vec3> vertices) {
+  check_vertices(vertices, vertex_count_);
+  for (const glm::vec3& vertex : vertices) {
+    min_ = glm::min(min_, vertex);
+    max_ = glm::max(max_, vertex);
+  }
+  write_raw(file_, vertices);
+  vertex_count_ += vertices.size();
+}
+
+void GlbMeshWriter::write_triangles(std::span<const uint32_t> indices) {
+  check_triangles(indices, vertex_count_, triangle_count_);
+  write_raw(indices_, indices);
+  triangle_count_ += indices.size() / 3;
+}
+
+void GlbMeshWriter::finish() {
+  if (!file_.is_open()) {
+    return;
+  }
+
+  std::string chunk = json();
+  if (chunk.size() > kJsonCapacity) {
+    throw std::logic_error("GlbMeshWriter: the JSON chunk does not fit into its reserved space");
+  }
+  // Chunks are padded to 4 bytes, the JSON one with spaces
+  chunk.resize(kJsonCapacity, ' ');
+
+  // A mesh without triangles is written as an empty asset without the binary chunk
+  const bool has_mesh    = triangle_count_ > 0;
+  const size_t bin_size  = has_mesh ? vertex_count_ * sizeof(glm::vec3) + triangle_count_ * 3 * sizeof(uint32_t) : 0;
+  const size_t json_end  = kGlbHeaderSize + kGlbChunkHeader + kJsonCapacity;
+  const size_t file_size = has_mesh ? json_end + kGlbChunkHeader + bin_size : json_end;
+  if (file_size > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("GlbMeshWriter: the mesh does not fit into a binary glTF file");
+  }
+
+  append_spool(indices_, file_, has_mesh ? triangle_count_ : 0);
+  file_.seekp(0);
+  write_u32(file_, kGlbMagic);
+  write_u32(file_, kGlbVersion);
+  write_u32(file_, static_cast<uint32_t>(file_size));
+  write_u32(file_, static_cast<uint32_t>(kJsonCapacity));
+  write_u32(file_, kGlbJsonChunk);
+  file_ << chunk;
+  write_u32(file_, static_cast<uint32_t>(bin_size));
+  write_u32(file_, kGlbBinChunk);
+  file_.close();
+  check_stream(indices_, indices_path_);
+  check_stream(file_, path_);
+  remove_spool(indices_, indices_path_);
+
+  if (!has_mesh) {
+    std::filesystem::resize_file(path_, file_size);
+  }
+}
+
+std::unique_ptr<MeshWriter> create_mesh_writer(const std::filesystem::path& path) {
+  const std::filesystem::path extension = path.extension();
+  if (extension == ".ply") {
+    return std::make_unique<PlyMeshWriter>(path);
+  }
+  if (extension == ".obj") {
+    return std::make_unique<ObjMeshWriter>(path);
+  }
+  if (extension == ".glb") {
+    return std::make_unique<GlbMeshWriter>(path);
+  }
+  throw std::invalid_argument("create_mesh_writer: unsupported mesh format \"" + extension.string() + "\"");
+}
+
+}  // namespace resin
@@ -0,0 +1,117 @@
+#ifndef RESIN_MESH_WRITER_HPP
+#define RESIN_MESH_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace resin {
+
+/*
+  Streams a triangle mesh into a file. Vertices are numbered in the order they are written, starting from 0, and
+  triangles may only refer to the vertices written before them, so a mesh can be written piece by piece without ever
+  being held in memory as a whole.
+*/
+class MeshWriter {
+ public:
+  MeshWriter()                             = default;
+  MeshWriter(const MeshWriter&)            = delete;
+  MeshWriter& operator=(const MeshWriter&) = delete;
+  virtual ~MeshWriter()                    = default;
+
+  virtual void write_vertices(std::span<const glm::vec3> vertices) = 0;
+  // Three vertex indices per triangle, counterclockwise when seen from the outside.
+  virtual void write_triangles(std::span<const uint32_t> indices) = 0;
+  // Completes the file, nothing can be written afterwards. Throws `std::runtime_error` if the file cannot be written.
+  virtual void finish() = 0;
+
+  size_t vertex_count() const { return vertex_count_; }
+  size_t triangle_count() const { return triangle_count_; }
+
+ protected:
+  size_t vertex_count_   = 0;
+  size_t triangle_count_ = 0;
+};
+
+/*
+  Binary little-endian PLY. The vertices go straight into the file after a header with fixed-width counts, which is
+  rewritten by `finish`, and the faces are spooled into a temporary file next to it, since PLY stores all the vertices
+  before all the faces.
+*/
+class PlyMeshWriter : public MeshWriter {
+ public:
+  // Throws `std::runtime_error` if the file cannot be created.
+  explicit PlyMeshWriter(const std::filesystem::path& path);
+  ~PlyMeshWriter() override;
+
+  void write_vertices(std::span<const glm::vec3> vertices) override;
+  void write_triangles(std::span<const uint32_t> indices) override;
+  void finish() override;
+
+ private:
+  std::string header() const;
+
+ private:
+  std::filesystem::path path_;
+  std::filesystem::path faces_path_;
+  std::ofstream file_;
+  std::fstream faces_;
+  std::string buffer_;
+};
+
+// Wavefront OBJ. Vertices and faces are interleaved in the order they are written, so nothing is spooled.
+class ObjMeshWriter : public MeshWriter {
+ public:
+  // Throws `std::runtime_error` if the file cannot be created.
+  explicit ObjMeshWriter(const std::filesystem::path& path);
+
+  void write_vertices(std::span<const glm::vec3> vertices) override;
+  void write_triangles(std::span<const uint32_t> indices) override;
+  void finish() override;
+
+ private:
+  std::filesystem::path path_;
+  std::ofstream file_;
+  std::string buffer_;
+};
+
+/*
+  Binary glTF 2.0 (.glb) with a single mesh of indexed triangles. The JSON chunk is reserved at the start of the file
+  and written by `finish`, the positions go straight into the binary chunk and the indices are spooled into a temporary
+  file next to it, since they are stored after all the positions.
+*/
+class GlbMeshWriter : public MeshWriter {
+ public:
+  static constexpr size_t kJsonCapacity = 1024;
+
+  // Throws `std::runtime_error` if the file cannot be created.
+  explicit GlbMeshWriter(const std::filesystem::path& path);
+  ~GlbMeshWriter() override;
+
+  void write_vertices(std::span<const glm::vec3> vertices) override;
+  void write_triangles(std::span<const uint32_t> indices) override;
+  void finish() override;
+
+ private:
+  std::string json() const;
+
+ private:
+  std::filesystem::path path_;
+  std::filesystem::path indices_path_;
+  std::ofstream file_;
+  std::fstream indices_;
+  glm::vec3 min_;
+  glm::vec3 max_;
+};
+
+// Picks the writer by the extension of the path: ".ply", ".obj" or ".glb". Throws `std::invalid_argument` for any
+// other extension and `std::runtime_error` if the file cannot be created.
+std::unique_ptr<MeshWriter> create_mesh_writer(const std::filesystem::path& path);
+
+}  // namespace resin
+#endif  // RESIN_MESH_WRITER_HPP
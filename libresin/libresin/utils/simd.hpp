@@ -0,0 +1,126 @@
+#ifndef RESIN_SIMD_HPP
+#define RESIN_SIMD_HPP
+#include <cmath>
+#include <glm/vec3.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESIN_SIMD_SSE
+#include <immintrin.h>
+#endif
+
+#if defined(RESIN_SIMD_SSE) && defined(__AVX2__)
+#define RESIN_SIMD_AVX2
+#endif
+
+/*
+  Thin SIMD wrappers shared by the batch kernels of libresin. Kernels are written once against a "lane" type, which is
+  either `float` (scalar fallback), `F4` (SSE, 4 lanes) or `F8` (AVX2, 8 lanes), using the operators and the functions
+  of this namespace. `F8` is only available when libresin is compiled with `RESIN_ENABLE_AVX2`.
+
+  Internal header of libresin, the availability of the wrappers depends on the flags libresin is compiled with.
+*/
+namespace resin::simd {
+
+inline float min(float a, float b) { return a < b ? a : b; }
+inline float max(float a, float b) { return a > b ? a : b; }
+inline float abs(float a) { return std::fabs(a); }
+inline float sqrt(float a) { return std::sqrt(a); }
+
+#ifdef RESIN_SIMD_SSE
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define RESIN_SHUFFLE(z, y, x, w) (((z) << 6) | ((y) << 4) | ((x) << 2) | (w))
+
+struct F4 {
+  __m128 v;
+  F4() = default;  // uninitialized, like a float
+  explicit F4(__m128 x) : v(x) {}
+  explicit F4(float x) : v(_mm_set1_ps(x)) {}
+};
+inline F4 operator+(const F4& a, const F4& b) { return F4(_mm_add_ps(a.v, b.v)); }
+inline F4 operator-(const F4& a, const F4& b) { return F4(_mm_sub_ps(a.v, b.v)); }
+inline F4 operator*(const F4& a, const F4& b) { return F4(_mm_mul_ps(a.v, b.v)); }
+inline F4 operator/(const F4& a, const F4& b) { return F4(_mm_div_ps(a.v, b.v)); }
+inline F4 operator-(const F4& a) { return F4(_mm_xor_ps(a.v, _mm_set1_ps(-0.0F))); }
+inline F4 min(const F4& a, const F4& b) { return F4(_mm_min_ps(a.v, b.v)); }
+inline F4 max(const F4& a, const F4& b) { return F4(_mm_max_ps(a.v, b.v)); }
+inline F4 abs(const F4& a) { return F4(_mm_andnot_ps(_mm_set1_ps(-0.0F), a.v)); }
+inline F4 sqrt(const F4& a) { return F4(_mm_sqrt_ps(a.v)); }
+
+inline void transpose4(__m128& a, __m128& b, __m128& c, __m128& d) {
+  const __m128 t0 = _mm_unpacklo_ps(a, b);  // a0 b0 a1 b1
+  const __m128 t1 = _mm_unpackhi_ps(a, b);  // a2 b2 a3 b3
+  const __m128 t2 = _mm_unpacklo_ps(c, d);  // c0 d0 c1 d1
+  const __m128 t3 = _mm_unpackhi_ps(c, d);  // c2 d2 c3 d3
+  a               = _mm_movelh_ps(t0, t2);
+  b               = _mm_movehl_ps(t2, t0);
+  c               = _mm_movelh_ps(t1, t3);
+  d               = _mm_movehl_ps(t3, t1);
+}
+
+// Deinterleaves 4 consecutive vec3s (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) into x, y and z lanes.
+inline void load_vec3_lanes(const glm::vec3* src, F4 (&out)[3]) {
+  const float* f = &src->x;
+  const __m128 a = _mm_loadu_ps(f);
+  const __m128 b = _mm_loadu_ps(f + 4);
+  const __m128 c = _mm_loadu_ps(f + 8);
+
+  out[0] = F4(_mm_shuffle_ps(a, _mm_shuffle_ps(b, c, RESIN_SHUFFLE(1, 1, 2, 2)), RESIN_SHUFFLE(2, 0, 3, 0)));
+  out[1] = F4(_mm_shuffle_ps(_mm_shuffle_ps(a, b, RESIN_SHUFFLE(0, 0, 1, 1)),
+                             _mm_shuffle_ps(b, c, RESIN_SHUFFLE(2, 2, 3, 3)), RESIN_SHUFFLE(2, 0, 2, 0)));
+  out[2] = F4(_mm_shuffle_ps(_mm_shuffle_ps(a, b, RESIN_SHUFFLE(1, 1, 2, 2)), c, RESIN_SHUFFLE(3, 0, 2, 0)));
+}
+
+inline void store_lanes(const F4& lanes, float* dst) { _mm_storeu_ps(dst, lanes.v); }
+#endif  // RESIN_SIMD_SSE
+
+#ifdef RESIN_SIMD_AVX2
+/*
+  The lower 128-bit lane holds the elements 0-3 and the upper one the elements 4-7, so that the shuffles and transposes
+  of the SSE kernels can be reused per lane.
+*/
+struct F8 {
+  __m256 v;
+  F8() = default;  // uninitialized, like a float
+  explicit F8(__m256 x) : v(x) {}
+  explicit F8(float x) : v(_mm256_set1_ps(x)) {}
+};
+inline F8 operator+(const F8& a, const F8& b) { return F8(_mm256_add_ps(a.v, b.v)); }
+inline F8 operator-(const F8& a, const F8& b) { return F8(_mm256_sub_ps(a.v, b.v)); }
+inline F8 operator*(const F8& a, const F8& b) { return F8(_mm256_mul_ps(a.v, b.v)); }
+inline F8 operator/(const F8& a, const F8& b) { return F8(_mm256_div_ps(a.v, b.v)); }
+inline F8 operator-(const F8& a) { return F8(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0F))); }
+inline F8 min(const F8& a, const F8& b) { return F8(_mm256_min_ps(a.v, b.v)); }
+inline F8 max(const F8& a, const F8& b) { return F8(_mm256_max_ps(a.v, b.v)); }
+inline F8 abs(const F8& a) { return F8(_mm256_andnot_ps(_mm256_set1_ps(-0.0F), a.v)); }
+inline F8 sqrt(const F8& a) { return F8(_mm256_sqrt_ps(a.v)); }
+
+inline __m256 combine(__m128 lo, __m128 hi) { return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1); }
+
+inline void transpose4(__m256& a, __m256& b, __m256& c, __m256& d) {
+  const __m256 t0 = _mm256_unpacklo_ps(a, b);
+  const __m256 t1 = _mm256_unpackhi_ps(a, b);
+  const __m256 t2 = _mm256_unpacklo_ps(c, d);
+  const __m256 t3 = _mm256_unpackhi_ps(c, d);
+  a               = _mm256_shuffle_ps(t0, t2, RESIN_SHUFFLE(1, 0, 1, 0));
+  b               = _mm256_shuffle_ps(t0, t2, RESIN_SHUFFLE(3, 2, 3, 2));
+  c               = _mm256_shuffle_ps(t1, t3, RESIN_SHUFFLE(1, 0, 1, 0));
+  d               = _mm256_shuffle_ps(t1, t3, RESIN_SHUFFLE(3, 2, 3, 2));
+}
+
+inline void load_vec3_lanes(const glm::vec3* src, F8 (&out)[3]) {
+  const float* f = &src->x;
+  const __m256 a = combine(_mm_loadu_ps(f), _mm_loadu_ps(f + 12));
+  const __m256 b = combine(_mm_loadu_ps(f + 4), _mm_loadu_ps(f + 16));
+  const __m256 c = combine(_mm_loadu_ps(f + 8), _mm_loadu_ps(f + 20));
+
+  out[0] = F8(_mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, RESIN_SHUFFLE(1, 1, 2, 2)), RESIN_SHUFFLE(2, 0, 3, 0)));
+  out[1] = F8(_mm256_shuffle_ps(_mm256_shuffle_ps(a, b, RESIN_SHUFFLE(0, 0, 1, 1)),
+                                _mm256_shuffle_ps(b, c, RESIN_SHUFFLE(2, 2, 3, 3)), RESIN_SHUFFLE(2, 0, 2, 0)));
+  out[2] = F8(_mm256_shuffle_ps(_mm256_shuffle_ps(a, b, RESIN_SHUFFLE(1, 1, 2, 2)), c, RESIN_SHUFFLE(3, 0, 2, 0)));
+}
+
+inline void store_lanes(const F8& lanes, float* dst) { _mm256_storeu_ps(dst, lanes.v); }
+#endif  // RESIN_SIMD_AVX2
+
+}  // namespace resin::simd
+#endif  // RESIN_SIMD_HPP
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <libresin/utils/timing_stats.hpp>
+#include <numeric>
+
+namespace resin {
+
+void TimingStats::record(std::chrono::nanoseconds duration) {
+  samples_[next_] = duration;
+  next_           = (next_ + 1) % kCapacity;
+  count_          = std::min(count_ + 1, kCapacity);
+}
+
+TimingSummary TimingStats::summarize() {
+  if (count_ == 0) {
+    return {};
+  }
+
+  // Before the window fills up the samples are at its start, afterwards all of them are used
+  const auto sorted_end = std::copy_n(samples_.begin(), count_, sorted_.begin());
+  std::sort(sorted_.begin(), sorted_end);
+
+  const auto percentile = [this](size_t percent) { return sorted_[(count_ * percent + 99) / 100 - 1]; };
+  const auto total      = std::accumulate(sorted_.begin(), sorted_end, std::chrono::nanoseconds(0));
+
+  return {
+      .count = count_,
+      .mean  = total / static_cast<std::chrono::nanoseconds::rep>(count_),
+      .p50   = percentile(50),
+      .p95   = percentile(95),
+      .p99   = percentile(99),
+      .max   = sorted_[count_ - 1],
+  };
+}
+
+}  // namespace resin
@@ -0,0 +1,48 @@
+#ifndef RESIN_TIMING_STATS_HPP
+#define RESIN_TIMING_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace resin {
+
+struct TimingSummary {
+  size_t count = 0;
+  std::chrono::nanoseconds mean{0};
+  std::chrono::nanoseconds p50{0};
+  std::chrono::nanoseconds p95{0};
+  std::chrono::nanoseconds p99{0};
+  std::chrono::nanoseconds max{0};
+
+  bool operator==(const TimingSummary&) const = default;
+};
+
+/*
+  Collects the durations of a repeated operation (a frame, a tick) in a window of the most recent `kCapacity` samples
+  and summarizes their distribution. The storage is fixed, so neither recording nor summarizing allocates.
+*/
+class TimingStats {
+ public:
+  static constexpr size_t kCapacity = 1024;
+
+  void record(std::chrono::nanoseconds duration);
+  // Percentiles use the nearest-rank method over the samples recorded since the previous `reset`.
+  TimingSummary summarize();
+  void reset() {
+    count_ = 0;
+    next_  = 0;
+  }
+
+  size_t count() const { return count_; }
+
+ private:
+  std::array<std::chrono::nanoseconds, kCapacity> samples_{};
+  // Samples sorted by `summarize`, so that the order of `samples_` is kept
+  std::array<std::chrono::nanoseconds, kCapacity> sorted_{};
+  size_t count_ = 0;
+  size_t next_  = 0;
+};
+
+}  // namespace resin
+#endif  // RESIN_TIMING_STATS_HPP
@@ -0,0 +1,63 @@
+#ifndef RESIN_TRIPLE_BUFFER_HPP
+#define RESIN_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace resin {
+
+/*
+  Lock-free hand-off of the latest state from a single producer thread to a single consumer thread. The producer writes
+  into its own buffer and publishes it by swapping it with the middle one, the consumer takes the middle buffer in the
+  same way, so neither of them ever waits and the consumer always reads the newest published state. States published
+  in the meantime are skipped.
+
+  The buffer returned by `write_buffer` holds an older state, the producer has to overwrite all of it.
+*/
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  explicit TripleBuffer(const T& initial) : slots_{Slot{initial}, Slot{initial}, Slot{initial}} {}
+
+  TripleBuffer(const TripleBuffer&)            = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Producer only.
+  T& write_buffer() { return slots_[back_].value; }
+
+  // Producer only. Makes the write buffer the newest state.
+  void publish() { back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+
+  // Consumer only. Takes the newest state if there is one since the previous call and returns whether there was.
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  // Consumer only.
+  const T& read_buffer() const { return slots_[front_].value; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr uint8_t kIndexMask    = 0b011;
+  static constexpr uint8_t kFresh        = 0b100;  // the middle buffer holds a state the consumer has not taken yet
+
+  // Slots on separate cache lines, so that writing one does not slow down reading another
+  struct alignas(kCacheLineSize) Slot {
+    T value{};
+  };
+
+  std::array<Slot, 3> slots_;
+  alignas(kCacheLineSize) uint8_t back_                = 0;
+  alignas(kCacheLineSize) std::atomic<uint8_t> middle_ = 1;
+  alignas(kCacheLineSize) uint8_t front_               = 2;
+};
+
+}  // namespace resin
+#endif  // RESIN_TRIPLE_BUFFER_HPP
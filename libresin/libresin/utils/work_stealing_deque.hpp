@@ -0,0 +1,116 @@
+#ifndef RESIN_WORK_STEALING_DEQUE_HPP
+#define RESIN_WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace resin {
+
+/*
+  Bounded, lock-free work-stealing deque (the Chase-Lev deque with the memory orderings of Le et al., "Correct and
+  Efficient Work-Stealing for Weak Memory Models"). The owner thread pushes and pops at the bottom in LIFO order, which
+  keeps the recently produced work hot in its cache, while any other thread steals from the top in FIFO order, taking
+  the oldest and usually the biggest pieces of work. Only the owner and the thieves racing for the last element
+  contend, on the `top_` counter.
+
+  The capacity is rounded up to a power of two and `push` fails when the deque is full instead of growing, so nothing
+  is allocated after construction.
+*/
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque elements must be trivially copyable");
+
+ public:
+  explicit WorkStealingDeque(size_t capacity) : capacity_(std::bit_ceil(capacity)), mask_(capacity_ - 1) {
+    if (capacity == 0) {
+      throw std::invalid_argument("WorkStealingDeque: capacity must be greater than 0");
+    }
+
+    cells_ = std::make_unique<std::atomic<T>[]>(capacity_);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&)            = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Owner only.
+  bool push(T value) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top    = top_.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(capacity_)) {
+      return false;  // full
+    }
+
+    cells_[index(bottom)].store(value, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only.
+  std::optional<T> pop() {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    // Sequentially consistent, so that a thief either sees the smaller bottom or the owner sees its increased top
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return std::nullopt;  // empty
+    }
+
+    std::optional<T> value = cells_[index(bottom)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // The last element, which a thief may be taking at the same time
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        value.reset();
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+  // Any thread.
+  std::optional<T> steal() {
+    int64_t top          = top_.load(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+      return std::nullopt;  // empty
+    }
+
+    const T value = cells_[index(top)].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return std::nullopt;  // lost the race to the owner or another thief
+    }
+    return value;
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // Only a hint when other threads are pushing or stealing at the same time.
+  size_t size_approx() const {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top    = top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+  bool empty_approx() const { return size_approx() == 0; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  size_t index(int64_t position) const { return static_cast<size_t>(position) & mask_; }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<std::atomic<T>[]> cells_;
+
+  alignas(kCacheLineSize) std::atomic<int64_t> top_ = 0;
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_ = 0;
+};
+
+}  // namespace resin
+#endif  // RESIN_WORK_STEALING_DEQUE_HPP
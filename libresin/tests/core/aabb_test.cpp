@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/aabb.hpp>
+#include <libresin/core/transform.hpp>
+#include <limits>
+#include <tests/glm_helper.hpp>
+
+TEST(AabbTest, DefaultIsEmptyUntilExpanded) {
+  // given
+  resin::Aabb aabb;
+  EXPECT_TRUE(aabb.empty());
+
+  // when
+  aabb.expand(glm::vec3(1, 2, 3));
+  aabb.expand(glm::vec3(-1, 0, 5));
+
+  // then
+  EXPECT_FALSE(aabb.empty());
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-1, 0, 3), aabb.min, 1e-6F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(1, 2, 5), aabb.max, 1e-6F);
+  EXPECT_TRUE(aabb.contains(glm::vec3(0, 1, 4)));
+  EXPECT_FALSE(aabb.contains(glm::vec3(0, 1, 6)));
+}
+
+TEST(AabbTest, DistanceAndIntersection) {
+  // given
+  const resin::Aabb a(glm::vec3(0), glm::vec3(1));
+  const resin::Aabb b(glm::vec3(4, 5, 0.5F), glm::vec3(6, 7, 2));
+  const resin::Aabb c(glm::vec3(0.5F), glm::vec3(2));
+
+  // when / then
+  EXPECT_FALSE(a.intersects(b));
+  EXPECT_NEAR(a.distance(b), 5.0F, 1e-6F);
+  EXPECT_NEAR(b.distance(a), 5.0F, 1e-6F);
+  EXPECT_TRUE(a.intersects(c));
+  EXPECT_EQ(a.distance(c), 0.0F);
+}
+
+TEST(AabbTest, TransformedContainsTransformedCorners) {
+  // given
+  const resin::Aabb aabb(glm::vec3(-1, -2, -3), glm::vec3(1, 2, 3));
+  const resin::Transform transform(glm::vec3(5, 0, 0), glm::angleAxis(0.7F, glm::normalize(glm::vec3(1, 1, 0))),
+                                   glm::vec3(2, 1, 0.5F));
+  const glm::mat4 matrix = transform.local_to_world_matrix();
+
+  // when
+  const resin::Aabb result = aabb.transformed(matrix);
+
+  // then
+  for (int i = 0; i < 8; ++i) {
+    const glm::vec3 corner((i & 1) != 0 ? aabb.max.x : aabb.min.x, (i & 2) != 0 ? aabb.max.y : aabb.min.y,
+                           (i & 4) != 0 ? aabb.max.z : aabb.min.z);
+    const glm::vec3 transformed = glm::vec3(matrix * glm::vec4(corner, 1.0F));
+    EXPECT_TRUE(resin::Aabb(result.min - 1e-4F, result.max + 1e-4F).contains(transformed));
+  }
+}
+
+TEST(AabbTest, ClipRay) {
+  // given
+  const resin::Aabb aabb(glm::vec3(1, -1, -1), glm::vec3(3, 1, 1));
+  const glm::vec3 origin(0, 0, 0);
+
+  // when
+  float near_hit = 0.0F;
+  float far_hit  = std::numeric_limits<float>::infinity();
+  const bool hit = aabb.clip_ray(origin, 1.0F / glm::vec3(1, 0, 0), near_hit, far_hit);
+
+  float near_miss = 0.0F;
+  float far_miss  = std::numeric_limits<float>::infinity();
+  const bool miss = aabb.clip_ray(origin, 1.0F / glm::vec3(-1, 0, 0), near_miss, far_miss);
+
+  float near_short     = 0.0F;
+  float far_short      = 0.5F;
+  const bool too_short = aabb.clip_ray(origin, 1.0F / glm::vec3(1, 0, 0), near_short, far_short);
+
+  // then
+  EXPECT_TRUE(hit);
+  EXPECT_NEAR(near_hit, 1.0F, 1e-6F);
+  EXPECT_NEAR(far_hit, 3.0F, 1e-6F);
+  EXPECT_FALSE(miss);
+  EXPECT_FALSE(too_short);
+}
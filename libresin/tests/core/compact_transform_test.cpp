@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/compact_transform.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/core/transform_hierarchy.hpp>
+#include <random>
+#include <stdexcept>
+#include <tests/glm_helper.hpp>
+
+static_assert(sizeof(resin::CompactTransform) == 24);
+static_assert(sizeof(resin::AffineMatrix) == 48);
+
+constexpr float kPi = glm::pi<float>();
+
+TEST(CompactTransformTest, PackedQuaternionsRoundTrip) {
+  // given
+  std::mt19937 gen(42);  // NOLINT
+  std::uniform_real_distribution<float> comp(-1.0F, 1.0F);
+
+  for (int i = 0; i < 1000; ++i) {
+    const glm::quat rot = glm::normalize(glm::quat(comp(gen), comp(gen), comp(gen), comp(gen)));
+
+    // when
+    const glm::quat unpacked = resin::unpack_quat(resin::pack_quat(rot));
+
+    // then
+    // q and -q are the same rotation
+    EXPECT_NEAR(1.0F, std::abs(glm::dot(rot, unpacked)), 1e-5F);
+    EXPECT_GLM_VEC_NEAR(rot * glm::vec3(1, 2, 3), unpacked * glm::vec3(1, 2, 3), 1e-3F);
+  }
+}
+
+TEST(CompactTransformTest, AxisAlignedQuaternionsRoundTrip) {
+  // given
+  const std::array<glm::quat, 5> rotations = {glm::quat(1, 0, 0, 0), glm::quat(0, 1, 0, 0), glm::quat(0, 0, -1, 0),
+                                              glm::quat(0, 0, 0, 1), glm::quat(glm::vec3(0, kPi / 2, 0))};
+
+  for (const glm::quat& rot : rotations) {
+    // when
+    const glm::quat unpacked = resin::unpack_quat(resin::pack_quat(rot));
+
+    // then
+    EXPECT_NEAR(1.0F, std::abs(glm::dot(rot, unpacked)), 1e-5F);
+  }
+}
+
+TEST(CompactTransformTest, ComponentsAreRestored) {
+  // given
+  const glm::vec3 pos(1.5F, -2.25F, 1000.125F);
+  const glm::quat rot(glm::vec3(0.3F, kPi / 2, -1.0F));
+  const glm::vec3 scale(1, 2, 0.5F);
+
+  // when
+  const resin::CompactTransform transform(pos, rot, scale);
+
+  // then
+  EXPECT_GLM_VEC_NEAR(pos, transform.local_pos(), 1e-6F);
+  EXPECT_NEAR(1.0F, std::abs(glm::dot(rot, transform.local_rot())), 1e-5F);
+  EXPECT_GLM_VEC_NEAR(scale, transform.local_scale(), 1e-6F);
+}
+
+TEST(CompactTransformTest, MatricesMatchTransform) {
+  // given
+  resin::Transform transform(glm::vec3(1, 2, 3), glm::quat(glm::vec3(0.5F, kPi / 3, 0)), glm::vec3(1, 2, 3));
+
+  // when
+  const resin::CompactTransform compact(transform);
+
+  // then
+  EXPECT_GLM_MAT_NEAR(transform.local_to_parent_matrix(), compact.local_to_parent_matrix(), 1e-3F);
+  EXPECT_GLM_MAT_NEAR(transform.local_to_parent_matrix(), compact.local_to_parent_affine().to_mat4(), 1e-3F);
+}
+
+TEST(CompactTransformTest, AffineMatricesMatchFullMatrices) {
+  // given
+  const resin::CompactTransform first(glm::vec3(1, 2, 3), glm::quat(glm::vec3(0, 1, 0)));
+  const resin::CompactTransform second(glm::vec3(-4, 0, 1), glm::quat(glm::vec3(1, 0, 0)), glm::vec3(2));
+  const glm::mat4 a = first.local_to_parent_matrix();
+  const glm::mat4 b = second.local_to_parent_matrix();
+
+  // when
+  const resin::AffineMatrix product = resin::AffineMatrix(a) * resin::AffineMatrix(b);
+
+  // then
+  EXPECT_GLM_MAT_NEAR(a * b, product.to_mat4(), 1e-5F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(a * glm::vec4(5, 6, 7, 1)), resin::AffineMatrix(a).transform_point(glm::vec3(5, 6, 7)),
+                      1e-5F);
+}
+
+TEST(CompactTransformTest, ArrayWorldMatricesMatchHierarchy) {
+  // given
+  resin::TransformHierarchy hierarchy;
+  resin::Transform root(hierarchy, glm::vec3(1, 2, 3), glm::quat(glm::vec3(0, kPi / 2, 0)), glm::vec3(1, 2, 3));
+  resin::Transform child(hierarchy, glm::vec3(0, 1, 0), glm::quat(glm::vec3(kPi / 4, 0, 0)));
+  resin::Transform leaf(hierarchy, glm::vec3(5, 0, 0), glm::quat(), glm::vec3(0.5F));
+  resin::Transform second(hierarchy, glm::vec3(-1, 0, 0));
+  leaf.set_parent(child);
+  child.set_parent(root);
+  second.set_parent(root);
+  hierarchy.update();
+
+  resin::CompactTransformArray array;
+
+  // when
+  array.assign(hierarchy);
+  array.update();
+
+  // then
+  ASSERT_EQ(hierarchy.size(), array.size());
+  for (const resin::Transform* transform : {&root, &child, &leaf, &second}) {
+    const uint32_t slot = hierarchy.slot(transform->id());
+    EXPECT_GLM_MAT_NEAR(transform->local_to_world_matrix(), array.local_to_world_matrix(slot), 1e-3F);
+  }
+}
+
+TEST(CompactTransformTest, ArrayRequiresParentsFirst) {
+  // given
+  resin::CompactTransformArray array;
+  const uint32_t root = array.push_back(resin::CompactTransform(glm::vec3(1, 0, 0)));
+
+  // when
+  const uint32_t child = array.push_back(resin::CompactTransform(glm::vec3(0, 1, 0)), root);
+  array.update();
+
+  // then
+  EXPECT_GLM_VEC_NEAR(glm::vec3(1, 1, 0), array.world_matrices()[child].transform_point(glm::vec3()), 1e-6F);
+  EXPECT_THROW(array.push_back(resin::CompactTransform(), 5), std::invalid_argument);
+}
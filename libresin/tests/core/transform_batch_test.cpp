@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/transform.hpp>
+#include <libresin/core/transform_batch.hpp>
+#include <random>
+#include <stdexcept>
+#include <tests/glm_helper.hpp>
+#include <vector>
+
+namespace {
+
+glm::mat4 reference_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale) {
+  return glm::translate(pos) * glm::mat4_cast(rot) * glm::scale(scale);
+}
+
+glm::mat4 reference_inverse_trs(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scale) {
+  return glm::scale(1.0F / scale) * glm::mat4_cast(glm::inverse(rot)) * glm::translate(-pos);
+}
+
+}  // namespace
+
+class TransformBatchTest : public testing::Test {
+ protected:
+  // Odd count, so that every kernel (8-wide, 4-wide and scalar) gets exercised
+  static constexpr size_t kCount = 37;
+
+  TransformBatchTest() {
+    std::mt19937 gen(42);  // NOLINT
+    std::uniform_real_distribution<float> coord(-10.0F, 10.0F);
+    std::uniform_real_distribution<float> angle(-3.0F, 3.0F);
+    std::uniform_real_distribution<float> scale(0.25F, 4.0F);
+
+    for (size_t i = 0; i < kCount; ++i) {
+      pos_.emplace_back(coord(gen), coord(gen), coord(gen));
+      rot_.emplace_back(glm::vec3(angle(gen), angle(gen), angle(gen)));
+      scale_.emplace_back(scale(gen), scale(gen), scale(gen));
+    }
+  }
+
+  std::vector<glm::vec3> pos_;
+  std::vector<glm::quat> rot_;
+  std::vector<glm::vec3> scale_;
+};
+
+TEST_F(TransformBatchTest, ComposeMatchesReference) {
+  // given
+  std::vector<glm::mat4> out(kCount);
+
+  // when
+  resin::compose_trs(pos_, rot_, scale_, out);
+
+  // then
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_GLM_MAT_NEAR(reference_trs(pos_[i], rot_[i], scale_[i]), out[i], 1e-4F);
+    EXPECT_GLM_MAT_NEAR(reference_trs(pos_[i], rot_[i], scale_[i]), resin::compose_trs(pos_[i], rot_[i], scale_[i]),
+                        1e-4F);
+  }
+}
+
+TEST_F(TransformBatchTest, InverseComposeMatchesReference) {
+  // given
+  std::vector<glm::mat4> out(kCount);
+
+  // when
+  resin::compose_inverse_trs(pos_, rot_, scale_, out);
+
+  // then
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_GLM_MAT_NEAR(reference_inverse_trs(pos_[i], rot_[i], scale_[i]), out[i], 1e-4F);
+  }
+}
+
+TEST_F(TransformBatchTest, ComposeAndInverseComposeAreInverses) {
+  // given
+  std::vector<glm::mat4> matrices(kCount);
+  std::vector<glm::mat4> inverses(kCount);
+
+  // when
+  resin::compose_trs(pos_, rot_, scale_, matrices);
+  resin::compose_inverse_trs(pos_, rot_, scale_, inverses);
+
+  // then
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_GLM_MAT_NEAR(glm::mat4(1.0F), matrices[i] * inverses[i], 1e-4F);
+  }
+}
+
+TEST_F(TransformBatchTest, NonUnitQuaternionsMatchReference) {
+  // given
+  const std::vector<glm::vec3> pos(9, glm::vec3(1, 2, 3));
+  const std::vector<glm::quat> rot(9, glm::quat(4, 5, 6, 7));
+  const std::vector<glm::vec3> scale(9, glm::vec3(8, 9, 10));
+  std::vector<glm::mat4> out(9);
+  std::vector<glm::mat4> inv_out(9);
+
+  // when
+  resin::compose_trs(pos, rot, scale, out);
+  resin::compose_inverse_trs(pos, rot, scale, inv_out);
+
+  // then
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_GLM_MAT_NEAR(reference_trs(pos[i], rot[i], scale[i]), out[i], 1e-3F);
+    EXPECT_GLM_MAT_NEAR(reference_inverse_trs(pos[i], rot[i], scale[i]), inv_out[i], 1e-4F);
+  }
+}
+
+TEST_F(TransformBatchTest, MismatchedSpansThrow) {
+  // given
+  std::vector<glm::mat4> out(kCount - 1);
+
+  // when / then
+  EXPECT_THROW(resin::compose_trs(pos_, rot_, scale_, out), std::invalid_argument);
+}
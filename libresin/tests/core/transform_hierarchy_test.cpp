@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/transform.hpp>
+#include <libresin/core/transform_hierarchy.hpp>
+#include <memory>
+#include <stdexcept>
+#include <tests/glm_helper.hpp>
+
+constexpr float kPi = glm::pi<float>();
+
+class TransformHierarchyTest : public testing::Test {
+ protected:
+  TransformHierarchyTest()
+      : parent_transform_(hierarchy_, glm::vec3(1, 2, 3), glm::quat(glm::vec3(0, kPi / 2, 0)), glm::vec3(1, 2, 3)),
+        transform_(hierarchy_) {
+    transform_.set_parent(parent_transform_);
+  }
+
+  resin::TransformHierarchy hierarchy_;
+
+  // at:       1,2,3
+  // rotation: 90deg around Y axis
+  // scale:    1,2,3
+  resin::Transform parent_transform_;
+
+  // at:       0,0,0
+  // rotation: none
+  // scale:    1,1,1
+  resin::Transform transform_;
+};
+
+/**
+ * Defaults
+ */
+
+TEST_F(TransformHierarchyTest, DefaultMatricesAreIdentity) {
+  // given / when
+  const resin::Transform transform(hierarchy_);
+  hierarchy_.update();
+
+  // then
+  EXPECT_EQ(transform.local_to_parent_matrix(), glm::mat4(1));
+  EXPECT_EQ(transform.local_to_world_matrix(), glm::mat4(1));
+  EXPECT_EQ(transform.parent_to_local_matrix(), glm::mat4(1));
+  EXPECT_EQ(transform.world_to_local_matrix(), glm::mat4(1));
+}
+
+/**
+ * Transformations
+ */
+
+TEST_F(TransformHierarchyTest, MatricesAreCalculatedProperly) {
+  // given
+  // calculated on paper
+  const glm::mat4 parent_expected(glm::vec4(0, 0, -1, 0), glm::vec4(0, 2, 0, 0), glm::vec4(3, 0, 0, 0),
+                                  glm::vec4(1, 2, 3, 1));
+  const glm::mat4 expected(glm::vec4(0, 0, -1, 0), glm::vec4(3, 0, 0, 0), glm::vec4(0, -2, 0, 0),
+                           glm::vec4(1, 2, 3, 1));
+
+  // when
+  transform_.set_local_rot(glm::vec3(kPi / 2, 0, 0));
+
+  // then
+  EXPECT_GLM_MAT_NEAR(parent_expected, parent_transform_.local_to_parent_matrix(), 1e-5F);
+  EXPECT_GLM_MAT_NEAR(expected, transform_.local_to_world_matrix(), 1e-5F);
+  hierarchy_.update();
+  EXPECT_GLM_MAT_NEAR(expected, transform_.local_to_world_matrix(), 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, InversesAreCalculatedProperly) {
+  // given
+  glm::mat4 identity(1.0F);
+
+  // when
+  hierarchy_.update();
+
+  // then
+  EXPECT_GLM_MAT_NEAR(identity, parent_transform_.local_to_world_matrix() * parent_transform_.world_to_local_matrix(),
+                      1e-5F);
+  EXPECT_GLM_MAT_NEAR(identity, transform_.local_to_parent_matrix() * transform_.parent_to_local_matrix(), 1e-5F);
+  EXPECT_GLM_MAT_NEAR(identity, transform_.local_to_world_matrix() * transform_.world_to_local_matrix(), 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, PosIsTransformedProperly) {
+  // given
+  const glm::vec3 position(1, 1, 1);
+  glm::vec3 expected(4, 4, 2);
+
+  // when
+  transform_.set_local_pos(position);
+  hierarchy_.update();
+
+  // then
+  EXPECT_GLM_VEC_NEAR(expected, transform_.pos(), 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, RotIsTransformedProperly) {
+  // given
+  const glm::quat rot(glm::vec3(kPi / 2, 0, 0));
+  glm::vec3 axis     = glm::normalize(glm::vec3(1, 1, -1));
+  glm::quat expected = glm::angleAxis(2 * kPi / 3, axis);
+
+  // when
+  transform_.set_local_rot(rot);
+
+  // then
+  EXPECT_GLM_ROT_NEAR(expected, transform_.rot(), 1e-5F);
+}
+
+/**
+ * Hierarchy
+ */
+
+TEST_F(TransformHierarchyTest, UpdateMatchesMatricesResolvedOnTheFly) {
+  // given
+  // create the transforms in reverse order, so that the hierarchy has to be sorted
+  resin::Transform grandchild(hierarchy_, glm::vec3(2, 0, 0), glm::quat(glm::vec3(0.5F, 0.0F, 0.5F)),
+                              glm::vec3(1, 1, 0.5F));
+  resin::Transform child(hierarchy_, glm::vec3(0, 1, 0), glm::quat(glm::vec3(0.0F, 1.0F, 0.0F)), glm::vec3(1, 3, 1));
+  resin::Transform root(hierarchy_, glm::vec3(1, -2, 3), glm::quat(glm::vec3(0.3F, 0.2F, 0.1F)), glm::vec3(2, 1, 1));
+  grandchild.set_parent(child);
+  child.set_parent(root);
+  const glm::mat4 child_expected          = hierarchy_.local_to_world_matrix(child.id());
+  const glm::mat4 grandchild_expected     = hierarchy_.local_to_world_matrix(grandchild.id());
+  const glm::mat4 inv_grandchild_expected = hierarchy_.world_to_local_matrix(grandchild.id());
+
+  // when
+  hierarchy_.update();
+
+  // then
+  EXPECT_GLM_MAT_NEAR(root.local_to_parent_matrix(), root.local_to_world_matrix(), 1e-5F);
+  EXPECT_GLM_MAT_NEAR(child_expected, child.local_to_world_matrix(), 1e-5F);
+  EXPECT_GLM_MAT_NEAR(grandchild_expected, grandchild.local_to_world_matrix(), 1e-5F);
+  EXPECT_GLM_MAT_NEAR(inv_grandchild_expected, grandchild.world_to_local_matrix(), 1e-5F);
+  EXPECT_LT(hierarchy_.slot(root.id()), hierarchy_.slot(child.id()));
+  EXPECT_LT(hierarchy_.slot(child.id()), hierarchy_.slot(grandchild.id()));
+}
+
+TEST_F(TransformHierarchyTest, ReadingTransformUpdatesHierarchy) {
+  // given
+  hierarchy_.update();
+  const uint32_t generation = transform_.generation();
+
+  // when
+  parent_transform_.set_local_pos(glm::vec3(0, 0, 0));
+  EXPECT_TRUE(hierarchy_.needs_update());
+  const glm::vec3 pos = transform_.pos();
+
+  // then
+  EXPECT_FALSE(hierarchy_.needs_update());
+  EXPECT_NE(generation, transform_.generation());
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0, 0, 0), pos, 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, ChangesArePropagatedToSubtree) {
+  // given
+  resin::Transform grandchild(hierarchy_, glm::vec3(1, 0, 0));
+  grandchild.set_parent(transform_);
+  hierarchy_.update();
+
+  // when
+  parent_transform_.set_local_pos(glm::vec3(0, 0, 0));
+  EXPECT_TRUE(hierarchy_.needs_update());
+  hierarchy_.update();
+
+  // then
+  EXPECT_FALSE(hierarchy_.needs_update());
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0, 0, -1), grandchild.pos(), 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, DestroyDetachesChildren) {
+  // given
+  auto child = std::make_unique<resin::Transform>(hierarchy_);
+  resin::Transform grandchild(hierarchy_, glm::vec3(1, 0, 0));
+  child->set_parent(transform_);
+  grandchild.set_parent(*child);
+  const auto child_id = child->id();
+
+  // when
+  child.reset();
+  hierarchy_.update();
+
+  // then
+  EXPECT_FALSE(hierarchy_.contains(child_id));
+  EXPECT_FALSE(grandchild.has_parent());
+  EXPECT_EQ(hierarchy_.size(), 3U);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(1, 0, 0), grandchild.pos(), 1e-5F);
+}
+
+TEST_F(TransformHierarchyTest, ParentingToDescendantThrows) {
+  // given / when / then
+  EXPECT_THROW(parent_transform_.set_parent(transform_), std::invalid_argument);
+  EXPECT_THROW(transform_.set_parent(transform_), std::invalid_argument);
+}
+
+TEST_F(TransformHierarchyTest, ParentingToAnotherHierarchyThrows) {
+  // given
+  resin::TransformHierarchy other;
+  resin::Transform parent(other);
+
+  // when / then
+  EXPECT_THROW(transform_.set_parent(parent), std::invalid_argument);
+}
+
+TEST_F(TransformHierarchyTest, DefaultTransformsShareHierarchy) {
+  // given / when
+  const resin::Transform first;
+  const resin::Transform second;
+
+  // then
+  EXPECT_EQ(&first.hierarchy(), &resin::TransformHierarchy::default_instance());
+  EXPECT_EQ(&second.hierarchy(), &first.hierarchy());
+}
@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <chrono>
+#include <iostream>
 #include <libresin/core/transform.hpp>
-#include <print>
+#include <memory>
 #include <tests/glm_helper.hpp>
+#include <thread>
+#include <vector>
 
 constexpr float kPi = glm::pi<float>();
 
@@ -156,4 +161,181 @@ TEST_F(TransformTest, RotIsTransformedProperly) {
 
   // then
   EXPECT_GLM_ROT_NEAR(expected, transform_.rot(), 1e-5F);
-}
\ No newline at end of file
+}
+
+/**
+ * Hierarchy
+ */
+
+TEST_F(TransformTest, ReparentMovesAllTransforms) {
+  // given
+  resin::Transform new_parent(glm::vec3(0, 0, 5));
+  resin::Transform first;
+  resin::Transform second;
+  first.set_parent(transform_);
+  second.set_parent(transform_);
+  std::array<resin::Transform*, 2> transforms = {&first, &second};
+
+  // when
+  resin::Transform::reparent(transforms, new_parent);
+
+  // then
+  EXPECT_EQ(&first.parent(), &new_parent);
+  EXPECT_EQ(&second.parent(), &new_parent);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0, 0, 5), first.pos(), 1e-5F);
+}
+
+TEST_F(TransformTest, DestroyingParentDetachesChildren) {
+  // given
+  resin::Transform child(glm::vec3(1, 0, 0));
+  {
+    resin::Transform parent(glm::vec3(0, 5, 0));
+    child.set_parent(parent);
+    EXPECT_GLM_VEC_NEAR(glm::vec3(1, 5, 0), child.pos(), 1e-5F);
+  }
+
+  // when / then
+  EXPECT_FALSE(child.has_parent());
+  EXPECT_GLM_MAT_NEAR(child.local_to_parent_matrix(), child.local_to_world_matrix(), 1e-5F);
+}
+
+TEST_F(TransformTest, WideHierarchyKeepsChildrenLinked) {
+  // given
+  constexpr size_t kChildren = 1'000;
+  resin::Transform old_parent;
+  resin::Transform new_parent(glm::vec3(0, 0, 5));
+  std::vector<std::unique_ptr<resin::Transform>> children;
+  for (size_t i = 0; i < kChildren; ++i) {
+    children.push_back(std::make_unique<resin::Transform>());
+    children.back()->set_parent(old_parent);
+  }
+
+  // when
+  // Destroys the first, the last and every third child in between, which unlinks them from all positions of the list
+  for (size_t i = 0; i < kChildren; i += 3) {
+    children[i].reset();
+  }
+  children.back().reset();
+  std::erase(children, nullptr);
+  std::vector<resin::Transform*> pointers;
+  for (const auto& child : children) {
+    pointers.push_back(child.get());
+  }
+  resin::Transform::reparent(pointers, new_parent);
+
+  // then
+  std::vector<uint32_t> generations;
+  for (const auto& child : children) {
+    EXPECT_EQ(&child->parent(), &new_parent);
+    EXPECT_GLM_VEC_NEAR(glm::vec3(0, 0, 5), glm::vec3(child->local_to_world_matrix()[3]), 1e-5F);
+    generations.push_back(child->generation());
+  }
+
+  // Moving the parent reaches every child through the list, the old parent does not reach any
+  new_parent.set_local_pos(glm::vec3(1, 0, 0));
+  for (size_t i = 0; i < children.size(); ++i) {
+    EXPECT_NE(children[i]->generation(), generations[i]);
+    EXPECT_GLM_VEC_NEAR(glm::vec3(1, 0, 0), children[i]->pos(), 1e-5F);
+  }
+  old_parent.set_local_pos(glm::vec3(0, 3, 0));
+  EXPECT_GLM_VEC_NEAR(glm::vec3(1, 0, 0), children.front()->pos(), 1e-5F);
+}
+
+// Not run by default, the timings are only reported: --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(TransformTest, DISABLED_WideHierarchyBenchmark) {
+  // given
+  constexpr size_t kChildren = 100'000;
+  resin::Transform old_parent;
+  resin::Transform new_parent(glm::vec3(0, 0, 5));
+  std::vector<std::unique_ptr<resin::Transform>> children;
+  for (size_t i = 0; i < kChildren; ++i) {
+    children.push_back(std::make_unique<resin::Transform>());
+    children.back()->set_parent(old_parent);
+  }
+  const auto elapsed_ms = [](const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  // when
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kChildren; i += 2) {
+    children[i].reset();
+  }
+  const double destroy_ms = elapsed_ms(start);
+  std::erase(children, nullptr);
+
+  std::vector<resin::Transform*> pointers;
+  for (const auto& child : children) {
+    pointers.push_back(child.get());
+  }
+  start = std::chrono::steady_clock::now();
+  resin::Transform::reparent(pointers, new_parent);
+  const double reparent_ms = elapsed_ms(start);
+
+  start = std::chrono::steady_clock::now();
+  const glm::vec3 pos    = children.front()->pos();
+  const double update_ms = elapsed_ms(start);
+
+  // then
+  std::cout << "destroyed " << kChildren / 2 << " children in " << destroy_ms << " ms, reparented "
+            << children.size() << " in " << reparent_ms << " ms, updated in " << update_ms << " ms\n";
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0, 0, 5), pos, 1e-5F);
+}
+
+/**
+ * Concurrency
+ */
+
+TEST_F(TransformTest, WorldMatricesCanBeResolvedConcurrently) {
+  // given
+  constexpr size_t kChildren = 64;
+  constexpr size_t kThreads  = 8;
+  std::vector<std::unique_ptr<resin::Transform>> children;
+  for (size_t i = 0; i < kChildren; ++i) {
+    children.push_back(std::make_unique<resin::Transform>(glm::vec3(static_cast<float>(i), 0, 0)));
+    children.back()->set_parent(transform_);
+  }
+  transform_.set_local_pos(glm::vec3(0, 1, 0));
+
+  std::vector<glm::mat4> expected;
+  for (const auto& child : children) {
+    expected.push_back(parent_transform_.local_to_parent_matrix() * transform_.local_to_parent_matrix() *
+                       child->local_to_parent_matrix());
+  }
+
+  // when
+  std::vector<std::vector<glm::mat4>> results(kThreads);
+  {
+    std::vector<std::jthread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&children, &result = results[t]] {
+        for (const auto& child : children) {
+          result.push_back(child->local_to_world_matrix() * child->world_to_local_matrix());
+          result.push_back(child->local_to_world_matrix());
+        }
+      });
+    }
+  }
+
+  // then
+  for (const auto& result : results) {
+    for (size_t i = 0; i < kChildren; ++i) {
+      EXPECT_GLM_MAT_NEAR(glm::mat4(1.0F), result[2 * i], 1e-4F);
+      EXPECT_GLM_MAT_NEAR(expected[i], result[2 * i + 1], 1e-4F);
+    }
+  }
+}
+
+TEST_F(TransformTest, GenerationChangesWhenAncestorChanges) {
+  // given
+  resin::Transform child;
+  child.set_parent(transform_);
+  static_cast<void>(child.local_to_world_matrix());
+  const uint32_t generation = child.generation();
+
+  // when
+  parent_transform_.set_local_pos(glm::vec3(0, 0, 0));
+
+  // then
+  EXPECT_NE(generation, child.generation());
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <libresin/core/aabb.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_brick_cache.hpp>
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <libresin/utils/job_system.hpp>
+#include <optional>
+#include <stdexcept>
+#include <tests/transform_helper.hpp>
+#include <vector>
+
+class SdfBrickCacheTest : public testing::Test {
+ protected:
+  // Points of a regular grid over the region
+  static std::vector<glm::vec3> grid_points(const resin::Aabb& region, const float step) {
+    std::vector<glm::vec3> points;
+    for (float z = region.min.z; z <= region.max.z; z += step) {
+      for (float y = region.min.y; y <= region.max.y; y += step) {
+        for (float x = region.min.x; x <= region.max.x; x += step) {
+          points.emplace_back(x, y, z);
+        }
+      }
+    }
+    return points;
+  }
+
+  static constexpr float kVoxelSize = 0.05F;
+  static constexpr float kBand      = 0.15F;
+  // Bricks of the region along every axis, including the ones the region only touches
+  static constexpr size_t kRegionBricks = 12;
+
+  const resin::Aabb region_{glm::vec3(-2.0F), glm::vec3(2.0F)};
+  TransformPool transforms_;
+  resin::SdfTree tree_;
+  resin::JobSystem jobs_{3};
+};
+
+TEST_F(SdfBrickCacheTest, SamplesMatchTheFieldWithinTheBand) {
+  // given
+  tree_.set_root(tree_.create_sphere(transforms_.create(glm::vec3(0.1F, -0.2F, 0.3F)), 1.0F));
+  const resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+
+  // when
+  cache.bake(region_);
+
+  // then
+  size_t sampled = 0;
+  for (const glm::vec3& point : grid_points(region_, 0.0371F)) {
+    const float expected              = evaluator.evaluate(point);
+    const std::optional<float> cached = cache.sample(point);
+    if (std::abs(expected) < kBand - kVoxelSize) {
+      ASSERT_TRUE(cached.has_value());
+      EXPECT_NEAR(*cached, expected, 0.005F);
+      ++sampled;
+    }
+    EXPECT_NEAR(cache.evaluate(point), expected, 0.005F);
+  }
+  EXPECT_GT(sampled, 1000);
+  EXPECT_FALSE(cache.sample(glm::vec3(0.1F, -0.2F, 0.3F)).has_value());
+  EXPECT_EQ(cache.evaluate(glm::vec3(0.1F, -0.2F, 0.3F)), evaluator.evaluate(glm::vec3(0.1F, -0.2F, 0.3F)));
+  EXPECT_FALSE(cache.sample(glm::vec3(1.0F, 5.0F, 0.0F)).has_value());
+}
+
+TEST_F(SdfBrickCacheTest, OnlyTheNarrowBandIsBaked) {
+  // given
+  tree_.set_root(tree_.create_sphere(transforms_.create(glm::vec3(0.0F)), 1.0F));
+  const resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+
+  // when
+  const size_t baked = cache.bake(region_);
+
+  // then
+  const size_t region_bricks = kRegionBricks * kRegionBricks * kRegionBricks;
+  EXPECT_GT(cache.brick_count(), 0);
+  EXPECT_LE(cache.brick_count(), baked);
+  EXPECT_LT(baked, region_bricks / 3);
+}
+
+TEST_F(SdfBrickCacheTest, BatchMatchesSinglePoints) {
+  // given
+  const auto box   = tree_.create_box(transforms_.create(glm::vec3(0.0F)), glm::vec3(1.0F, 0.5F, 0.75F));
+  const auto torus = tree_.create_torus(transforms_.create(glm::vec3(0.5F, 0.5F, 0.0F)), 1.0F, 0.25F);
+  tree_.set_root(tree_.create_smooth_union(box, torus, 0.25F));
+  const resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+  cache.bake(region_);
+  const std::vector<glm::vec3> points = grid_points(region_, 0.113F);
+  std::vector<float> values(points.size());
+
+  // when
+  cache.evaluate(points, values);
+
+  // then
+  // The batches may run the tape with FMA, which rounds differently from the single points
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_NEAR(values[i], cache.evaluate(points[i]), 1e-4F * kVoxelSize);
+  }
+}
+
+TEST_F(SdfBrickCacheTest, MovingATransformBakesOnlyTheAffectedBricks) {
+  // given
+  resin::Transform& moved = transforms_.create(glm::vec3(-1.2F, 0.0F, 0.0F));
+  const auto a            = tree_.create_sphere(moved, 0.5F);
+  const auto b            = tree_.create_box(transforms_.create(glm::vec3(1.2F, 0.0F, 0.0F)), glm::vec3(0.5F));
+  tree_.set_root(tree_.create_smooth_union(a, b, 0.1F));
+  resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+  const size_t baked = cache.bake(region_);
+
+  // when
+  moved.set_local_pos(glm::vec3(-1.0F, 0.8F, 0.2F));
+  evaluator.update();
+  const size_t rebaked = cache.update();
+
+  // then
+  EXPECT_GT(rebaked, 0);
+  EXPECT_LT(rebaked, baked * 3 / 4);
+
+  resin::SdfBrickCache fresh(evaluator, jobs_, kVoxelSize, kBand);
+  fresh.bake(region_);
+  EXPECT_EQ(cache.brick_count(), fresh.brick_count());
+  for (const glm::vec3& point : grid_points(region_, 0.0371F)) {
+    EXPECT_NEAR(cache.evaluate(point), fresh.evaluate(point), 1e-5F);
+  }
+}
+
+TEST_F(SdfBrickCacheTest, ChangingParametersBakesOnlyTheAffectedBricks) {
+  // given
+  const auto a = tree_.create_sphere(transforms_.create(glm::vec3(-1.2F, 0.0F, 0.0F)), 0.5F);
+  const auto b = tree_.create_sphere(transforms_.create(glm::vec3(1.2F, 0.0F, 0.0F)), 0.5F);
+  tree_.set_root(tree_.create_union(a, b));
+  resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+  const size_t baked = cache.bake(region_);
+
+  // when
+  tree_.set_params(a, glm::vec4(0.6F));
+  evaluator.update();
+  const size_t rebaked = cache.update();
+
+  // then
+  EXPECT_GT(rebaked, 0);
+  EXPECT_LT(rebaked, baked * 3 / 4);
+  const std::optional<float> surface = cache.sample(glm::vec3(-1.2F, 0.6F, 0.0F));
+  ASSERT_TRUE(surface.has_value());
+  EXPECT_NEAR(*surface, 0.0F, 0.005F);
+}
+
+TEST_F(SdfBrickCacheTest, ChangingTheStructureBakesEverything) {
+  // given
+  const auto a = tree_.create_sphere(transforms_.create(glm::vec3(-1.2F, 0.0F, 0.0F)), 0.5F);
+  tree_.set_root(a);
+  resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+  cache.bake(region_);
+
+  // when
+  const auto b = tree_.create_sphere(transforms_.create(glm::vec3(1.2F, 0.0F, 0.0F)), 0.5F);
+  tree_.set_root(tree_.create_union(a, b));
+  evaluator.update();
+  const size_t rebaked = cache.update();
+
+  // then
+  resin::SdfBrickCache fresh(evaluator, jobs_, kVoxelSize, kBand);
+  EXPECT_EQ(rebaked, fresh.bake(region_));
+  EXPECT_EQ(cache.brick_count(), fresh.brick_count());
+  const std::optional<float> surface = cache.sample(glm::vec3(1.7F, 0.0F, 0.0F));
+  ASSERT_TRUE(surface.has_value());
+  EXPECT_NEAR(*surface, 0.0F, 0.005F);
+}
+
+TEST_F(SdfBrickCacheTest, BakedRegionsAreNotBakedAgain) {
+  // given
+  tree_.set_root(tree_.create_sphere(transforms_.create(glm::vec3(0.0F)), 1.0F));
+  resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+  cache.bake(region_);
+  const size_t bricks = cache.brick_count();
+
+  // when
+  evaluator.update();
+  const size_t updated = cache.update();
+  const size_t inner   = cache.bake(resin::Aabb(glm::vec3(-1.0F), glm::vec3(1.0F)));
+
+  // then
+  EXPECT_EQ(updated, 0);
+  EXPECT_EQ(inner, 0);
+  EXPECT_EQ(cache.brick_count(), bricks);
+
+  cache.clear();
+  EXPECT_EQ(cache.brick_count(), 0);
+  EXPECT_FALSE(cache.sample(glm::vec3(1.0F, 0.0F, 0.0F)).has_value());
+}
+
+TEST_F(SdfBrickCacheTest, InvalidArgumentsThrow) {
+  // given
+  const auto sphere = tree_.create_sphere(transforms_.create(glm::vec3(0.0F)), 1.0F);
+  tree_.set_root(sphere);
+  const resin::SdfEvaluator evaluator(tree_);
+  resin::SdfBrickCache cache(evaluator, jobs_, kVoxelSize, kBand);
+
+  // when / then
+  EXPECT_THROW(resin::SdfBrickCache(evaluator, jobs_, 0.0F, kBand), std::invalid_argument);
+  EXPECT_THROW(resin::SdfBrickCache(evaluator, jobs_, kVoxelSize, -1.0F), std::invalid_argument);
+  EXPECT_THROW(cache.bake(resin::Aabb(glm::vec3(0.0F), glm::vec3(1e6F))), std::invalid_argument);
+  tree_.set_params(sphere, glm::vec4(2.0F));
+  EXPECT_THROW(cache.update(), std::logic_error);
+  EXPECT_THROW(cache.evaluate(glm::vec3(0.0F)), std::logic_error);
+}
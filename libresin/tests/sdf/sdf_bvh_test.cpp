@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_bvh.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <random>
+#include <stdexcept>
+#include <tests/glm_helper.hpp>
+#include <tests/transform_helper.hpp>
+#include <vector>
+
+class SdfBvhTest : public testing::Test {
+ protected:
+  // Row of unit spheres along the x axis, 3 units apart
+  void create_row(size_t count) {
+    auto node = tree_.create_sphere(transforms_.create(glm::vec3()), 1.0F);
+    spheres_.push_back(node);
+    for (size_t i = 1; i < count; ++i) {
+      const auto sphere = tree_.create_sphere(transforms_.create(glm::vec3(3.0F * static_cast<float>(i), 0, 0)), 1.0F);
+      node              = tree_.create_union(node, sphere);
+      spheres_.push_back(sphere);
+    }
+    tree_.set_root(node);
+  }
+
+  TransformPool transforms_;
+  std::vector<resin::SdfTree::NodeId> spheres_;
+  resin::SdfTree tree_;
+};
+
+TEST_F(SdfBvhTest, BoundsContainAllPrimitives) {
+  // given
+  create_row(100);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // when
+  const resin::SdfBvh bvh(tape);
+
+  // then
+  EXPECT_EQ(bvh.primitive_count(), 100);
+  EXPECT_GT(bvh.node_count(), 100 / resin::SdfBvh::kMaxLeafSize);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-1, -1, -1), bvh.bounds().min, 1e-5F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(298, 1, 1), bvh.bounds().max, 1e-5F);
+}
+
+TEST_F(SdfBvhTest, EmptyTapeHasNoBounds) {
+  // given
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // when
+  const resin::SdfBvh bvh(tape);
+  std::vector<uint32_t> found;
+  bvh.query(resin::Aabb(glm::vec3(-1), glm::vec3(1)), found);
+
+  // then
+  EXPECT_TRUE(bvh.bounds().empty());
+  EXPECT_TRUE(found.empty());
+  EXPECT_FALSE(bvh.pick(tape, glm::vec3(), glm::vec3(1, 0, 0)).has_value());
+}
+
+TEST_F(SdfBvhTest, QueryFindsOverlappingPrimitives) {
+  // given
+  create_row(100);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const resin::SdfBvh bvh(tape);
+
+  // when
+  std::vector<uint32_t> found;
+  bvh.query(resin::Aabb(glm::vec3(29.5F, -0.5F, -0.5F), glm::vec3(33.5F, 0.5F, 0.5F)), found);
+
+  // then
+  ASSERT_EQ(found.size(), 2);
+  std::vector<resin::SdfTree::NodeId> nodes;
+  for (const uint32_t primitive : found) {
+    nodes.push_back(tape.primitives()[primitive].node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  EXPECT_EQ(nodes[0], spheres_[10]);
+  EXPECT_EQ(nodes[1], spheres_[11]);
+}
+
+TEST_F(SdfBvhTest, RefitFollowsMovedTransforms) {
+  // given
+  create_row(100);
+  resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  resin::SdfBvh bvh(tape);
+
+  // when
+  transforms_[50].set_local_pos(glm::vec3(0, 100, 0));
+  tape.refresh_transforms();
+  bvh.refit(tape);
+  std::vector<uint32_t> found;
+  bvh.query(resin::Aabb(glm::vec3(-1, 99, -1), glm::vec3(1, 101, 1)), found);
+
+  // then
+  ASSERT_EQ(found.size(), 1);
+  EXPECT_EQ(tape.primitives()[found[0]].node, spheres_[50]);
+  EXPECT_NEAR(bvh.bounds().max.y, 101.0F, 1e-5F);
+}
+
+TEST_F(SdfBvhTest, PickReturnsTheClosestPrimitive) {
+  // given
+  create_row(100);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const resin::SdfBvh bvh(tape);
+
+  // when
+  const auto along_row  = bvh.pick(tape, glm::vec3(-10, 0, 0), glm::vec3(1, 0, 0));
+  const auto backwards  = bvh.pick(tape, glm::vec3(400, 0, 0), glm::vec3(-2, 0, 0));
+  const auto from_above = bvh.pick(tape, glm::vec3(30, 10, 0), glm::vec3(0, -1, 0));
+
+  // then
+  ASSERT_TRUE(along_row.has_value());
+  EXPECT_EQ(along_row->node, spheres_[0]);
+  EXPECT_NEAR(along_row->distance, 9.0F, 1e-3F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-1, 0, 0), along_row->point, 1e-3F);
+
+  ASSERT_TRUE(backwards.has_value());
+  EXPECT_EQ(backwards->node, spheres_[99]);
+  EXPECT_NEAR(backwards->distance, 102.0F, 1e-3F);
+
+  ASSERT_TRUE(from_above.has_value());
+  EXPECT_EQ(from_above->node, spheres_[10]);
+  EXPECT_NEAR(from_above->distance, 9.0F, 1e-3F);
+}
+
+TEST_F(SdfBvhTest, PickMissesRaysPassingByAndTooShortRays) {
+  // given
+  create_row(100);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const resin::SdfBvh bvh(tape);
+
+  // when
+  const auto passing_by = bvh.pick(tape, glm::vec3(-10, 1.5F, 0), glm::vec3(1, 0, 0));
+  const auto too_short  = bvh.pick(tape, glm::vec3(-10, 0, 0), glm::vec3(1, 0, 0), 8.0F);
+  const auto away       = bvh.pick(tape, glm::vec3(-10, 0, 0), glm::vec3(-1, 0, 0));
+
+  // then
+  EXPECT_FALSE(passing_by.has_value());
+  EXPECT_FALSE(too_short.has_value());
+  EXPECT_FALSE(away.has_value());
+}
+
+TEST_F(SdfBvhTest, PruningMatchesTheTapeWithinTheRegion) {
+  // given
+  std::mt19937 gen(11);  // NOLINT
+  std::uniform_real_distribution<float> coord(-20.0F, 20.0F);
+  std::uniform_real_distribution<float> size(0.25F, 1.5F);
+  std::uniform_int_distribution<int> operation(static_cast<int>(resin::SdfNodeType::Union),
+                                               static_cast<int>(resin::SdfNodeType::SmoothSubtraction));
+
+  auto node = tree_.create_sphere(transforms_.create(glm::vec3()), 2.0F);
+  for (int i = 0; i < 200; ++i) {
+    auto& transform = transforms_.create(glm::vec3(coord(gen), coord(gen), coord(gen)));
+    transform.set_local_scale(glm::vec3(size(gen), size(gen), size(gen)));
+    const auto primitive = i % 2 == 0 ? tree_.create_box(transform, glm::vec3(size(gen), size(gen), size(gen)))
+                                      : tree_.create_capsule(transform, size(gen), size(gen) / 2);
+    const auto type      = static_cast<resin::SdfNodeType>(operation(gen));
+    node                 = tree_.create_operation(type, node, primitive, size(gen));
+  }
+  tree_.set_root(node);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const resin::SdfBvh bvh(tape);
+
+  // when / then
+  std::uniform_real_distribution<float> t(0.0F, 1.0F);
+  for (int region = 0; region < 20; ++region) {
+    const glm::vec3 min(coord(gen), coord(gen), coord(gen));
+    const glm::vec3 max         = min + glm::vec3(1.0F);
+    const resin::SdfTape pruned = tape.prune(min, max, bvh);
+    EXPECT_LT(pruned.primitives().size(), tape.primitives().size());
+
+    for (int i = 0; i < 20; ++i) {
+      const glm::vec3 point = min + (max - min) * glm::vec3(t(gen), t(gen), t(gen));
+      EXPECT_NEAR(pruned.evaluate(point), tape.evaluate(point), 1e-4F);
+    }
+  }
+}
+
+TEST_F(SdfBvhTest, MismatchedTapeThrows) {
+  // given
+  create_row(10);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  resin::SdfBvh bvh(tape);
+  tree_.set_root(tree_.create_union(tree_.root(), tree_.create_sphere(transforms_.create(glm::vec3()), 1.0F)));
+  const resin::SdfTape other = resin::SdfTape::compile(tree_);
+
+  // when / then
+  EXPECT_THROW(bvh.refit(other), std::invalid_argument);
+  EXPECT_THROW(bvh.pick(other, glm::vec3(), glm::vec3(1, 0, 0)), std::invalid_argument);
+  EXPECT_THROW(other.prune(glm::vec3(0), glm::vec3(1), bvh), std::invalid_argument);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+constexpr float kPi = glm::pi<float>();
+
+class SdfEvaluatorTest : public testing::Test {
+ protected:
+  float evaluate_root(resin::SdfTree::NodeId root, const glm::vec3& point) {
+    tree_.set_root(root);
+    const resin::SdfEvaluator evaluator(tree_);
+    return evaluator.evaluate(point);
+  }
+
+  resin::Transform origin_;
+  resin::SdfTree tree_;
+};
+
+TEST_F(SdfEvaluatorTest, PrimitivesMatchKnownDistances) {
+  // given
+  const auto sphere   = tree_.create_sphere(origin_, 1.0F);
+  const auto box      = tree_.create_box(origin_, glm::vec3(1, 2, 3));
+  const auto torus    = tree_.create_torus(origin_, 2.0F, 0.5F);
+  const auto capsule  = tree_.create_capsule(origin_, 1.0F, 0.5F);
+  const auto cylinder = tree_.create_cylinder(origin_, 1.0F, 0.5F);
+
+  // when / then
+  EXPECT_NEAR(evaluate_root(sphere, glm::vec3(3, 0, 0)), 2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(sphere, glm::vec3(0, 0, 0)), -1.0F, 1e-5F);
+
+  EXPECT_NEAR(evaluate_root(box, glm::vec3(3, 0, 0)), 2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(box, glm::vec3(0, 0, 0)), -1.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(box, glm::vec3(2, 3, 0)), std::sqrt(2.0F), 1e-5F);
+
+  EXPECT_NEAR(evaluate_root(torus, glm::vec3(2, 0, 0)), -0.5F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(torus, glm::vec3(0, 0, 0)), 1.5F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(torus, glm::vec3(0, 1, -2)), 0.5F, 1e-5F);
+
+  EXPECT_NEAR(evaluate_root(capsule, glm::vec3(0, 3, 0)), 1.5F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(capsule, glm::vec3(2, 0.5F, 0)), 1.5F, 1e-5F);
+
+  EXPECT_NEAR(evaluate_root(cylinder, glm::vec3(0, 3, 0)), 2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(cylinder, glm::vec3(0, 0.5F, 2)), 1.5F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(cylinder, glm::vec3(1.5F, 2, 0)), std::sqrt(2.0F), 1e-5F);
+}
+
+TEST_F(SdfEvaluatorTest, PrimitivesFollowTheirTransforms) {
+  // given
+  const resin::Transform moved(glm::vec3(5, 0, 0), glm::quat(1, 0, 0, 0), glm::vec3(2));
+  const resin::Transform rotated(glm::vec3(), glm::quat(glm::vec3(0, 0, kPi / 2)));
+  const auto sphere = tree_.create_sphere(moved, 1.0F);
+  const auto box    = tree_.create_box(rotated, glm::vec3(1, 2, 3));
+
+  // when / then
+  EXPECT_NEAR(evaluate_root(sphere, glm::vec3(9, 0, 0)), 2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(sphere, glm::vec3(5, 0, 0)), -2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(box, glm::vec3(4, 0, 0)), 2.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(box, glm::vec3(0, 3, 0)), 2.0F, 1e-5F);
+}
+
+TEST_F(SdfEvaluatorTest, OperationsCombineTheirChildren) {
+  // given
+  const resin::Transform left(glm::vec3(-1, 0, 0));
+  const resin::Transform right(glm::vec3(1, 0, 0));
+  const auto a = tree_.create_sphere(left, 1.0F);
+  const auto b = tree_.create_sphere(right, 1.0F);
+
+  const auto unite            = tree_.create_union(a, b);
+  const auto intersect        = tree_.create_intersection(a, b);
+  const auto subtract         = tree_.create_subtraction(a, b);
+  const auto smooth_unite     = tree_.create_smooth_union(a, b, 0.5F);
+  const auto smooth_intersect = tree_.create_smooth_intersection(a, b, 0.5F);
+  const auto smooth_subtract  = tree_.create_smooth_subtraction(a, b, 0.5F);
+
+  // when / then
+  EXPECT_NEAR(evaluate_root(unite, glm::vec3(3, 0, 0)), 1.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(intersect, glm::vec3(3, 0, 0)), 3.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(subtract, glm::vec3(3, 0, 0)), 3.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(subtract, glm::vec3(-1, 0, 0)), -1.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(subtract, glm::vec3(0.5F, 0, 0)), 0.5F, 1e-5F);
+
+  // Children further apart than the blend radius are not blended
+  EXPECT_NEAR(evaluate_root(smooth_unite, glm::vec3(3, 0, 0)), 1.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(smooth_intersect, glm::vec3(3, 0, 0)), 3.0F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(smooth_subtract, glm::vec3(-2.5F, 0, 0)), 0.5F, 1e-5F);
+
+  // Equally distant children are blended the most
+  const float d = std::sqrt(5.0F) - 1.0F;
+  EXPECT_NEAR(evaluate_root(smooth_unite, glm::vec3(0, 2, 0)), d - 0.125F, 1e-5F);
+  EXPECT_NEAR(evaluate_root(smooth_intersect, glm::vec3(0, 2, 0)), d + 0.125F, 1e-5F);
+}
+
+TEST_F(SdfEvaluatorTest, BatchMatchesSinglePoints) {
+  // given
+  // Odd count, so that every kernel (8-wide, 4-wide and scalar) gets exercised
+  constexpr size_t kCount = 37;
+  std::mt19937 gen(42);  // NOLINT
+  std::uniform_real_distribution<float> coord(-4.0F, 4.0F);
+  std::uniform_real_distribution<float> angle(-3.0F, 3.0F);
+  std::uniform_real_distribution<float> size(0.25F, 2.0F);
+
+  std::vector<std::unique_ptr<resin::Transform>> transforms;
+  auto transform = [&]() -> const resin::Transform& {
+    return *transforms.emplace_back(std::make_unique<resin::Transform>(
+        glm::vec3(coord(gen), coord(gen), coord(gen)), glm::quat(glm::vec3(angle(gen), angle(gen), angle(gen))),
+        glm::vec3(size(gen))));
+  };
+
+  auto node = tree_.create_sphere(transform(), size(gen));
+  node      = tree_.create_union(node, tree_.create_box(transform(), glm::vec3(size(gen), size(gen), size(gen))));
+  node      = tree_.create_smooth_union(node, tree_.create_torus(transform(), size(gen), size(gen) / 4), 0.5F);
+  node      = tree_.create_subtraction(node, tree_.create_capsule(transform(), size(gen), size(gen)));
+  node      = tree_.create_smooth_intersection(node, tree_.create_sphere(transform(), 4.0F), 0.25F);
+  node      = tree_.create_smooth_subtraction(node, tree_.create_cylinder(transform(), size(gen), size(gen)), 0.5F);
+  node      = tree_.create_intersection(node, tree_.create_box(transform(), glm::vec3(3.5F)));
+  tree_.set_root(node);
+
+  std::vector<glm::vec3> points;
+  for (size_t i = 0; i < kCount; ++i) {
+    points.emplace_back(coord(gen), coord(gen), coord(gen));
+  }
+  std::vector<float> out(kCount);
+  const resin::SdfEvaluator evaluator(tree_);
+
+  // when
+  evaluator.evaluate(points, out);
+
+  // then
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_NEAR(evaluator.evaluate(points[i]), out[i], 1e-5F);
+  }
+}
+
+TEST_F(SdfEvaluatorTest, UpdateRefreshesMovedTransforms) {
+  // given
+  resin::Transform moving;
+  tree_.set_root(tree_.create_sphere(moving, 1.0F));
+  resin::SdfEvaluator evaluator(tree_);
+
+  // when
+  moving.set_local_pos(glm::vec3(0, 2, 0));
+  const float before = evaluator.evaluate(glm::vec3(0, 4, 0));
+  evaluator.update();
+  const float after = evaluator.evaluate(glm::vec3(0, 4, 0));
+
+  // then
+  EXPECT_NEAR(before, 3.0F, 1e-5F);
+  EXPECT_NEAR(after, 1.0F, 1e-5F);
+}
+
+TEST_F(SdfEvaluatorTest, ChangedTreeRequiresUpdate) {
+  // given
+  const auto sphere = tree_.create_sphere(origin_, 1.0F);
+  tree_.set_root(sphere);
+  resin::SdfEvaluator evaluator(tree_);
+
+  // when
+  tree_.set_params(sphere, glm::vec4(2.0F));
+
+  // then
+  EXPECT_THROW(evaluator.evaluate(glm::vec3()), std::logic_error);
+  evaluator.update();
+  EXPECT_NEAR(evaluator.evaluate(glm::vec3()), -2.0F, 1e-5F);
+}
+
+TEST_F(SdfEvaluatorTest, EmptyTreeIsInfinitelyFar) {
+  // given
+  const resin::SdfEvaluator evaluator(tree_);
+  const std::vector<glm::vec3> points(5);
+  std::vector<float> out(5);
+
+  // when
+  evaluator.evaluate(points, out);
+
+  // then
+  EXPECT_EQ(evaluator.evaluate(glm::vec3()), std::numeric_limits<float>::infinity());
+  EXPECT_EQ(out[4], std::numeric_limits<float>::infinity());
+}
+
+TEST_F(SdfEvaluatorTest, MismatchedSpansThrow) {
+  // given
+  const resin::SdfEvaluator evaluator(tree_);
+  const std::vector<glm::vec3> points(5);
+  std::vector<float> out(4);
+
+  // when / then
+  EXPECT_THROW(evaluator.evaluate(points, out), std::invalid_argument);
+}
+
+TEST_F(SdfEvaluatorTest, PickFollowsMovedTransforms) {
+  // given
+  resin::Transform moving;
+  const auto sphere = tree_.create_sphere(moving, 1.0F);
+  tree_.set_root(tree_.create_union(tree_.create_box(origin_, glm::vec3(0.5F)), sphere));
+  resin::SdfEvaluator evaluator(tree_);
+
+  // when
+  const auto before = evaluator.pick(glm::vec3(0, 0, 10), glm::vec3(0, 0, -1));
+  moving.set_local_pos(glm::vec3(0, 0, 5));
+  evaluator.update();
+  const auto after = evaluator.pick(glm::vec3(0, 0, 10), glm::vec3(0, 0, -1));
+
+  // then
+  ASSERT_TRUE(before.has_value());
+  EXPECT_EQ(before->node, sphere);
+  EXPECT_NEAR(before->distance, 9.0F, 1e-3F);
+  ASSERT_TRUE(after.has_value());
+  EXPECT_EQ(after->node, sphere);
+  EXPECT_NEAR(after->distance, 4.0F, 1e-3F);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <glm/geometric.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_evaluator.hpp>
+#include <libresin/sdf/sdf_mesher.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <libresin/utils/job_system.hpp>
+#include <libresin/utils/mesh_writer.hpp>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <tests/transform_helper.hpp>
+#include <utility>
+#include <vector>
+
+constexpr float kPi = glm::pi<float>();
+
+namespace {
+
+class MemoryMeshWriter : public resin::MeshWriter {
+ public:
+  void write_vertices(std::span<const glm::vec3> chunk) override {
+    vertices.insert(vertices.end(), chunk.begin(), chunk.end());
+    vertex_count_ += chunk.size();
+  }
+  void write_triangles(std::span<const uint32_t> chunk) override {
+    indices.insert(indices.end(), chunk.begin(), chunk.end());
+    triangle_count_ += chunk.size() / 3;
+  }
+  void finish() override {}
+
+  // Every edge is shared by exactly two triangles that traverse it in the opposite directions
+  bool closed_and_oriented() const {
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      for (size_t j = 0; j < 3; ++j) {
+        ++edges[{indices[i + j], indices[i + (j + 1) % 3]}];
+      }
+    }
+    for (const auto& [edge, count] : edges) {
+      const auto reverse = edges.find({edge.second, edge.first});
+      if (count != 1 || reverse == edges.end() || reverse->second != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Positive for a closed mesh with the triangles facing out
+  float signed_volume() const {
+    float volume = 0.0F;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      volume += glm::dot(vertices[indices[i]], glm::cross(vertices[indices[i + 1]], vertices[indices[i + 2]])) / 6.0F;
+    }
+    return volume;
+  }
+
+  std::vector<glm::vec3> vertices;
+  std::vector<uint32_t> indices;
+};
+
+}  // namespace
+
+class SdfMesherTest : public testing::Test {
+ protected:
+  TransformPool transforms_;
+  resin::SdfTree tree_;
+  resin::JobSystem jobs_{3};
+};
+
+TEST_F(SdfMesherTest, SphereMeshIsClosedAndOriented) {
+  // given
+  constexpr float kCellSize = 0.1F;
+  tree_.set_root(tree_.create_sphere(transforms_.create(glm::vec3(0.3F, -0.2F, 0.1F)), 1.0F));
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when
+  const resin::SdfMeshStats stats = mesher.mesh(kCellSize, writer);
+
+  // then
+  EXPECT_GT(stats.triangle_count, 100);
+  EXPECT_EQ(stats.vertex_count, writer.vertices.size());
+  EXPECT_EQ(stats.triangle_count * 3, writer.indices.size());
+  EXPECT_TRUE(writer.closed_and_oriented());
+  EXPECT_NEAR(writer.signed_volume(), 4.0F / 3.0F * kPi, 0.05F * 4.0F / 3.0F * kPi);
+  // Also the vertices of the cells next to the blocks that were skipped as empty
+  for (const glm::vec3& vertex : writer.vertices) {
+    EXPECT_NEAR(glm::length(vertex - glm::vec3(0.3F, -0.2F, 0.1F)), 1.0F, 0.1F * kCellSize);
+  }
+}
+
+TEST_F(SdfMesherTest, ChunksAreStitchedWithoutCracks) {
+  // given
+  const auto box   = tree_.create_box(transforms_.create(glm::vec3(0.0F)), glm::vec3(1.0F, 0.5F, 0.75F));
+  const auto torus = tree_.create_torus(transforms_.create(glm::vec3(0.5F, 0.5F, 0.0F)), 1.0F, 0.25F);
+  tree_.set_root(tree_.create_smooth_union(box, torus, 0.25F));
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when
+  const resin::SdfMeshStats stats = mesher.mesh(0.025F, writer);
+
+  // then
+  EXPECT_GT(stats.chunk_count, 8);
+  EXPECT_TRUE(writer.closed_and_oriented());
+  EXPECT_GT(writer.signed_volume(), 0.0F);
+}
+
+TEST_F(SdfMesherTest, EmptyRegionsAreNotSampled) {
+  // given
+  const auto a = tree_.create_sphere(transforms_.create(glm::vec3(-5.0F, 0.0F, 0.0F)), 1.0F);
+  const auto b = tree_.create_sphere(transforms_.create(glm::vec3(5.0F, 3.0F, 0.0F)), 1.0F);
+  tree_.set_root(tree_.create_union(a, b));
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when
+  const resin::SdfMeshStats stats = mesher.mesh(0.05F, writer);
+
+  // then
+  EXPECT_GT(stats.empty_chunk_count, stats.chunk_count / 2);
+  const resin::Aabb bounds = mesher.scene_bounds();
+  const glm::vec3 cells    = bounds.size() / 0.05F;
+  EXPECT_LT(static_cast<float>(stats.sample_count), 0.2F * cells.x * cells.y * cells.z);
+  EXPECT_TRUE(writer.closed_and_oriented());
+  EXPECT_NEAR(writer.signed_volume(), 8.0F / 3.0F * kPi, 0.05F * 8.0F / 3.0F * kPi);
+}
+
+TEST_F(SdfMesherTest, OutputDoesNotDependOnTheThreadCount) {
+  // given
+  const auto box     = tree_.create_box(transforms_.create(glm::vec3(0.0F)), glm::vec3(1.0F, 0.5F, 0.75F));
+  const auto capsule = tree_.create_capsule(transforms_.create(glm::vec3(0.5F, 0.0F, 0.5F)), 1.5F, 0.5F);
+  tree_.set_root(tree_.create_smooth_subtraction(box, capsule, 0.25F));
+  const resin::SdfEvaluator evaluator(tree_);
+  resin::JobSystem single_thread(0);
+  MemoryMeshWriter parallel_writer;
+  MemoryMeshWriter serial_writer;
+
+  // when
+  resin::SdfMesher(evaluator, jobs_).mesh(0.04F, parallel_writer);
+  resin::SdfMesher(evaluator, single_thread).mesh(0.04F, serial_writer);
+
+  // then
+  EXPECT_EQ(parallel_writer.vertices, serial_writer.vertices);
+  EXPECT_EQ(parallel_writer.indices, serial_writer.indices);
+  EXPECT_TRUE(parallel_writer.closed_and_oriented());
+}
+
+TEST_F(SdfMesherTest, MeshesAreAppendedToTheWriter) {
+  // given
+  tree_.set_root(tree_.create_sphere(transforms_.create(glm::vec3(0.0F)), 1.0F));
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when
+  const resin::SdfMeshStats first  = mesher.mesh(0.2F, writer);
+  const resin::SdfMeshStats second = mesher.mesh(0.2F, writer);
+
+  // then
+  EXPECT_EQ(writer.vertices.size(), first.vertex_count + second.vertex_count);
+  EXPECT_TRUE(writer.closed_and_oriented());
+  EXPECT_NEAR(writer.signed_volume(), 8.0F / 3.0F * kPi, 0.1F * 8.0F / 3.0F * kPi);
+}
+
+TEST_F(SdfMesherTest, EmptyTreeWritesNothing) {
+  // given
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when
+  const resin::SdfMeshStats stats = mesher.mesh(0.1F, writer);
+
+  // then
+  EXPECT_EQ(stats.vertex_count, 0);
+  EXPECT_TRUE(writer.vertices.empty());
+  EXPECT_TRUE(mesher.scene_bounds().empty());
+}
+
+TEST_F(SdfMesherTest, InvalidArgumentsThrow) {
+  // given
+  const auto sphere = tree_.create_sphere(transforms_.create(glm::vec3(0.0F)), 1.0F);
+  tree_.set_root(sphere);
+  const resin::SdfEvaluator evaluator(tree_);
+  const resin::SdfMesher mesher(evaluator, jobs_);
+  MemoryMeshWriter writer;
+
+  // when / then
+  EXPECT_THROW(mesher.mesh(0.0F, writer), std::invalid_argument);
+  EXPECT_THROW(mesher.mesh(-1.0F, writer), std::invalid_argument);
+  EXPECT_THROW(mesher.mesh(resin::Aabb(glm::vec3(-1e6F), glm::vec3(1e6F)), 1e-3F, writer), std::invalid_argument);
+  tree_.set_params(sphere, glm::vec4(2.0F));
+  EXPECT_THROW(mesher.mesh(0.1F, writer), std::logic_error);
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_tape.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <tests/transform_helper.hpp>
+#include <vector>
+
+class SdfTapeTest : public testing::Test {
+ protected:
+  // Row of unit spheres along the x axis, 3 units apart
+  resin::SdfTree::NodeId create_row(size_t count, float blend = 0.0F) {
+    auto node = tree_.create_sphere(transforms_.create(glm::vec3()), 1.0F);
+    for (size_t i = 1; i < count; ++i) {
+      const auto& transform = transforms_.create(glm::vec3(3.0F * static_cast<float>(i), 0, 0));
+      const auto sphere     = tree_.create_sphere(transform, 1.0F);
+      node                  = blend > 0.0F ? tree_.create_smooth_union(node, sphere, blend)
+                                           : tree_.create_union(node, sphere);
+    }
+    return node;
+  }
+
+  TransformPool transforms_;
+  resin::SdfTree tree_;
+};
+
+TEST_F(SdfTapeTest, EmptyTreeCompilesToEmptyTape) {
+  // given / when
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // then
+  EXPECT_TRUE(tape.empty());
+  EXPECT_EQ(tape.evaluate(glm::vec3()), std::numeric_limits<float>::infinity());
+}
+
+TEST_F(SdfTapeTest, BalancedTreeNeedsLogarithmicRegisters) {
+  // given
+  std::vector<resin::SdfTree::NodeId> level;
+  for (int i = 0; i < 64; ++i) {
+    level.push_back(tree_.create_sphere(transforms_.create(glm::vec3(static_cast<float>(i), 0, 0)), 0.25F));
+  }
+  while (level.size() > 1) {
+    std::vector<resin::SdfTree::NodeId> next;
+    for (size_t i = 0; i < level.size(); i += 2) {
+      next.push_back(tree_.create_union(level[i], level[i + 1]));
+    }
+    level = next;
+  }
+  tree_.set_root(level[0]);
+
+  // when
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // then
+  EXPECT_EQ(tape.instructions().size(), 127);
+  EXPECT_EQ(tape.primitives().size(), 64);
+  EXPECT_EQ(tape.register_count(), 7);
+  EXPECT_NEAR(tape.evaluate(glm::vec3(10, 1, 0)), 0.75F, 1e-5F);
+}
+
+TEST_F(SdfTapeTest, DeepTreeCompilesWithTwoRegisters) {
+  // given
+  tree_.set_root(create_row(100000));
+
+  // when
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // then
+  EXPECT_EQ(tape.register_count(), 2);
+  EXPECT_NEAR(tape.evaluate(glm::vec3(30, 2, 0)), 1.0F, 1e-5F);
+}
+
+TEST_F(SdfTapeTest, SharedSubtreeIsCompiledOnce) {
+  // given
+  const auto sphere = tree_.create_sphere(transforms_.create(glm::vec3()), 1.0F);
+  const auto shared = tree_.create_union(sphere, sphere);
+  tree_.set_root(tree_.create_smooth_union(shared, shared, 0.5F));
+
+  // when
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // then
+  EXPECT_EQ(tape.primitives().size(), 1);
+  EXPECT_EQ(tape.instructions().size(), 3);
+  EXPECT_NEAR(tape.evaluate(glm::vec3(3, 0, 0)), 2.0F - 0.125F, 1e-5F);
+}
+
+TEST_F(SdfTapeTest, TooManyLiveValuesThrow) {
+  // given
+  std::vector<resin::SdfTree::NodeId> spheres;
+  for (size_t i = 0; i <= resin::SdfTape::kMaxRegisters; ++i) {
+    spheres.push_back(tree_.create_sphere(transforms_.create(glm::vec3(static_cast<float>(i), 0, 0)), 0.25F));
+  }
+  // Every sphere is used by both chains, so all of them are held until the second one reads them
+  auto first  = spheres.front();
+  auto second = spheres.back();
+  for (size_t i = 1; i < spheres.size(); ++i) {
+    first  = tree_.create_union(first, spheres[i]);
+    second = tree_.create_union(second, spheres[spheres.size() - 1 - i]);
+  }
+  tree_.set_root(tree_.create_union(first, second));
+
+  // when / then
+  EXPECT_THROW(resin::SdfTape::compile(tree_), std::length_error);
+}
+
+TEST_F(SdfTapeTest, PruningKeepsOnlyTheNearbyPrimitives) {
+  // given
+  tree_.set_root(create_row(16));
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const glm::vec3 min(14, -0.5F, -0.5F);
+  const glm::vec3 max(16, 0.5F, 0.5F);
+
+  // when
+  const resin::SdfTape pruned = tape.prune(min, max);
+
+  // then
+  ASSERT_EQ(pruned.primitives().size(), 1);
+  EXPECT_EQ(pruned.register_count(), 1);
+
+  std::mt19937 gen(42);  // NOLINT
+  std::uniform_real_distribution<float> t(0.0F, 1.0F);
+  for (int i = 0; i < 100; ++i) {
+    const glm::vec3 point = min + (max - min) * glm::vec3(t(gen), t(gen), t(gen));
+    EXPECT_NEAR(pruned.evaluate(point), tape.evaluate(point), 1e-5F);
+  }
+}
+
+TEST_F(SdfTapeTest, PruningKeepsBlendedPrimitives) {
+  // given
+  tree_.set_root(create_row(16, 2.0F));
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+  const glm::vec3 min(14, -0.5F, -0.5F);
+  const glm::vec3 max(16, 0.5F, 0.5F);
+
+  // when
+  const resin::SdfTape pruned = tape.prune(min, max);
+
+  // then
+  EXPECT_GT(pruned.primitives().size(), 1);
+  EXPECT_LT(pruned.primitives().size(), 16);
+
+  std::mt19937 gen(42);  // NOLINT
+  std::uniform_real_distribution<float> t(0.0F, 1.0F);
+  for (int i = 0; i < 100; ++i) {
+    const glm::vec3 point = min + (max - min) * glm::vec3(t(gen), t(gen), t(gen));
+    EXPECT_NEAR(pruned.evaluate(point), tape.evaluate(point), 1e-5F);
+  }
+}
+
+TEST_F(SdfTapeTest, PruningMatchesEveryOperationWithinTheRegion) {
+  // given
+  std::mt19937 gen(7);  // NOLINT
+  std::uniform_real_distribution<float> coord(-6.0F, 6.0F);
+  std::uniform_real_distribution<float> size(0.25F, 1.5F);
+  std::uniform_int_distribution<int> operation(static_cast<int>(resin::SdfNodeType::Union),
+                                               static_cast<int>(resin::SdfNodeType::SmoothSubtraction));
+
+  auto node = tree_.create_sphere(transforms_.create(glm::vec3()), 2.0F);
+  for (int i = 0; i < 40; ++i) {
+    const auto& transform = transforms_.create(glm::vec3(coord(gen), coord(gen), coord(gen)));
+    const auto primitive  = i % 2 == 0 ? tree_.create_box(transform, glm::vec3(size(gen), size(gen), size(gen)))
+                                       : tree_.create_torus(transform, size(gen), size(gen) / 4);
+    const auto type       = static_cast<resin::SdfNodeType>(operation(gen));
+    node                  = tree_.create_operation(type, node, primitive, size(gen));
+  }
+  tree_.set_root(node);
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // when / then
+  std::uniform_real_distribution<float> t(0.0F, 1.0F);
+  for (int region = 0; region < 20; ++region) {
+    const glm::vec3 min(coord(gen), coord(gen), coord(gen));
+    const glm::vec3 max             = min + glm::vec3(1.0F);
+    const resin::SdfTape pruned     = tape.prune(min, max);
+    const resin::SdfInterval bounds = tape.bounds(min, max);
+    EXPECT_LE(pruned.instructions().size(), tape.instructions().size());
+
+    for (int i = 0; i < 20; ++i) {
+      const glm::vec3 point = min + (max - min) * glm::vec3(t(gen), t(gen), t(gen));
+      const float distance  = tape.evaluate(point);
+      EXPECT_NEAR(pruned.evaluate(point), distance, 1e-4F);
+      EXPECT_LE(bounds.min, distance + 1e-4F);
+      EXPECT_GE(bounds.max, distance - 1e-4F);
+    }
+  }
+}
+
+TEST_F(SdfTapeTest, BoundsSeparateEmptyRegions) {
+  // given
+  tree_.set_root(create_row(4));
+  const resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // when
+  const resin::SdfInterval far     = tape.bounds(glm::vec3(0, 5, 0), glm::vec3(1, 6, 1));
+  const resin::SdfInterval surface = tape.bounds(glm::vec3(0.5F, -0.5F, -0.5F), glm::vec3(1.5F, 0.5F, 0.5F));
+
+  // then
+  EXPECT_GT(far.min, 0.0F);
+  EXPECT_LE(surface.min, 0.0F);
+  EXPECT_GE(surface.max, 0.0F);
+}
+
+TEST_F(SdfTapeTest, RefreshBakesOnlyMovedTransforms) {
+  // given
+  resin::Transform moving;
+  tree_.set_root(tree_.create_sphere(moving, 1.0F));
+  resin::SdfTape tape = resin::SdfTape::compile(tree_);
+
+  // when
+  const bool unchanged = tape.refresh_transforms();
+  moving.set_local_pos(glm::vec3(0, 2, 0));
+  const bool changed = tape.refresh_transforms();
+
+  // then
+  EXPECT_FALSE(unchanged);
+  EXPECT_TRUE(changed);
+  EXPECT_NEAR(tape.evaluate(glm::vec3(0, 4, 0)), 1.0F, 1e-5F);
+}
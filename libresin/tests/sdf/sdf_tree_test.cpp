@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/transform.hpp>
+#include <libresin/sdf/sdf_tree.hpp>
+#include <stdexcept>
+
+class SdfTreeTest : public testing::Test {
+ protected:
+  resin::Transform transform_;
+  resin::SdfTree tree_;
+};
+
+TEST_F(SdfTreeTest, NodesArePlacedAfterTheirChildren) {
+  // given
+  const auto sphere = tree_.create_sphere(transform_, 1.0F);
+  const auto box    = tree_.create_box(transform_, glm::vec3(1, 2, 3));
+
+  // when
+  const auto op = tree_.create_smooth_union(sphere, box, 0.5F);
+
+  // then
+  EXPECT_LT(sphere, op);
+  EXPECT_LT(box, op);
+  EXPECT_EQ(tree_.node(op).type, resin::SdfNodeType::SmoothUnion);
+  EXPECT_EQ(tree_.node(op).lhs, sphere);
+  EXPECT_EQ(tree_.node(op).rhs, box);
+  EXPECT_EQ(tree_.node(op).params.x, 0.5F);
+  EXPECT_EQ(tree_.node(box).transform, &transform_);
+  EXPECT_EQ(tree_.node(box).params, glm::vec4(1, 2, 3, 0));
+}
+
+TEST_F(SdfTreeTest, OperationOnUnknownNodeThrows) {
+  // given
+  const auto sphere = tree_.create_sphere(transform_, 1.0F);
+
+  // when / then
+  EXPECT_THROW(tree_.create_union(sphere, sphere + 1), std::out_of_range);
+  EXPECT_THROW(tree_.set_root(sphere + 1), std::out_of_range);
+  EXPECT_THROW(tree_.create_operation(resin::SdfNodeType::Box, sphere, sphere), std::invalid_argument);
+}
+
+TEST_F(SdfTreeTest, SmoothOperationWithoutBlendRadiusThrows) {
+  // given
+  const auto sphere = tree_.create_sphere(transform_, 1.0F);
+  const auto op     = tree_.create_smooth_subtraction(sphere, sphere, 1.0F);
+
+  // when / then
+  EXPECT_THROW(tree_.create_smooth_intersection(sphere, sphere, 0.0F), std::invalid_argument);
+  EXPECT_THROW(tree_.set_params(op, glm::vec4(-1.0F)), std::invalid_argument);
+}
+
+TEST_F(SdfTreeTest, ModificationsChangeTheVersion) {
+  // given
+  const uint32_t initial = tree_.version();
+
+  // when
+  const auto sphere      = tree_.create_sphere(transform_, 1.0F);
+  const uint32_t created = tree_.version();
+  tree_.set_params(sphere, glm::vec4(2.0F));
+  const uint32_t modified = tree_.version();
+  tree_.clear();
+
+  // then
+  EXPECT_NE(initial, created);
+  EXPECT_NE(created, modified);
+  EXPECT_NE(modified, tree_.version());
+  EXPECT_EQ(tree_.size(), 0);
+  EXPECT_EQ(tree_.root(), resin::SdfTree::kInvalidNode);
+}
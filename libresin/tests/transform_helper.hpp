@@ -0,0 +1,23 @@
+#ifndef RESIN_TESTS_TRANSFORM_HELPER_HPP
+#define RESIN_TESTS_TRANSFORM_HELPER_HPP
+
+#include <cstddef>
+#include <glm/vec3.hpp>
+#include <libresin/core/transform.hpp>
+#include <memory>
+#include <vector>
+
+// Owns the transforms created by a test. Their addresses are stable, since the SDF nodes refer to them.
+class TransformPool {
+ public:
+  resin::Transform& create(const glm::vec3& pos) {
+    return *transforms_.emplace_back(std::make_unique<resin::Transform>(pos));
+  }
+
+  resin::Transform& operator[](size_t index) { return *transforms_[index]; }
+
+ private:
+  std::vector<std::unique_ptr<resin::Transform>> transforms_;
+};
+
+#endif  // RESIN_TESTS_TRANSFORM_HELPER_HPP
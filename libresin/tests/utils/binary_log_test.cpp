@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <libresin/utils/binary_log.hpp>
+#include <libresin/utils/log_args.hpp>
+#include <libresin/utils/logger.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::byte> read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<std::byte> data(content.size());
+  std::memcpy(data.data(), content.data(), content.size());
+  return data;
+}
+
+}  // namespace
+
+TEST(BinaryLogTest, RecordsRoundTrip) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_binary_log_test.rlog";
+  const std::chrono::time_point<std::chrono::system_clock> time_point(std::chrono::seconds(1700000000));
+  static constexpr std::string_view kFmt = "{} of {:.2f} {}";
+  const resin::LogLocation location{.file_path = "file.cpp", .function_name = "function", .line = 12, .column = 3};
+
+  std::array<std::byte, resin::kMaxLogArgsSize> args{};
+  const size_t args_size = resin::encode_log_args(args, 7, 0.5, "resin");
+  std::string message_buffer;
+
+  // when
+  {
+    resin::BinaryLogWriter writer(path);
+    for (int i = 0; i < 3; ++i) {
+      const auto mode = i == 0 ? resin::LogTimestampMode::WallClock : resin::LogTimestampMode::Monotonic;
+      const resin::LogRecord record(time_point + std::chrono::milliseconds(i), mode, location, resin::LogLevel::Warn,
+                                    false, kFmt, std::span(args).first(args_size), message_buffer);
+      writer.write(record);
+    }
+  }
+  const std::vector<std::byte> data = read_file(path);
+  std::filesystem::remove(path);
+
+  // then
+  resin::BinaryLogReader reader(data);
+  const resin::BinaryLogCallsite* callsite = nullptr;
+  for (int i = 0; i < 3; ++i) {
+    const auto message = reader.next();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(message->time_point, time_point + std::chrono::milliseconds(i));
+    EXPECT_EQ(message->timestamp_mode,
+              i == 0 ? resin::LogTimestampMode::WallClock : resin::LogTimestampMode::Monotonic);
+
+    // The callsite is written once and shared by all messages
+    if (callsite == nullptr) {
+      callsite = message->callsite;
+    }
+    EXPECT_EQ(message->callsite, callsite);
+    EXPECT_EQ(callsite->fmt, kFmt);
+    EXPECT_EQ(callsite->level, resin::LogLevel::Warn);
+    EXPECT_FALSE(callsite->is_debug_msg);
+    EXPECT_EQ(callsite->location.file_path, "file.cpp");
+    EXPECT_EQ(callsite->location.function_name, "function");
+    EXPECT_EQ(callsite->location.line, 12U);
+    EXPECT_EQ(callsite->location.column, 3U);
+
+    const resin::LogRecord decoded(message->time_point, message->timestamp_mode, callsite->location, callsite->level,
+                                   callsite->is_debug_msg, callsite->fmt, message->args, message_buffer);
+    EXPECT_EQ(decoded.message(), "7 of 0.50 resin");
+  }
+  EXPECT_FALSE(reader.next().has_value());
+}
+
+TEST(BinaryLogTest, PreformattedRecordsKeepTheirMessage) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_binary_log_preformatted_test.rlog";
+  const std::chrono::time_point<std::chrono::system_clock> time_point(std::chrono::seconds(1700000000));
+  const resin::LogLocation location{.file_path = "file.cpp", .function_name = "function", .line = 7, .column = 1};
+
+  // A value the encoding does not store as it is, passed along as its text while the message is formatted eagerly
+  std::array<std::byte, resin::kMaxLogArgsSize> args{};
+  const size_t args_size     = resin::encode_log_args(args, "3.14159");
+  std::string message_buffer = "3.14";
+
+  // when
+  {
+    resin::BinaryLogWriter writer(path);
+    const resin::LogRecord record(time_point, resin::LogTimestampMode::WallClock, location, resin::LogLevel::Info,
+                                  false, "{:.2f}", std::span(args).first(args_size), message_buffer, true);
+    writer.write(record);
+  }
+  const std::vector<std::byte> data = read_file(path);
+  std::filesystem::remove(path);
+
+  // then
+  resin::BinaryLogReader reader(data);
+  const auto message = reader.next();
+  ASSERT_TRUE(message.has_value());
+  EXPECT_EQ(message->callsite->fmt, "{}");
+
+  std::string decoded_buffer;
+  const resin::LogRecord decoded(message->time_point, message->timestamp_mode, message->callsite->location,
+                                 message->callsite->level, message->callsite->is_debug_msg, message->callsite->fmt,
+                                 message->args, decoded_buffer);
+  EXPECT_EQ(decoded.message(), "3.14");
+  EXPECT_FALSE(reader.next().has_value());
+}
+
+TEST(BinaryLogTest, RejectsInvalidData) {
+  // given
+  const std::vector<std::byte> data(16, std::byte{0x42});
+
+  // when / then
+  EXPECT_THROW(resin::BinaryLogReader reader(data), std::runtime_error);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <libresin/utils/bounded_queue.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(BoundedQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+  // given / when
+  const resin::BoundedQueue<int> queue(5);
+
+  // then
+  EXPECT_EQ(queue.capacity(), 8);
+  EXPECT_THROW(resin::BoundedQueue<int>(0), std::invalid_argument);
+}
+
+TEST(BoundedQueueTest, PopsInPushOrder) {
+  // given
+  resin::BoundedQueue<int> queue(4);
+  int value = 0;
+
+  // when
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+
+  // then
+  EXPECT_FALSE(queue.try_push(4));
+  EXPECT_EQ(queue.size_approx(), 4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty_approx());
+}
+
+TEST(BoundedQueueTest, CellsAreReusedAfterWrapAround) {
+  // given
+  resin::BoundedQueue<int> queue(2);
+  int value = 0;
+
+  for (int i = 0; i < 10; ++i) {
+    // when
+    ASSERT_TRUE(queue.try_push_with([i](int& cell) { cell = i; }));
+    ASSERT_TRUE(queue.try_pop_with([&value](const int& cell) { value = cell; }));
+
+    // then
+    EXPECT_EQ(value, i);
+  }
+}
+
+TEST(BoundedQueueTest, ConcurrentProducersAndConsumersDoNotLoseValues) {
+  // given
+  constexpr uint64_t kThreads         = 4;
+  constexpr uint64_t kValuesPerThread = 20000;
+  resin::BoundedQueue<uint64_t> queue(64);
+  std::vector<uint64_t> sums(kThreads, 0);
+
+  // when
+  {
+    std::vector<std::jthread> threads;
+    for (uint64_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&queue] {
+        for (uint64_t i = 1; i <= kValuesPerThread; ++i) {
+          while (!queue.try_push(i)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      threads.emplace_back([&queue, &sum = sums[t]] {
+        uint64_t value = 0;
+        for (uint64_t i = 0; i < kValuesPerThread; ++i) {
+          while (!queue.try_pop(value)) {
+            std::this_thread::yield();
+          }
+          sum += value;
+        }
+      });
+    }
+  }
+
+  // then
+  uint64_t total = 0;
+  for (const uint64_t sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(total, kThreads * kValuesPerThread * (kValuesPerThread + 1) / 2);
+  EXPECT_TRUE(queue.empty_approx());
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <libresin/utils/gzip.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef RESIN_TESTS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+std::vector<std::byte> to_bytes(std::string_view str) {
+  std::vector<std::byte> bytes(str.size());
+  for (size_t i = 0; i < str.size(); ++i) {
+    bytes[i] = static_cast<std::byte>(str[i]);
+  }
+  return bytes;
+}
+
+uint32_t read_u32_le(const std::vector<std::byte>& data, size_t offset) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+  }
+  return value;
+}
+
+#ifdef RESIN_TESTS_HAVE_ZLIB
+// Decompresses a gzip stream with zlib, returns nullopt if the stream is invalid.
+std::optional<std::vector<std::byte>> gunzip(std::span<const std::byte> data) {
+  z_stream stream{};
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {  // NOLINT(hicpp-signed-bitwise)
+    return std::nullopt;
+  }
+
+  std::vector<std::byte> result;
+  std::array<std::byte, 4096> chunk{};
+  stream.next_in  = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));  // NOLINT
+  stream.avail_in = static_cast<uInt>(data.size());
+  int status      = Z_OK;
+  while (status == Z_OK) {
+    stream.next_out  = reinterpret_cast<Bytef*>(chunk.data());  // NOLINT
+    stream.avail_out = static_cast<uInt>(chunk.size());
+    status           = inflate(&stream, Z_NO_FLUSH);
+    result.insert(result.end(), chunk.begin(), chunk.end() - stream.avail_out);
+  }
+  inflateEnd(&stream);
+
+  if (status != Z_STREAM_END) {
+    return std::nullopt;
+  }
+  return result;
+}
+#endif
+
+}  // namespace
+
+TEST(GzipTest, Crc32MatchesReferenceValue) {
+  // given
+  const auto data = to_bytes("123456789");
+
+  // when
+  const uint32_t crc = resin::crc32(data);
+
+  // then
+  EXPECT_EQ(crc, 0xCBF43926U);
+  EXPECT_EQ(resin::crc32(std::span(data).subspan(4), resin::crc32(std::span(data).first(4))), crc);
+}
+
+TEST(GzipTest, CompressesEmptyInput) {
+  // given
+  const std::vector<std::byte> data;
+
+  // when
+  const auto compressed = resin::gzip_compress(data);
+
+  // then
+  // Header, an empty fixed Huffman block and the trailer
+  ASSERT_EQ(compressed.size(), 20U);
+  EXPECT_EQ(compressed[0], std::byte{0x1F});
+  EXPECT_EQ(compressed[1], std::byte{0x8B});
+  EXPECT_EQ(compressed[10], std::byte{0x03});
+  EXPECT_EQ(compressed[11], std::byte{0x00});
+  EXPECT_EQ(read_u32_le(compressed, 12), 0U);
+  EXPECT_EQ(read_u32_le(compressed, 16), 0U);
+}
+
+TEST(GzipTest, RepetitiveTextShrinks) {
+  // given
+  std::string text;
+  for (int i = 0; i < 1000; ++i) {
+    text += "[INFO  12:00:00] Frame rendered in " + std::to_string(i % 17) + " ms\n";
+  }
+  const auto data = to_bytes(text);
+
+  // when
+  const auto compressed = resin::gzip_compress(data);
+
+  // then
+  EXPECT_LT(compressed.size(), data.size() / 4);
+  EXPECT_EQ(read_u32_le(compressed, compressed.size() - 8), resin::crc32(data));
+  EXPECT_EQ(read_u32_le(compressed, compressed.size() - 4), data.size());
+}
+
+#ifdef RESIN_TESTS_HAVE_ZLIB
+TEST(GzipTest, ZlibDecompressesOutput) {
+  // given
+  std::string text;
+  for (int i = 0; i < 2000; ++i) {
+    text += "[DEBUG 12:00:" + std::to_string(i % 60) + "] Meshed chunk " + std::to_string(i * 7919 % 1000) + "\n";
+  }
+  text.push_back('\0');
+  text += std::string(300, 'x');
+  const auto data = to_bytes(text);
+
+  // when
+  const auto empty        = gunzip(resin::gzip_compress({}));
+  const auto decompressed = gunzip(resin::gzip_compress(data));
+
+  // then
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty->empty());
+  ASSERT_TRUE(decompressed.has_value());
+  EXPECT_EQ(*decompressed, data);
+}
+#endif
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <libresin/utils/job_system.hpp>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(JobSystemTest, RunsScheduledJobsBeforeWaitReturns) {
+  // given
+  resin::JobSystem system(3);
+  resin::JobGroup group;
+  std::atomic<int> counter = 0;
+  std::vector<resin::Job> jobs(100);
+
+  // when
+  for (resin::Job& job : jobs) {
+    job.function = [&counter] { counter.fetch_add(1); };
+    system.schedule(job, group);
+  }
+  system.wait(group);
+
+  // then
+  EXPECT_TRUE(group.done());
+  EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(JobSystemTest, WaitingThreadRunsJobsWithoutWorkers) {
+  // given
+  resin::JobSystem system(0);
+  resin::JobGroup group;
+  resin::Job job;
+  std::thread::id runner;
+  job.function = [&runner] { runner = std::this_thread::get_id(); };
+
+  // when
+  system.schedule(job, group);
+  system.wait(group);
+
+  // then
+  EXPECT_EQ(system.thread_count(), 1);
+  EXPECT_EQ(runner, std::this_thread::get_id());
+}
+
+TEST(JobSystemTest, WaitRethrowsTheExceptionOfAJob) {
+  // given
+  resin::JobSystem system(2);
+  resin::JobGroup group;
+  resin::Job failing;
+  resin::Job passing;
+  std::atomic<bool> passed = false;
+  failing.function         = [] { throw std::runtime_error("job failed"); };
+  passing.function         = [&passed] { passed.store(true); };
+
+  // when
+  system.schedule(failing, group);
+  system.schedule(passing, group);
+
+  // then
+  EXPECT_THROW(system.wait(group), std::runtime_error);
+  EXPECT_TRUE(passed.load());
+  EXPECT_NO_THROW(system.wait(group));
+}
+
+TEST(JobSystemTest, JobsScheduledFromOtherThreadsAreRun) {
+  // given
+  resin::JobSystem system(2);
+  resin::JobGroup group;
+  std::atomic<int> counter = 0;
+  std::vector<resin::Job> jobs(1000);
+
+  // when
+  {
+    std::jthread producer([&] {
+      for (resin::Job& job : jobs) {
+        job.function = [&counter] { counter.fetch_add(1); };
+        system.schedule(job, group);
+      }
+    });
+  }
+  system.wait(group);
+
+  // then
+  EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(JobSystemTest, ParallelForCoversEveryIndexOnce) {
+  // given
+  resin::JobSystem system(3);
+  std::vector<std::atomic<int>> visits(10007);
+
+  // when
+  system.parallel_for(visits.size(), 64, [&visits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      visits[i].fetch_add(1);
+    }
+  });
+
+  // then
+  for (const auto& visit : visits) {
+    ASSERT_EQ(visit.load(), 1);
+  }
+}
+
+TEST(JobSystemTest, ParallelForOverSpanCanBeNested) {
+  // given
+  resin::JobSystem system(3);
+  std::vector<uint64_t> values(4096);
+  std::iota(values.begin(), values.end(), uint64_t{1});
+  std::atomic<uint64_t> sum = 0;
+
+  // when
+  system.parallel_for(std::span(values), 1024, [&system, &sum](std::span<uint64_t> chunk) {
+    system.parallel_for(chunk, 100, [&sum](std::span<uint64_t> inner) {
+      sum.fetch_add(std::accumulate(inner.begin(), inner.end(), uint64_t{0}));
+    });
+  });
+
+  // then
+  EXPECT_EQ(sum.load(), uint64_t{4096} * 4097 / 2);
+}
+
+TEST(JobSystemTest, ParallelForRethrowsAfterAllChunksFinished) {
+  // given
+  resin::JobSystem system(3);
+  std::atomic<int> finished = 0;
+
+  // when / then
+  EXPECT_THROW(system.parallel_for(64, 1,
+                                   [&finished](size_t begin, size_t) {
+                                     if (begin == 0) {
+                                       throw std::runtime_error("chunk failed");
+                                     }
+                                     finished.fetch_add(1);
+                                   }),
+               std::runtime_error);
+  EXPECT_EQ(finished.load(), 63);
+}
+
+TEST(TaskGraphTest, TasksRunAfterTheirPredecessors) {
+  // given
+  resin::JobSystem system(3);
+  resin::TaskGraph graph;
+  std::atomic<int> step = 0;
+  std::array<int, 4> order{};
+
+  // a -> (b, c) -> d
+  const auto a = graph.add([&] { order[0] = step.fetch_add(1); });
+  const auto b = graph.add([&] { order[1] = step.fetch_add(1); });
+  const auto c = graph.add([&] { order[2] = step.fetch_add(1); });
+  const auto d = graph.add([&] { order[3] = step.fetch_add(1); });
+  graph.precede(a, b);
+  graph.precede(a, c);
+  graph.precede(b, d);
+  graph.precede(c, d);
+
+  for (int run = 0; run < 3; ++run) {
+    // when
+    step.store(0);
+    graph.run(system);
+
+    // then
+    EXPECT_EQ(order[0], 0);
+    EXPECT_LT(order[1], order[3]);
+    EXPECT_LT(order[2], order[3]);
+    EXPECT_EQ(order[3], 3);
+  }
+}
+
+TEST(TaskGraphTest, RejectsCyclesAndUnknownTasks) {
+  // given
+  resin::JobSystem system(1);
+  resin::TaskGraph graph;
+  const auto a = graph.add([] {});
+  const auto b = graph.add([] {});
+
+  // when
+  graph.precede(a, b);
+  graph.precede(b, a);
+
+  // then
+  EXPECT_THROW(graph.precede(a, 2), std::out_of_range);
+  EXPECT_THROW(graph.run(system), std::invalid_argument);
+}
+
+TEST(TaskGraphTest, SuccessorsOfAFailedTaskAreNotRun) {
+  // given
+  resin::JobSystem system(2);
+  resin::TaskGraph graph;
+  std::atomic<bool> successor_ran = false;
+  const auto failing              = graph.add([] { throw std::runtime_error("task failed"); });
+  const auto successor            = graph.add([&successor_ran] { successor_ran.store(true); });
+  graph.precede(failing, successor);
+
+  // when / then
+  EXPECT_THROW(graph.run(system), std::runtime_error);
+  EXPECT_FALSE(successor_ran.load());
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <format>
+#include <libresin/utils/log_args.hpp>
+#include <string>
+#include <tuple>
+
+namespace {
+
+struct Point {
+  int x;
+  int y;
+};
+
+template <typename... Args>
+std::string encode_and_format(std::string_view fmt, const Args&... args) {
+  std::array<std::byte, resin::kMaxLogArgsSize> buffer{};
+  const size_t size = resin::encode_log_args(buffer, args...);
+
+  std::string out;
+  resin::format_log_message(out, fmt, std::span(buffer).first(size));
+  return out;
+}
+
+}  // namespace
+
+template <>
+struct std::formatter<Point> {
+  constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+  auto format(const Point& p, std::format_context& ctx) const {
+    return std::format_to(ctx.out(), "({}, {})", p.x, p.y);
+  }
+};
+
+TEST(LogArgsTest, ScalarsAndStringsRoundTrip) {
+  // given
+  const std::string str = "resin";
+  const char* c_str     = "sdf";
+
+  // when
+  const std::string message = encode_and_format("{} {} {} {} {} {} {} {}", true, 'c', -42, 42U, 1.5F, 0.1, str, c_str);
+
+  // then
+  EXPECT_EQ(message, "true c -42 42 1.5 0.1 resin sdf");
+}
+
+TEST(LogArgsTest, FormatSpecsAreForwarded) {
+  // given / when
+  const std::string message = encode_and_format("{0:>4}|{1:.2f}|{2:x}|{3:<3}|{1}", 7, 3.14159, 255U, "ab");
+
+  // then
+  EXPECT_EQ(message, "   7|3.14|ff|ab |3.14159");
+}
+
+TEST(LogArgsTest, CustomTypesAreFormattedEagerly) {
+  // given
+  const Point point{.x = 1, .y = 2};
+
+  // when
+  const std::string message = encode_and_format("point: {}", point);
+
+  // then
+  EXPECT_EQ(message, "point: (1, 2)");
+}
+
+TEST(LogArgsTest, LongStringsAreTruncated) {
+  // given
+  const std::string str(2 * resin::kMaxLogArgsSize, 'x');
+
+  // when
+  const std::string message = encode_and_format("{}{}", str, 5);
+
+  // then
+  EXPECT_LT(message.size(), resin::kMaxLogArgsSize);
+  EXPECT_EQ(message.find_first_not_of('x'), std::string::npos);
+}
+
+TEST(LogArgsTest, FormatErrorsDoNotThrow) {
+  // given / when
+  const std::string message = encode_and_format("{:d}", "not a number");
+
+  // then
+  EXPECT_FALSE(message.empty());
+}
+
+TEST(LogArgsTest, RefFormatsLossyArgumentsFromTheOriginalValues) {
+  // given
+  const std::string str(2 * resin::kMaxLogArgsSize, 'x');
+  const int count         = 5;
+  const long double value = 3.14159L;
+  const std::tuple<const std::string&, const int&> long_args(str, count);
+  const std::tuple<const long double&> custom_args(value);
+  const resin::LogArgsRef long_ref(long_args);
+  const resin::LogArgsRef custom_ref(custom_args);
+
+  // when
+  std::array<std::byte, resin::kMaxLogArgsSize> buffer{};
+  const size_t long_size = long_ref.encode(buffer);
+  std::string long_message;
+  long_ref.format(long_message, "{}{}");
+
+  const size_t custom_size = custom_ref.encode_message(buffer, "{:.2f}");
+  std::string custom_message;
+  resin::format_log_message(custom_message, "{}", std::span(buffer).first(custom_size));
+
+  // then
+  EXPECT_TRUE(long_ref.exact("{}{}"));
+  EXPECT_EQ(long_size, buffer.size());
+  EXPECT_EQ(long_message, str + "5");
+
+  EXPECT_FALSE(custom_ref.exact("{:.2f}"));
+  EXPECT_EQ(custom_message, "3.14");
+}
+
+TEST(LogArgsTest, DynamicSpecsAreFormattedEagerly) {
+  // given
+  const double value  = 3.14159;
+  const int width     = 8;
+  const int precision = 2;
+  const std::tuple<const double&, const int&, const int&> args(value, width, precision);
+  const resin::LogArgsRef ref(args);
+
+  // when
+  std::array<std::byte, resin::kMaxLogArgsSize> buffer{};
+  const size_t size = ref.encode_message(buffer, "[{:{}.{}f}]");
+  std::string message;
+  resin::format_log_message(message, "{}", std::span(buffer).first(size));
+
+  // then
+  EXPECT_TRUE(ref.exact("{{{:.2f}}} {} {}"));
+  EXPECT_FALSE(ref.exact("[{:{}.{}f}]"));
+  EXPECT_FALSE(ref.exact("{:{}}"));
+  EXPECT_EQ(message, "[    3.14]");
+}
@@ -0,0 +1,497 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <libresin/utils/logger.hpp>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <source_location>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class NullScribe : public resin::LoggerScribe {
+ public:
+  NullScribe() : LoggerScribe(resin::LogLevel::Debug) {}
+
+  void log(const resin::LogRecord& /*record*/) override {}
+};
+
+// Messages received by a `CollectingScribe`, shared with the test since the logger owns the scribe.
+struct CollectedMessages {
+  std::mutex mutex;
+  std::vector<std::string> messages;
+  // When set, the next message blocks the scribe until `resume` is released
+  std::atomic<bool> hold = false;
+  std::binary_semaphore held{0};
+  std::binary_semaphore resume{0};
+
+  std::vector<std::string> get() {
+    const std::lock_guard lock(mutex);
+    return messages;
+  }
+};
+
+class CollectingScribe : public resin::LoggerScribe {
+ public:
+  explicit CollectingScribe(std::shared_ptr<CollectedMessages> collected)
+      : LoggerScribe(resin::LogLevel::Debug), collected_(std::move(collected)) {}
+
+  void log(const resin::LogRecord& record) override {
+    {
+      const std::lock_guard lock(collected_->mutex);
+      collected_->messages.emplace_back(record.message());
+    }
+    if (collected_->hold.exchange(false)) {
+      collected_->held.release();
+      collected_->resume.acquire();
+    }
+  }
+
+ private:
+  std::shared_ptr<CollectedMessages> collected_;
+};
+
+class LoggerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { resin::Logger::get_instance().add_scribe(std::make_unique<NullScribe>()); }
+
+  void TearDown() override {
+    auto& logger = resin::Logger::get_instance();
+    logger.set_level(resin::Logger::kDefaultLevel);
+    logger.reset_category_level("test_category");
+  }
+};
+
+class AsyncLoggerTest : public ::testing::Test {
+ protected:
+  AsyncLoggerTest() { logger_->add_scribe(std::make_unique<CollectingScribe>(collected_)); }
+
+  void log(const std::string_view fmt, const int value) {
+    logger_->log(resin::LogLevel::Info, false, std::source_location::current(), fmt, value);
+  }
+
+  // Blocks the logging thread inside the scribe, so that the queue fills up
+  void block_backend() {
+    collected_->hold = true;
+    log("held {}", 0);
+    collected_->held.acquire();
+  }
+
+  std::shared_ptr<CollectedMessages> collected_ = std::make_shared<CollectedMessages>();
+  std::unique_ptr<resin::Logger> logger_        = std::make_unique<resin::Logger>();
+};
+
+// Returns the timestamp of a line written by `append_log_text`.
+std::string log_text_timestamp(const std::chrono::time_point<std::chrono::system_clock>& time_point,
+                               resin::LogTimestampMode mode) {
+  const resin::LogLocation location{.file_path = "file.cpp", .function_name = "function", .line = 1, .column = 1};
+  std::string message_buffer;
+  const resin::LogRecord record(time_point, mode, location, resin::LogLevel::Info, false, "message", {},
+                                message_buffer);
+
+  std::string text;
+  resin::append_log_text(text, record);
+  const size_t end = text.find(']');
+  return text.substr(text.rfind(' ', end) + 1, end - text.rfind(' ', end) - 1);
+}
+
+class RotatedFileLoggerScribeTest : public ::testing::Test {
+ protected:
+  RotatedFileLoggerScribeTest() {
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+  }
+
+  ~RotatedFileLoggerScribeTest() override { std::filesystem::remove_all(dir_); }
+
+  static void log(resin::LoggerScribe& scribe, const std::string& message,
+                  const std::chrono::time_point<std::chrono::system_clock>& time_point =
+                      std::chrono::system_clock::now()) {
+    const resin::LogLocation location{.file_path = "file.cpp", .function_name = "function", .line = 1, .column = 1};
+    std::string message_buffer = message;
+    const resin::LogRecord record(time_point, resin::LogTimestampMode::WallClock, location, resin::LogLevel::Info,
+                                  false, "", {}, message_buffer, true);
+    scribe.log(record);
+  }
+
+  // Log files in the directory from the oldest to the newest
+  std::vector<std::filesystem::path> files() const {
+    std::vector<std::filesystem::path> result;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+      if (entry.path().filename().string().starts_with("resin_logs_")) {
+        result.push_back(entry.path());
+      }
+    }
+    std::ranges::sort(result);
+    return result;
+  }
+
+  static std::string read(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+
+  std::filesystem::path dir_ = std::filesystem::temp_directory_path() / "resin_rotated_file_logger_scribe_test";
+};
+
+}  // namespace
+
+TEST(LogLevelTest, ParsesLevelNames) {
+  EXPECT_EQ(resin::parse_log_level("error"), resin::LogLevel::Err);
+  EXPECT_EQ(resin::parse_log_level("warn"), resin::LogLevel::Warn);
+  EXPECT_EQ(resin::parse_log_level("info"), resin::LogLevel::Info);
+  EXPECT_EQ(resin::parse_log_level("debug"), resin::LogLevel::Debug);
+  EXPECT_FALSE(resin::parse_log_level("verbose").has_value());
+}
+
+TEST(LogTextTest, MonotonicTimestampsHaveMicroseconds) {
+  // given
+  const std::chrono::time_point<std::chrono::system_clock> second(std::chrono::seconds(1700000000));
+
+  // when
+  const std::string wall_clock = log_text_timestamp(second + std::chrono::microseconds(123456),
+                                                    resin::LogTimestampMode::WallClock);
+  const std::string monotonic  = log_text_timestamp(second + std::chrono::microseconds(123456),
+                                                    resin::LogTimestampMode::Monotonic);
+  const std::string padded     = log_text_timestamp(second + std::chrono::microseconds(42),
+                                                    resin::LogTimestampMode::Monotonic);
+
+  // then
+  EXPECT_EQ(wall_clock.size(), 8U);
+  EXPECT_EQ(monotonic, wall_clock + ".123456");
+  EXPECT_EQ(padded, wall_clock + ".000042");
+}
+
+TEST(LogTextTest, TimeChangesOnlyWithTheSecond) {
+  // given
+  const std::chrono::time_point<std::chrono::system_clock> second(std::chrono::seconds(1700000000));
+  const auto timestamp = [](const std::chrono::time_point<std::chrono::system_clock>& time_point) {
+    return log_text_timestamp(time_point, resin::LogTimestampMode::WallClock);
+  };
+
+  // when
+  const std::string first = timestamp(second);
+  const std::string same  = timestamp(second + std::chrono::milliseconds(999));
+  const std::string next  = timestamp(second + std::chrono::seconds(1));
+  const std::string back  = timestamp(second + std::chrono::milliseconds(500));
+
+  // then
+  EXPECT_EQ(same, first);
+  EXPECT_NE(next, first);
+  EXPECT_EQ(next.substr(0, 6), first.substr(0, 6));
+  EXPECT_EQ(back, first);
+}
+
+TEST_F(LoggerTest, CategoryFollowsLoggerLevel) {
+  // given
+  const resin::LogCategory category("test_category");
+
+  // when
+  resin::Logger::get_instance().set_level(resin::LogLevel::Warn);
+
+  // then
+  EXPECT_TRUE(category.is_enabled(resin::LogLevel::Err));
+  EXPECT_TRUE(category.is_enabled(resin::LogLevel::Warn));
+  EXPECT_FALSE(category.is_enabled(resin::LogLevel::Info));
+  EXPECT_FALSE(resin::Logger::get_instance().default_category().is_enabled(resin::LogLevel::Info));
+}
+
+TEST_F(LoggerTest, CategoryLevelOverridesLoggerLevel) {
+  // given
+  auto& logger = resin::Logger::get_instance();
+  logger.set_category_level("test_category", resin::LogLevel::Debug);
+
+  // when
+  const resin::LogCategory category("test_category");
+  logger.set_level(resin::LogLevel::Err);
+
+  // then
+  EXPECT_TRUE(category.is_enabled(resin::LogLevel::Debug));
+  EXPECT_FALSE(logger.default_category().is_enabled(resin::LogLevel::Warn));
+
+  // when
+  logger.reset_category_level("test_category");
+
+  // then
+  EXPECT_FALSE(category.is_enabled(resin::LogLevel::Warn));
+}
+
+TEST_F(LoggerTest, SetsLevelsFromList) {
+  // given
+  auto& logger = resin::Logger::get_instance();
+  const resin::LogCategory category("test_category");
+
+  // when
+  logger.set_levels("warn,test_category=debug");
+
+  // then
+  EXPECT_TRUE(category.is_enabled(resin::LogLevel::Debug));
+  EXPECT_TRUE(logger.default_category().is_enabled(resin::LogLevel::Warn));
+  EXPECT_FALSE(logger.default_category().is_enabled(resin::LogLevel::Info));
+  EXPECT_THROW(logger.set_levels("info,=debug"), std::invalid_argument);
+  EXPECT_THROW(logger.set_levels("test_category=loud"), std::invalid_argument);
+}
+
+TEST_F(AsyncLoggerTest, FlushWritesQueuedMessages) {
+  // given
+  logger_->enable_async();
+
+  // when
+  log("message {}", 1);
+  log("message {:03}", 2);
+  logger_->flush();
+
+  // then
+  EXPECT_TRUE(logger_->is_async());
+  EXPECT_EQ(collected_->get(), (std::vector<std::string>{"message 1", "message 002"}));
+}
+
+TEST_F(AsyncLoggerTest, BlockPolicyKeepsAllMessages) {
+  // given
+  constexpr int kMessages = 1000;
+  logger_->enable_async(4, resin::LogQueuePolicy::Block);
+
+  // when
+  for (int i = 0; i < kMessages; ++i) {
+    log("{}", i);
+  }
+  logger_->flush();
+
+  // then
+  const std::vector<std::string> messages = collected_->get();
+  ASSERT_EQ(messages.size(), static_cast<size_t>(kMessages));
+  for (int i = 0; i < kMessages; ++i) {
+    EXPECT_EQ(messages[static_cast<size_t>(i)], std::to_string(i));
+  }
+  EXPECT_EQ(logger_->dropped_count(), 0U);
+}
+
+TEST_F(AsyncLoggerTest, DropPolicyDiscardsNewMessages) {
+  // given
+  logger_->enable_async(4, resin::LogQueuePolicy::Drop);
+  block_backend();
+
+  // when
+  for (int i = 1; i <= 10; ++i) {
+    log("{}", i);
+  }
+  collected_->resume.release();
+  logger_->flush();
+
+  // then
+  EXPECT_EQ(collected_->get(), (std::vector<std::string>{"held 0", "1", "2", "3", "4"}));
+  EXPECT_EQ(logger_->dropped_count(), 6U);
+}
+
+TEST_F(AsyncLoggerTest, OverwritePolicyDiscardsOldMessages) {
+  // given
+  logger_->enable_async(4, resin::LogQueuePolicy::Overwrite);
+  block_backend();
+
+  // when
+  for (int i = 1; i <= 10; ++i) {
+    log("{}", i);
+  }
+  collected_->resume.release();
+  logger_->flush();
+
+  // then
+  EXPECT_EQ(collected_->get(), (std::vector<std::string>{"held 0", "7", "8", "9", "10"}));
+  EXPECT_EQ(logger_->dropped_count(), 6U);
+}
+
+TEST_F(AsyncLoggerTest, DeliversMessagesOfAllThreads) {
+  // given
+  constexpr int kThreads  = 4;
+  constexpr int kMessages = 500;
+  logger_->enable_async(16, resin::LogQueuePolicy::Block);
+
+  // when
+  std::vector<std::jthread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([this, t] {
+      for (int i = 0; i < kMessages; ++i) {
+        log("{}", t * kMessages + i);
+      }
+    });
+  }
+  threads.clear();
+  logger_->disable_async();
+
+  // then
+  std::vector<int> values;
+  for (const std::string& message : collected_->get()) {
+    values.push_back(std::stoi(message));
+  }
+  std::ranges::sort(values);
+  ASSERT_EQ(values.size(), static_cast<size_t>(kThreads * kMessages));
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], static_cast<int>(i));
+  }
+  EXPECT_FALSE(logger_->is_async());
+}
+
+TEST_F(AsyncLoggerTest, DisablingWhileLoggingLosesNoMessages) {
+  // given
+  std::atomic<int> logged = 0;
+  std::atomic<bool> stop  = false;
+  logger_->enable_async(16, resin::LogQueuePolicy::Block);
+  std::jthread thread([&] {
+    while (!stop) {
+      log("{}", logged.load());
+      ++logged;
+    }
+  });
+
+  // when
+  while (logged < 100) {
+    std::this_thread::yield();
+  }
+  logger_->disable_async();
+  stop = true;
+  thread.join();
+
+  // then
+  EXPECT_EQ(collected_->get().size(), static_cast<size_t>(logged.load()));
+}
+
+TEST_F(AsyncLoggerTest, DestroyingLoggerWritesQueuedMessages) {
+  // given
+  logger_->enable_async();
+  for (int i = 0; i < 100; ++i) {
+    log("{}", i);
+  }
+
+  // when
+  logger_.reset();
+
+  // then
+  const std::vector<std::string> messages = collected_->get();
+  ASSERT_EQ(messages.size(), 100U);
+  EXPECT_EQ(messages.back(), "99");
+}
+
+TEST_F(RotatedFileLoggerScribeTest, WritesBufferedMessagesWhenDestroyed) {
+  // given
+  auto scribe = std::make_unique<resin::RotatedFileLoggerScribe>(dir_, 4);
+  log(*scribe, "first message");
+  log(*scribe, "second message");
+
+  // when
+  scribe.reset();
+
+  // then
+  const auto log_files = files();
+  ASSERT_EQ(log_files.size(), 1U);
+  const std::string text = read(log_files[0]);
+  EXPECT_NE(text.find("first message\n"), std::string::npos);
+  EXPECT_NE(text.find("second message\n"), std::string::npos);
+}
+
+TEST_F(RotatedFileLoggerScribeTest, RotatesBySize) {
+  // given
+  constexpr size_t kMaxFileSize = 100;
+  auto scribe = std::make_unique<resin::RotatedFileLoggerScribe>(
+      dir_, resin::LogRotation{.max_backups = 10, .max_file_size = kMaxFileSize});
+
+  // when
+  for (int i = 0; i < 10; ++i) {
+    log(*scribe, std::format("message {}", i));
+  }
+  scribe.reset();
+
+  // then
+  const auto log_files = files();
+  ASSERT_GT(log_files.size(), 1U);
+  std::string text;
+  for (size_t i = 0; i < log_files.size(); ++i) {
+    const std::string file_text = read(log_files[i]);
+    if (i + 1 < log_files.size()) {
+      EXPECT_GE(file_text.size(), kMaxFileSize);
+    }
+    text += file_text;
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NE(text.find(std::format("message {}\n", i)), std::string::npos);
+  }
+}
+
+TEST_F(RotatedFileLoggerScribeTest, RotatesByAge) {
+  // given
+  const auto now = std::chrono::system_clock::now();
+  auto scribe    = std::make_unique<resin::RotatedFileLoggerScribe>(
+      dir_, resin::LogRotation{.max_file_age = std::chrono::seconds(60)});
+
+  // when
+  log(*scribe, "early message", now);
+  log(*scribe, "still early message", now + std::chrono::seconds(30));
+  log(*scribe, "late message", now + std::chrono::seconds(61));
+  scribe.reset();
+
+  // then
+  const auto log_files = files();
+  ASSERT_EQ(log_files.size(), 2U);
+  EXPECT_NE(read(log_files[0]).find("still early message"), std::string::npos);
+  EXPECT_EQ(read(log_files[0]).find("late message"), std::string::npos);
+  EXPECT_NE(read(log_files[1]).find("late message"), std::string::npos);
+}
+
+TEST_F(RotatedFileLoggerScribeTest, DeletesOldBackups) {
+  // given
+  for (int i = 0; i < 3; ++i) {
+    std::ofstream(dir_ / std::format("resin_logs_2000-01-01T00-00-0{}.txt", i)) << "old";
+  }
+  std::ofstream(dir_ / "notes.txt") << "not a log";
+
+  // when
+  auto scribe = std::make_unique<resin::RotatedFileLoggerScribe>(
+      dir_, resin::LogRotation{.max_backups = 3, .max_file_size = 1});
+  const size_t files_after_start = files().size();
+  for (int i = 0; i < 4; ++i) {
+    log(*scribe, std::format("message {}", i));
+  }
+  scribe.reset();
+
+  // then
+  const auto log_files = files();
+  EXPECT_EQ(files_after_start, 3U);
+  ASSERT_EQ(log_files.size(), 3U);
+  for (const auto& path : log_files) {
+    EXPECT_FALSE(path.filename().string().starts_with("resin_logs_2000")) << path;
+  }
+  EXPECT_NE(read(log_files.back()).find("message 3"), std::string::npos);
+  EXPECT_TRUE(std::filesystem::exists(dir_ / "notes.txt"));
+}
+
+TEST_F(RotatedFileLoggerScribeTest, CompressesRotatedFiles) {
+  // given
+  auto scribe = std::make_unique<resin::RotatedFileLoggerScribe>(
+      dir_, resin::LogRotation{.max_backups = 4, .max_file_size = 1, .compress = true});
+
+  // when
+  log(*scribe, "first message");
+  log(*scribe, "second message");
+  scribe.reset();
+
+  // then
+  const auto log_files = files();
+  ASSERT_EQ(log_files.size(), 2U);
+  EXPECT_EQ(log_files[0].extension(), ".gz");
+  EXPECT_FALSE(std::filesystem::exists(log_files[0].parent_path() / log_files[0].stem()));
+  const std::string compressed = read(log_files[0]);
+  ASSERT_GE(compressed.size(), 2U);
+  EXPECT_EQ(static_cast<unsigned char>(compressed[0]), 0x1FU);
+  EXPECT_EQ(static_cast<unsigned char>(compressed[1]), 0x8BU);
+  EXPECT_NE(read(log_files[1]).find("second message"), std::string::npos);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <libresin/utils/mesh_writer.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+uint32_t read_u32(const std::string& data, size_t offset) {
+  uint32_t value = 0;
+  std::memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+// Square split into two triangles, written in two parts like a mesher writes its chunks
+void write_square(resin::MeshWriter& writer) {
+  const std::vector<glm::vec3> first  = {glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(1, 1, 0)};
+  const std::vector<glm::vec3> second = {glm::vec3(0, 1, 0)};
+  const std::vector<uint32_t> lower   = {0, 1, 2};
+  const std::vector<uint32_t> upper   = {0, 2, 3};
+  writer.write_vertices(first);
+  writer.write_triangles(lower);
+  writer.write_vertices(second);
+  writer.write_triangles(upper);
+  writer.finish();
+}
+
+}  // namespace
+
+TEST(MeshWriterTest, PlyHasBinaryVerticesAndFaces) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_mesh_writer_test.ply";
+
+  // when
+  {
+    resin::PlyMeshWriter writer(path);
+    write_square(writer);
+  }
+
+  // then
+  const std::string data = read_file(path);
+  const size_t end       = data.find("end_header\n");
+  ASSERT_NE(end, std::string::npos);
+  const size_t body = end + std::strlen("end_header\n");
+
+  std::istringstream header(data.substr(0, body));
+  std::string line;
+  std::vector<std::string> elements;
+  while (std::getline(header, line)) {
+    if (line.starts_with("element")) {
+      elements.push_back(line);
+    }
+  }
+  ASSERT_EQ(elements.size(), 2);
+  EXPECT_EQ(std::stoul(elements[0].substr(std::strlen("element vertex "))), 4);
+  EXPECT_EQ(std::stoul(elements[1].substr(std::strlen("element face "))), 2);
+
+  ASSERT_EQ(data.size(), body + 4 * 3 * sizeof(float) + 2 * (1 + 3 * sizeof(uint32_t)));
+  float y = 0.0F;
+  std::memcpy(&y, data.data() + body + (3 * 3 + 1) * sizeof(float), sizeof(y));
+  EXPECT_EQ(y, 1.0F);
+  const size_t faces = body + 4 * 3 * sizeof(float);
+  EXPECT_EQ(data[faces], 3);
+  EXPECT_EQ(read_u32(data, faces + 1 + 13), 0);
+  EXPECT_EQ(read_u32(data, faces + 1 + 13 + 8), 3);
+  EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(path).concat(".faces")));
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshWriterTest, ObjInterleavesVerticesAndFaces) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_mesh_writer_test.obj";
+
+  // when
+  {
+    resin::ObjMeshWriter writer(path);
+    write_square(writer);
+  }
+
+  // then
+  EXPECT_EQ(read_file(path), "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\nv 0 1 0\nf 1 3 4\n");
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshWriterTest, GlbHasConsistentChunks) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_mesh_writer_test.glb";
+
+  // when
+  {
+    resin::GlbMeshWriter writer(path);
+    write_square(writer);
+  }
+
+  // then
+  const std::string data = read_file(path);
+  ASSERT_GE(data.size(), 20);
+  EXPECT_EQ(data.substr(0, 4), "glTF");
+  EXPECT_EQ(read_u32(data, 4), 2);
+  EXPECT_EQ(read_u32(data, 8), data.size());
+
+  const uint32_t json_size = read_u32(data, 12);
+  EXPECT_EQ(json_size % 4, 0);
+  EXPECT_EQ(data.substr(16, 4), "JSON");
+  const std::string json = data.substr(20, json_size);
+  EXPECT_NE(json.find(R"("count":4,"type":"VEC3","min":[0,0,0],"max":[1,1,0])"), std::string::npos);
+  EXPECT_NE(json.find(R"("count":6,"type":"SCALAR")"), std::string::npos);
+
+  const size_t bin = 20 + json_size;
+  EXPECT_EQ(read_u32(data, bin), 4 * sizeof(glm::vec3) + 6 * sizeof(uint32_t));
+  EXPECT_EQ(data.substr(bin + 4, 4), std::string("BIN\0", 4));
+  EXPECT_EQ(read_u32(data, bin + 8 + 4 * sizeof(glm::vec3) + 5 * sizeof(uint32_t)), 3);
+  EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(path).concat(".indices")));
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshWriterTest, EmptyGlbHasNoBinaryChunk) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_mesh_writer_empty_test.glb";
+
+  // when
+  {
+    resin::GlbMeshWriter writer(path);
+    writer.finish();
+  }
+
+  // then
+  const std::string data = read_file(path);
+  EXPECT_EQ(read_u32(data, 8), data.size());
+  EXPECT_EQ(data.size(), 20 + read_u32(data, 12));
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshWriterTest, InvalidTrianglesThrow) {
+  // given
+  const auto path = std::filesystem::temp_directory_path() / "resin_mesh_writer_invalid_test.obj";
+  resin::ObjMeshWriter writer(path);
+  const std::vector<glm::vec3> vertices(3);
+  writer.write_vertices(vertices);
+  const std::vector<uint32_t> unknown_vertex = {0, 1, 3};
+  const std::vector<uint32_t> incomplete     = {0, 1};
+
+  // when / then
+  EXPECT_THROW(writer.write_triangles(unknown_vertex), std::out_of_range);
+  EXPECT_THROW(writer.write_triangles(incomplete), std::invalid_argument);
+
+  writer.finish();
+  std::filesystem::remove(path);
+}
+
+TEST(MeshWriterTest, FormatIsPickedByExtension) {
+  // given
+  const auto directory = std::filesystem::temp_directory_path();
+
+  // when / then
+  EXPECT_NE(dynamic_cast<resin::PlyMeshWriter*>(resin::create_mesh_writer(directory / "resin_a.ply").get()), nullptr);
+  EXPECT_NE(dynamic_cast<resin::ObjMeshWriter*>(resin::create_mesh_writer(directory / "resin_a.obj").get()), nullptr);
+  EXPECT_NE(dynamic_cast<resin::GlbMeshWriter*>(resin::create_mesh_writer(directory / "resin_a.glb").get()), nullptr);
+  EXPECT_THROW(resin::create_mesh_writer(directory / "resin_a.stl"), std::invalid_argument);
+
+  for (const char* name : {"resin_a.ply", "resin_a.obj", "resin_a.glb"}) {
+    std::filesystem::remove(directory / name);
+  }
+}
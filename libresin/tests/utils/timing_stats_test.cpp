@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <libresin/utils/timing_stats.hpp>
+
+using namespace std::chrono_literals;
+
+TEST(TimingStatsTest, EmptyStatsSummarizeToZero) {
+  // given
+  resin::TimingStats stats;
+
+  // when
+  const resin::TimingSummary summary = stats.summarize();
+
+  // then
+  EXPECT_EQ(summary, resin::TimingSummary{});
+}
+
+TEST(TimingStatsTest, PercentilesUseNearestRank) {
+  // given
+  resin::TimingStats stats;
+
+  // when
+  for (int i = 100; i >= 1; --i) {
+    stats.record(std::chrono::milliseconds(i));
+  }
+  const resin::TimingSummary summary = stats.summarize();
+
+  // then
+  EXPECT_EQ(summary.count, 100);
+  EXPECT_EQ(summary.mean, 50500us);
+  EXPECT_EQ(summary.p50, 50ms);
+  EXPECT_EQ(summary.p95, 95ms);
+  EXPECT_EQ(summary.p99, 99ms);
+  EXPECT_EQ(summary.max, 100ms);
+}
+
+TEST(TimingStatsTest, KeepsOnlyTheMostRecentSamples) {
+  // given
+  resin::TimingStats stats;
+  for (size_t i = 0; i < resin::TimingStats::kCapacity; ++i) {
+    stats.record(1s);
+  }
+
+  // when
+  for (size_t i = 0; i < resin::TimingStats::kCapacity; ++i) {
+    stats.record(1ms);
+  }
+  const resin::TimingSummary summary = stats.summarize();
+
+  // then
+  EXPECT_EQ(summary.count, resin::TimingStats::kCapacity);
+  EXPECT_EQ(summary.max, 1ms);
+}
+
+TEST(TimingStatsTest, ResetStartsANewWindow) {
+  // given
+  resin::TimingStats stats;
+  stats.record(1s);
+
+  // when
+  stats.reset();
+  stats.record(2ms);
+  stats.record(4ms);
+
+  // then
+  EXPECT_EQ(stats.count(), 2);
+  EXPECT_EQ(stats.summarize().mean, 3ms);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <libresin/utils/triple_buffer.hpp>
+#include <thread>
+
+namespace {
+
+struct State {
+  uint64_t sequence = 0;
+  uint64_t check    = 0;
+};
+
+}  // namespace
+
+TEST(TripleBufferTest, ConsumerReadsInitialStateUntilPublished) {
+  // given
+  resin::TripleBuffer<int> buffer(7);
+
+  // when / then
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.read_buffer(), 7);
+}
+
+TEST(TripleBufferTest, ConsumerTakesOnlyTheNewestState) {
+  // given
+  resin::TripleBuffer<int> buffer;
+
+  // when
+  for (int i = 1; i <= 3; ++i) {
+    buffer.write_buffer() = i;
+    buffer.publish();
+  }
+
+  // then
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(buffer.read_buffer(), 3);
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.read_buffer(), 3);
+}
+
+TEST(TripleBufferTest, ConcurrentConsumerSeesCompleteStatesInOrder) {
+  // given
+  constexpr uint64_t kStates = 100000;
+  resin::TripleBuffer<State> buffer;
+  std::atomic<bool> done = false;
+  uint64_t last          = 0;
+  bool torn              = false;
+  bool ordered           = true;
+
+  // when
+  {
+    std::jthread consumer([&] {
+      while (true) {
+        const bool finished = done.load();
+        if (buffer.update()) {
+          const State& state = buffer.read_buffer();
+          torn |= state.check != state.sequence * 3;
+          ordered &= state.sequence > last;
+          last = state.sequence;
+        } else if (finished) {
+          break;
+        }
+      }
+    });
+
+    for (uint64_t i = 1; i <= kStates; ++i) {
+      State& state   = buffer.write_buffer();
+      state.sequence = i;
+      state.check    = i * 3;
+      buffer.publish();
+    }
+    done.store(true);
+  }
+
+  // then
+  EXPECT_FALSE(torn);
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(last, kStates);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <libresin/utils/work_stealing_deque.hpp>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(WorkStealingDequeTest, CapacityIsRoundedUpToPowerOfTwo) {
+  // given / when
+  const resin::WorkStealingDeque<int> deque(5);
+
+  // then
+  EXPECT_EQ(deque.capacity(), 8);
+  EXPECT_THROW(resin::WorkStealingDeque<int>(0), std::invalid_argument);
+}
+
+TEST(WorkStealingDequeTest, OwnerPopsInLifoOrderAndThiefStealsInFifoOrder) {
+  // given
+  resin::WorkStealingDeque<int> deque(4);
+
+  // when
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(deque.push(i));
+  }
+
+  // then
+  EXPECT_FALSE(deque.push(4));
+  EXPECT_EQ(deque.size_approx(), 4);
+  EXPECT_EQ(deque.steal(), 0);
+  EXPECT_EQ(deque.pop(), 3);
+  EXPECT_EQ(deque.steal(), 1);
+  EXPECT_EQ(deque.pop(), 2);
+  EXPECT_EQ(deque.pop(), std::nullopt);
+  EXPECT_EQ(deque.steal(), std::nullopt);
+  EXPECT_TRUE(deque.empty_approx());
+}
+
+TEST(WorkStealingDequeTest, CellsAreReusedAfterWrapAround) {
+  // given
+  resin::WorkStealingDeque<int> deque(2);
+
+  for (int i = 0; i < 10; ++i) {
+    // when
+    ASSERT_TRUE(deque.push(i));
+    ASSERT_TRUE(deque.push(i + 100));
+
+    // then
+    EXPECT_EQ(deque.steal(), i);
+    EXPECT_EQ(deque.pop(), i + 100);
+  }
+}
+
+TEST(WorkStealingDequeTest, EveryValueIsTakenExactlyOnceByOwnerOrThieves) {
+  // given
+  constexpr uint64_t kThieves = 3;
+  constexpr uint64_t kValues  = 100000;
+  resin::WorkStealingDeque<uint64_t> deque(64);
+  std::vector<uint64_t> sums(kThieves + 1, 0);
+  std::atomic<bool> done = false;
+
+  // when
+  {
+    std::vector<std::jthread> thieves;
+    for (uint64_t t = 0; t < kThieves; ++t) {
+      thieves.emplace_back([&deque, &done, &sum = sums[t]] {
+        while (!done.load() || !deque.empty_approx()) {
+          if (const auto value = deque.steal()) {
+            sum += *value;
+          }
+        }
+      });
+    }
+
+    uint64_t& sum = sums[kThieves];
+    for (uint64_t i = 1; i <= kValues; ++i) {
+      while (!deque.push(i)) {
+        if (const auto value = deque.pop()) {
+          sum += *value;
+        }
+      }
+      // Keeps the deque short, so that the owner and the thieves often race for the last value
+      if (i % 2 == 0) {
+        if (const auto value = deque.pop()) {
+          sum += *value;
+        }
+      }
+    }
+    done.store(true);
+  }
+
+  // then
+  uint64_t total = 0;
+  for (const uint64_t sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(total, kValues * (kValues + 1) / 2);
+  EXPECT_TRUE(deque.empty_approx());
+}
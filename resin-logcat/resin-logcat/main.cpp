@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <libresin/utils/binary_log.hpp>
+#include <libresin/utils/logger.hpp>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::byte> read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("could not open the file");
+  }
+
+  const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<std::byte> data(content.size());
+  std::transform(content.begin(), content.end(), data.begin(), [](char c) { return static_cast<std::byte>(c); });
+  return data;
+}
+
+void decode(const std::filesystem::path& path) {
+  const std::vector<std::byte> data = read_file(path);
+  resin::BinaryLogReader reader(data);
+
+  std::string message_buffer;
+  while (const auto message = reader.next()) {
+    const resin::BinaryLogCallsite& callsite = *message->callsite;
+    const resin::LogRecord record(message->time_point, message->timestamp_mode, callsite.location, callsite.level,
+                                  callsite.is_debug_msg, callsite.fmt, message->args, message_buffer);
+    resin::write_log_text(std::cout, record);
+  }
+}
+
+}  // namespace
+
+// Converts binary logs written by `resin::BinaryFileLoggerScribe` to the text format and prints them to stdout.
+int main(int argc, char* argv[]) {
+  const std::span<char*> args(argv, static_cast<size_t>(argc));
+  if (args.size() < 2) {
+    std::println(std::cerr, "Usage: {} <log.rlog>...", args[0]);
+    return 1;
+  }
+
+  for (const char* arg : args.subspan(1)) {
+    try {
+      decode(arg);
+    } catch (const std::exception& e) {
+      std::cout.flush();
+      std::println(std::cerr, "{}: {}", arg, e.what());
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <chrono>
+#include <resin/core/frame_scheduler.hpp>
+#include <thread>
+
+namespace resin {
+
+FrameScheduler::FrameScheduler(clock::duration frame_time)
+    : frame_time_(frame_time),
+      next_frame_(clock::now() + frame_time),
+      sleep_error_mean_(std::chrono::microseconds(100)),
+      sleep_error_deviation_(std::chrono::microseconds(100)) {}
+
+void FrameScheduler::set_frame_time(clock::duration frame_time) {
+  frame_time_ = frame_time;
+  next_frame_ = clock::now() + frame_time;
+}
+
+void FrameScheduler::wait_for_next_frame() {
+  if (frame_time_ <= clock::duration::zero()) {
+    return;
+  }
+
+  const clock::time_point now = clock::now();
+  if (now < next_frame_) {
+    sleep_until(next_frame_);
+  }
+
+  next_frame_ += frame_time_;
+  // After a stall longer than a frame the lost time is not made up with frames in quick succession
+  if (next_frame_ < now) {
+    next_frame_ = now + frame_time_;
+  }
+}
+
+void FrameScheduler::sleep_until(clock::time_point deadline) {
+  clock::time_point now = clock::now();
+  while (deadline - now > kSleepStep + sleep_error_mean_ + 2 * sleep_error_deviation_) {
+    std::this_thread::sleep_for(kSleepStep);
+    const clock::time_point woken = clock::now();
+    record_sleep(kSleepStep, woken - now);
+    now = woken;
+  }
+
+  while (clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+void FrameScheduler::record_sleep(clock::duration requested, clock::duration slept) {
+  // Exponential moving averages with a weight of 1/8 for the new sample. Rare long preemptions cannot be predicted
+  // anyway, so the samples are clamped to keep them from turning the next frames into spinning.
+  const clock::duration error = std::clamp(slept - requested, clock::duration::zero(), kMaxSleepError);
+  sleep_error_mean_ += (error - sleep_error_mean_) / 8;
+  sleep_error_deviation_ += (std::chrono::abs(error - sleep_error_mean_) - sleep_error_deviation_) / 8;
+}
+
+}  // namespace resin
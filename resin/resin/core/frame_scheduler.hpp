@@ -0,0 +1,51 @@
+#ifndef RESIN_FRAME_SCHEDULER_HPP
+#define RESIN_FRAME_SCHEDULER_HPP
+
+#include <chrono>
+
+namespace resin {
+
+/*
+  Paces the frames of the application loop to a target frame time.
+
+  Sleeping alone is too coarse, since the OS may wake the thread a millisecond or more late, while spinning until the
+  deadline wastes a whole core. The scheduler therefore sleeps in short steps while the remaining time exceeds the
+  estimated sleep error, and spins (yielding) only for the rest. The estimate adapts to the measured sleep durations,
+  so the spinning stays short on systems with precise timers.
+
+  Deadlines advance by the frame time from the previous deadline rather than from the wake-up time, so the frame rate
+  does not drift. If a frame takes too long, the schedule restarts from the current time instead of rushing to catch
+  up.
+*/
+class FrameScheduler {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit FrameScheduler(clock::duration frame_time);
+
+  clock::duration frame_time() const { return frame_time_; }
+  // Zero disables the pacing, e.g. when vsync already blocks in the buffer swap.
+  void set_frame_time(clock::duration frame_time);
+
+  // Blocks until the start of the next frame.
+  void wait_for_next_frame();
+
+ private:
+  void sleep_until(clock::time_point deadline);
+  void record_sleep(clock::duration requested, clock::duration slept);
+
+ private:
+  static constexpr clock::duration kSleepStep     = std::chrono::milliseconds(1);
+  static constexpr clock::duration kMaxSleepError = std::chrono::microseconds(500);
+
+  clock::duration frame_time_;
+  clock::time_point next_frame_;
+
+  // Running mean and mean deviation of the time a single sleep step oversleeps
+  clock::duration sleep_error_mean_;
+  clock::duration sleep_error_deviation_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_FRAME_SCHEDULER_HPP
@@ -4,7 +4,7 @@
 #include <memory>
 #include <resin/core/graphics_context.hpp>
 #include <resin/core/window.hpp>
-#include <resin/event/event.hpp>
+#include <resin/event/event_queue.hpp>
 #include <resin/event/window_events.hpp>
 #include <stdexcept>
 #include <string_view>
@@ -68,10 +68,10 @@ Window::Window(WindowProperties properties) : properties_(std::move(properties))
 
   glfwSwapInterval(properties_.vsync ? 1 : 0);
 
-  if (properties_.eventDispatcher.has_value()) {
+  if (properties_.eventQueue.has_value()) {
     set_glfw_callbacks();
   } else {
-    Logger::warn("Window {} created without event dispatcher!", properties_.title);
+    Logger::warn("Window {} created without event queue!", properties_.title);
   }
 
   Logger::info("Created window {} ({} x {})", properties_.title, properties_.width, properties_.height);
@@ -80,9 +80,7 @@ Window::Window(WindowProperties properties) : properties_(std::move(properties))
 void Window::set_glfw_callbacks() const {
   glfwSetWindowCloseCallback(window_ptr_, [](GLFWwindow* window) {
     const WindowProperties& properties = *static_cast<WindowProperties*>(glfwGetWindowUserPointer(window));
-
-    WindowCloseEvent window_close_event;
-    properties.eventDispatcher->get().dispatch(window_close_event);
+    properties.eventQueue->get().enqueue<WindowCloseEvent>();
   });
 
   glfwSetWindowSizeCallback(window_ptr_, [](GLFWwindow* window, int width, int height) {
@@ -90,8 +88,12 @@ void Window::set_glfw_callbacks() const {
     properties.width             = static_cast<unsigned int>(width);
     properties.height            = static_cast<unsigned int>(height);
 
-    WindowResizeEvent window_resize_event(properties.width, properties.height);
-    properties.eventDispatcher->get().dispatch(window_resize_event);
+    properties.eventQueue->get().enqueue<WindowResizeEvent>(properties.width, properties.height);
+  });
+
+  glfwSetWindowFocusCallback(window_ptr_, [](GLFWwindow* window, int focused) {
+    const WindowProperties& properties = *static_cast<WindowProperties*>(glfwGetWindowUserPointer(window));
+    properties.eventQueue->get().enqueue<WindowFocusEvent>(focused == GLFW_TRUE);
   });
 }
 
@@ -104,14 +106,14 @@ Window::~Window() {
   }
 }
 
-void Window::on_update() {
-  glfwPollEvents();
-  context_->swap_buffers();
-}
+void Window::poll_events() { glfwPollEvents(); }
+
+void Window::on_update() { context_->swap_buffers(); }
 
 void Window::set_title(std::string_view title) {
-  glfwSetWindowTitle(window_ptr_, title.data());
+  // Copied first, the view does not have to be null-terminated. The assignment reuses the capacity of the old title.
   properties_.title = title;
+  glfwSetWindowTitle(window_ptr_, properties_.title.c_str());
 }
 
 void Window::set_pos(glm::ivec2 pos) {
@@ -9,7 +9,7 @@
 #include <memory>
 #include <optional>
 #include <resin/core/graphics_context.hpp>
-#include <resin/event/event.hpp>
+#include <resin/event/event_queue.hpp>
 #include <string>
 
 namespace resin {
@@ -25,7 +25,7 @@ struct WindowProperties {
   bool vsync      = false;
   bool fullscreen = false;  // TODO(SDF-72): proper fullscreen handling
 
-  std::optional<std::reference_wrapper<EventDispatcher>> eventDispatcher;
+  std::optional<std::reference_wrapper<EventQueue>> eventQueue;
 };
 
 class Window {
@@ -33,6 +33,8 @@ class Window {
   explicit Window(WindowProperties properties);
   ~Window();
 
+  // Collects the window system events into the event queue.
+  void poll_events();
   void on_update();
 
   inline std::string_view title() const { return properties_.title; }
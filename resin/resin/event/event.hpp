@@ -1,11 +1,18 @@
 #ifndef RESIN_EVENT_HPP
 #define RESIN_EVENT_HPP
 
+#include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <format>
-#include <functional>
-#include <string>
-#include <unordered_map>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #define EVENT_NAME(eventType) \
   static constexpr const char* name() { return #eventType; }
@@ -15,15 +22,29 @@
 
 namespace resin {
 
-enum class EventType { None = 0, WindowCloseEvent, WindowResizeEvent };
+// Size of the buffer events are formatted into when they are passed to `std::format`. Longer text is truncated.
+static constexpr size_t kEventFormatBufferSize = 128;
+
+// Formats into the buffer without allocating and returns the written text, which is truncated to the buffer size.
+template <typename... Args>
+std::string_view format_event(std::span<char> buffer, std::format_string<Args...> fmt, Args&&... args) {
+  const auto result = std::format_to_n(buffer.data(), static_cast<std::ptrdiff_t>(buffer.size()), fmt,
+                                       std::forward<Args>(args)...);
+  return {buffer.data(), result.out};
+}
+
+enum class EventType : uint8_t { None = 0, WindowCloseEvent, WindowResizeEvent, WindowFocusEvent, Count };
+
+static constexpr size_t kEventTypeCount = static_cast<size_t>(EventType::Count);
 
 class BaseEvent {
  public:
   BaseEvent()          = default;
   virtual ~BaseEvent() = default;
 
-  virtual EventType event_type() const  = 0;
-  virtual std::string to_string() const = 0;
+  virtual EventType event_type() const = 0;
+  // Writes the description of the event into the buffer and returns it (see `format_event`).
+  virtual std::string_view format_to(std::span<char> buffer) const = 0;
 
   BaseEvent(const BaseEvent&)            = delete;
   BaseEvent(BaseEvent&&)                 = delete;
@@ -38,12 +59,17 @@ class Event : public BaseEvent {
  public:
   static constexpr EventType type() { return Type; }
   constexpr EventType event_type() const override { return type(); }
+
+  // Whether only the latest event of the type is kept in a batch of queued events (see `EventQueue`). Events that
+  // describe a state rather than a change override it to return true.
+  static constexpr bool coalesced() { return false; }
 };
 
 template <typename E>
 concept EventConcept = std::derived_from<E, BaseEvent> && requires(E a) {
   { E::name() } -> std::same_as<const char*>;
   { E::type() } -> std::same_as<EventType>;
+  { E::coalesced() } -> std::same_as<bool>;
 };
 
 template <typename T, typename E>
@@ -51,32 +77,66 @@ concept EventHandler = EventConcept<E> && requires(T t, E& e) {
   { t(e) } -> std::same_as<bool>;
 };
 
-class EventDispatcher {  // TODO(SDF-73): implement event bus and event section of app loop
+/*
+  Event callback stored in place, without any allocation. Calling it is a single indirect call that casts the event
+  to its concrete type. The callable has to be small and trivially copyable, which lambdas capturing `this` (see
+  `BIND_EVENT_METHOD`) or a few pointers are.
+*/
+class EventDelegate {
  public:
-  template <typename E>
-  using callback_t = std::function<bool(E&)>;
+  static constexpr size_t kStorageSize = 2 * sizeof(void*);
 
+  template <EventConcept E, EventHandler<E> F>
+  static EventDelegate create(const F& callback) {
+    static_assert(sizeof(F) <= kStorageSize && alignof(F) <= alignof(void*),
+                  "Event callback is too big, capture pointers instead of objects");
+    static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>,
+                  "Event callback must be trivially copyable, capture pointers instead of objects");
+
+    EventDelegate delegate;
+    ::new (delegate.storage_.data()) F(callback);
+    delegate.invoke_ = [](std::byte* storage, BaseEvent& event) -> bool {
+      return (*std::launder(reinterpret_cast<F*>(storage)))(static_cast<E&>(event));
+    };
+    return delegate;
+  }
+
+  bool operator()(BaseEvent& event) { return invoke_(storage_.data(), event); }
+
+ private:
+  EventDelegate() = default;
+
+  alignas(void*) std::array<std::byte, kStorageSize> storage_{};
+  bool (*invoke_)(std::byte*, BaseEvent&) = nullptr;
+};
+
+/*
+  Forwards events to the callbacks subscribed to their type. Subscribers are kept in a table indexed directly by
+  `EventType`, so a dispatch is an array access followed by a call of each subscriber until one handles the event.
+*/
+class EventDispatcher {
+ public:
   template <EventConcept E, EventHandler<E> F>
   void subscribe(const F& callback_fn) {
-    const EventType type = E::type();
-    subscribers_[type].push_back(CallbackWrapper<E>(callback_fn));
+    subscribers_[index<E>()].push_back(EventDelegate::create<E>(callback_fn));
   }
 
   template <EventConcept E>
   bool dispatch(E& event) {
-    const EventType type = E::type();
-    for (auto& callback : subscribers_[type]) {
-      event.handled |= callback(event);
-      if (event.handled) {
-        return true;
-      }
-    }
-    return false;
+    return dispatch_to(subscribers_[index<E>()], event);
+  }
+
+  bool dispatch(BaseEvent& event) { return dispatch_to(subscribers_[static_cast<size_t>(event.event_type())], event); }
+
+ private:
+  template <EventConcept E>
+  static constexpr size_t index() {
+    static_assert(E::type() < EventType::Count, "Event type out of range");
+    return static_cast<size_t>(E::type());
   }
 
-  bool dispatch(BaseEvent& event) {
-    const EventType type = event.event_type();
-    for (auto& callback : subscribers_[type]) {
+  static bool dispatch_to(std::vector<EventDelegate>& subscribers, BaseEvent& event) {
+    for (auto& callback : subscribers) {
       event.handled |= callback(event);
       if (event.handled) {
         return true;
@@ -86,24 +146,13 @@ class EventDispatcher {  // TODO(SDF-73): implement event bus and event section
   }
 
  private:
-  std::unordered_map<EventType, std::vector<callback_t<BaseEvent>>> subscribers_;
-
-  template <EventConcept E>
-  class CallbackWrapper {
-   public:
-    template <EventHandler<E> F>
-    explicit CallbackWrapper(const F& callback) : callback_(callback) {}
-
-    bool operator()(BaseEvent& event) { return callback_(static_cast<E&>(event)); }
-
-   private:
-    callback_t<E> callback_;
-  };
+  std::array<std::vector<EventDelegate>, kEventTypeCount> subscribers_;
 };
 
 }  // namespace resin
 
-template <resin::EventConcept E>
+template <typename E>
+  requires std::derived_from<E, resin::BaseEvent>
 struct std::formatter<E> {
   template <class ParseContext>
   constexpr auto parse(ParseContext& ctx) {
@@ -112,7 +161,9 @@ struct std::formatter<E> {
 
   template <typename FormatContext>
   auto format(const resin::BaseEvent& obj, FormatContext& ctx) const {
-    return std::format_to(ctx.out(), "{}", obj.to_string());
+    std::array<char, resin::kEventFormatBufferSize> buffer;
+    const std::string_view text = obj.format_to(buffer);
+    return std::copy(text.begin(), text.end(), ctx.out());
   }
 };
 
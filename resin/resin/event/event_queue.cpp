@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <libresin/utils/logger.hpp>
+#include <memory>
+#include <resin/event/event.hpp>
+#include <resin/event/event_queue.hpp>
+#include <utility>
+
+namespace resin {
+
+EventQueue::Batch::Batch(size_t size) : arena(std::make_unique<std::byte[]>(size)), arena_size(size) {
+  coalesced.fill(kNoIndex);
+}
+
+void* EventQueue::Batch::allocate(size_t size, size_t alignment) {
+  const size_t offset = (used + alignment - 1) & ~(alignment - 1);
+  if (offset + size > arena_size) {
+    return nullptr;
+  }
+
+  used = offset + size;
+  return arena.get() + offset;
+}
+
+void EventQueue::Batch::clear() {
+  for (BaseEvent* event : events) {
+    if (event != nullptr) {
+      std::destroy_at(event);
+    }
+  }
+
+  events.clear();
+  coalesced.fill(kNoIndex);
+  used = 0;
+}
+
+EventQueue::EventQueue(size_t arena_size) : batches_{Batch(arena_size), Batch(arena_size)} {}
+
+EventQueue::~EventQueue() {
+  for (Batch& batch : batches_) {
+    batch.clear();
+  }
+}
+
+size_t EventQueue::dispatch(EventDispatcher& dispatcher) {
+  if (const size_t dropped = std::exchange(dropped_, 0) + posted_.take_dropped_count(); dropped > 0) {
+    Logger::warn("Event queue overflow, dropped {} events", dropped);
+  }
+
+  // Handlers enqueue into the other batch, so the dispatched one does not change
+  Batch& batch = batches_[current_];
+  current_     = 1 - current_;
+
+  size_t dispatched = 0;
+  for (BaseEvent* event : batch.events) {
+    if (event != nullptr) {
+      dispatcher.dispatch(*event);
+      ++dispatched;
+    }
+  }
+
+  batch.clear();
+  return dispatched + posted_.drain(dispatcher);
+}
+
+size_t EventQueue::size() const {
+  const Batch& batch = batches_[current_];
+  return static_cast<size_t>(
+      std::ranges::count_if(batch.events, [](const BaseEvent* event) { return event != nullptr; }));
+}
+
+}  // namespace resin
@@ -0,0 +1,103 @@
+#ifndef RESIN_EVENT_QUEUE_HPP
+#define RESIN_EVENT_QUEUE_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <resin/event/event.hpp>
+#include <resin/event/mpsc_event_queue.hpp>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+/*
+  Collects the events of a frame and dispatches them in one batch at a defined point of the application loop, instead
+  of in the middle of the window system callbacks.
+
+  Events are constructed in place in an arena of a fixed size that is reset after every batch, so enqueuing never
+  allocates and the number of events handled per frame is bounded. Events that do not fit are dropped. Events with
+  `coalesced()` types keep only their latest instance in a batch. Events enqueued by the handlers during a dispatch
+  go to the next batch.
+
+  `enqueue` may be called only from the thread that dispatches, other threads `post` their events into a lock-free
+  queue that is drained after the batch (see `MpscEventQueue`).
+*/
+class EventQueue {
+ public:
+  static constexpr size_t kDefaultArenaSize = size_t{64} << 10U;
+
+  explicit EventQueue(size_t arena_size = kDefaultArenaSize);
+  ~EventQueue();
+
+  EventQueue(const EventQueue&)            = delete;
+  EventQueue(EventQueue&&)                 = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+  EventQueue& operator=(EventQueue&&)      = delete;
+
+  // Returns false if the event has been dropped, because the arena of the current batch is full.
+  template <EventConcept E, typename... Args>
+  bool enqueue(Args&&... args) {
+    static_assert(alignof(E) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Event type is over-aligned");
+
+    Batch& batch = batches_[current_];
+    void* memory = batch.allocate(sizeof(E), alignof(E));
+    if (memory == nullptr) {
+      ++dropped_;
+      return false;
+    }
+
+    E* event = ::new (memory) E(std::forward<Args>(args)...);
+    if constexpr (E::coalesced()) {
+      size_t& index = batch.coalesced[static_cast<size_t>(E::type())];
+      if (index != kNoIndex) {
+        std::destroy_at(batch.events[index]);
+        batch.events[index] = nullptr;
+      }
+      index = batch.events.size();
+    }
+    batch.events.push_back(event);
+    return true;
+  }
+
+  // Thread-safe. Returns false if the event has been dropped, because the queue of posted events is full.
+  template <EventConcept E, typename... Args>
+  bool post(Args&&... args) {
+    return posted_.template post<E>(std::forward<Args>(args)...);
+  }
+
+  // Dispatches the events enqueued so far in the order of enqueuing and returns their number.
+  size_t dispatch(EventDispatcher& dispatcher);
+
+  size_t size() const;
+  // Number of events dropped by `enqueue` since the previous dispatch.
+  size_t dropped_count() const { return dropped_; }
+
+ private:
+  static constexpr size_t kNoIndex = static_cast<size_t>(-1);
+
+  struct Batch {
+    explicit Batch(size_t size);
+
+    void* allocate(size_t size, size_t alignment);
+    void clear();
+
+    std::unique_ptr<std::byte[]> arena;
+    size_t arena_size;
+    size_t used = 0;
+    std::vector<BaseEvent*> events;
+    // Position of the event of every coalesced type in `events`
+    std::array<size_t, kEventTypeCount> coalesced;
+  };
+
+ private:
+  std::array<Batch, 2> batches_;
+  MpscEventQueue posted_;
+  size_t current_ = 0;
+  size_t dropped_ = 0;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_EVENT_QUEUE_HPP
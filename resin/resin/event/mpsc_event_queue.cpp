@@ -0,0 +1,51 @@
+#include <bit>
+#include <memory>
+#include <resin/event/event.hpp>
+#include <resin/event/mpsc_event_queue.hpp>
+
+namespace resin {
+
+MpscEventQueue::MpscEventQueue(size_t capacity)
+    : cells_(std::make_unique<Cell[]>(std::bit_ceil(capacity))), mask_(std::bit_ceil(capacity) - 1) {
+  for (size_t i = 0; i <= mask_; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+MpscEventQueue::~MpscEventQueue() {
+  // Destroys the events which were posted, but never drained
+  while (true) {
+    Cell& cell = cells_[head_ & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+      break;
+    }
+    if (cell.event != nullptr) {
+      std::destroy_at(cell.event);
+    }
+    ++head_;
+  }
+}
+
+size_t MpscEventQueue::drain(EventDispatcher& dispatcher) {
+  // Events posted by the handlers are left for the next drain, so a handler that posts cannot keep it running forever
+  const size_t end  = tail_.load(std::memory_order_acquire);
+  size_t dispatched = 0;
+  while (head_ != end) {
+    Cell& cell = cells_[head_ & mask_];
+    // A producer claimed the cell, but has not finished constructing the event yet
+    if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+      break;
+    }
+
+    if (cell.event != nullptr) {
+      dispatcher.dispatch(*cell.event);
+      std::destroy_at(cell.event);
+      ++dispatched;
+    }
+    cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+  }
+  return dispatched;
+}
+
+}  // namespace resin
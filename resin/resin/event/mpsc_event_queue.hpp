@@ -0,0 +1,97 @@
+#ifndef RESIN_MPSC_EVENT_QUEUE_HPP
+#define RESIN_MPSC_EVENT_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <resin/event/event.hpp>
+#include <utility>
+
+namespace resin {
+
+/*
+  Bounded multi-producer single-consumer queue of events, which may be posted from any thread without locks.
+
+  The queue is a ring of cells, each with storage for a single event, so posting constructs the event in place in a
+  pooled cell instead of allocating it. Producers claim a cell with a single CAS on the tail and publish it with the
+  cell sequence number (D. Vyukov's bounded queue). The consumer is the thread that calls `drain`, which needs no
+  atomic read-modify-write at all. When every cell is occupied the event is dropped.
+*/
+class MpscEventQueue {
+ public:
+  static constexpr size_t kCellSize        = 128;
+  static constexpr size_t kMaxEventSize    = kCellSize - 2 * sizeof(size_t);
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  // Capacity is rounded up to a power of two.
+  explicit MpscEventQueue(size_t capacity = kDefaultCapacity);
+  ~MpscEventQueue();
+
+  MpscEventQueue(const MpscEventQueue&)            = delete;
+  MpscEventQueue(MpscEventQueue&&)                 = delete;
+  MpscEventQueue& operator=(const MpscEventQueue&) = delete;
+  MpscEventQueue& operator=(MpscEventQueue&&)      = delete;
+
+  // Thread-safe. Returns false if the event has been dropped, because the queue is full.
+  template <EventConcept E, typename... Args>
+  bool post(Args&&... args) {
+    static_assert(sizeof(E) <= kMaxEventSize, "Event type is too big to be posted");
+    static_assert(alignof(E) <= alignof(std::max_align_t), "Event type is over-aligned");
+
+    size_t position = tail_.load(std::memory_order_relaxed);
+    Cell* cell      = nullptr;
+    while (true) {
+      cell                  = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+      if (difference == 0) {
+        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    // The claimed cell has to be published even if the constructor throws, otherwise the consumer would stall on it
+    try {
+      cell->event = ::new (cell->storage.data()) E(std::forward<Args>(args)...);
+    } catch (...) {
+      cell->event = nullptr;
+      cell->sequence.store(position + 1, std::memory_order_release);
+      throw;
+    }
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Dispatches the events posted before the call in the order of posting and returns their number.
+  size_t drain(EventDispatcher& dispatcher);
+
+  // Returns the number of events dropped since the previous call.
+  size_t take_dropped_count() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+ private:
+  struct alignas(kCellSize) Cell {
+    std::atomic<size_t> sequence;
+    BaseEvent* event = nullptr;
+    alignas(std::max_align_t) std::array<std::byte, kMaxEventSize> storage;
+  };
+  static_assert(sizeof(Cell) == kCellSize);
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  // Producers and the consumer touch different cache lines
+  alignas(kCellSize) std::atomic<size_t> tail_{0};
+  alignas(kCellSize) size_t head_ = 0;
+  std::atomic<size_t> dropped_{0};
+};
+
+}  // namespace resin
+
+#endif  // RESIN_MPSC_EVENT_QUEUE_HPP
@@ -2,7 +2,8 @@
 #define RESIN_WINDOW_EVENTS_HPP
 
 #include <resin/event/event.hpp>
-#include <sstream>
+#include <span>
+#include <string_view>
 
 namespace resin {
 
@@ -10,7 +11,7 @@ class WindowCloseEvent : public Event<EventType::WindowCloseEvent> {
  public:
   EVENT_NAME(WindowCloseEvent);
 
-  std::string to_string() const override { return name(); }
+  std::string_view format_to(std::span<char> buffer) const override { return format_event(buffer, "{}", name()); }
 
   WindowCloseEvent() = default;
 };
@@ -19,21 +20,39 @@ class WindowResizeEvent : public Event<EventType::WindowResizeEvent> {
  public:
   EVENT_NAME(WindowResizeEvent);
 
+  static constexpr bool coalesced() { return true; }
+
   WindowResizeEvent(unsigned int width, unsigned int height) : width_(width), height_(height){};
 
   unsigned int width() const { return width_; }
   unsigned int height() const { return height_; }
 
-  std::string to_string() const override {
-    std::stringstream ss;
-    ss << name() << ": " << width_ << " x " << height_;
-    return ss.str();
+  std::string_view format_to(std::span<char> buffer) const override {
+    return format_event(buffer, "{}: {} x {}", name(), width_, height_);
   }
 
  private:
   unsigned int width_, height_;
 };
 
+class WindowFocusEvent : public Event<EventType::WindowFocusEvent> {
+ public:
+  EVENT_NAME(WindowFocusEvent);
+
+  static constexpr bool coalesced() { return true; }
+
+  explicit WindowFocusEvent(bool focused) : focused_(focused) {}
+
+  bool focused() const { return focused_; }
+
+  std::string_view format_to(std::span<char> buffer) const override {
+    return format_event(buffer, "{}: {}", name(), focused_ ? "focused" : "unfocused");
+  }
+
+ private:
+  bool focused_;
+};
+
 }  // namespace resin
 
 #endif  // RESIN_WINDOW_EVENTS_HPP
@@ -2,24 +2,36 @@
 #include <glad/gl.h>
 #include <imgui/imgui.h>
 
+#include <cstdlib>
 #include <filesystem>
 #include <glm/glm.hpp>
 #include <libresin/utils/logger.hpp>
 #include <memory>
 #include <print>
 #include <resin/resin.hpp>
+#include <stdexcept>
 #include <version/version.hpp>
 
 int main() {
-  const size_t max_logs_backups = 4;
-  auto logs_dir                 = std::filesystem::current_path();
+  const resin::LogRotation log_rotation = {.max_backups = 4, .max_file_size = size_t{16} << 20U, .compress = true};
+  auto logs_dir                         = std::filesystem::current_path();
   logs_dir.append("logs");
   std::filesystem::create_directory(logs_dir);
 
   resin::Logger::get_instance().set_abs_build_path(RESIN_BUILD_ABS_PATH);
   resin::Logger::get_instance().add_scribe(std::make_unique<resin::TerminalLoggerScribe>());
-  resin::Logger::get_instance().add_scribe(
-      std::make_unique<resin::RotatedFileLoggerScribe>(logs_dir, max_logs_backups));
+  resin::Logger::get_instance().add_scribe(std::make_unique<resin::RotatedFileLoggerScribe>(logs_dir, log_rotation));
+  // Keep the terminal and file writes off the main loop
+  resin::Logger::get_instance().enable_async();
+
+  // E.g. RESIN_LOG=warn,sdf=debug
+  if (const char* levels = std::getenv("RESIN_LOG")) {
+    try {
+      resin::Logger::get_instance().set_levels(levels);
+    } catch (const std::invalid_argument& e) {
+      resin::Logger::warn("Ignoring RESIN_LOG: {0}", e.what());
+    }
+  }
 
   resin::Logger::info("Project version: {0}.{1}.{2}({3})", RESIN_VERSION_MAJOR, RESIN_VERSION_MINOR,
                       RESIN_VERSION_PATCH, RESIN_IS_STABLE ? "stable" : "unstable");
@@ -1,79 +1,181 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <format>
+#include <libresin/utils/job_system.hpp>
 #include <libresin/utils/logger.hpp>
+#include <libresin/utils/timing_stats.hpp>
 #include <memory>
 #include <resin/core/window.hpp>
 #include <resin/event/event.hpp>
+#include <resin/event/event_queue.hpp>
 #include <resin/event/window_events.hpp>
 #include <resin/resin.hpp>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 namespace resin {
 
 Resin::Resin() {
-  dispatcher_ = std::make_unique<EventDispatcher>();
+  // Created on the main thread, so that it owns the deque of the thread that runs the application loop
+  job_system_ = std::make_unique<JobSystem>();
+  Logger::info("Job system running on {} threads", job_system_->thread_count());
+
+  dispatcher_  = std::make_unique<EventDispatcher>();
+  event_queue_ = std::make_unique<EventQueue>();
   dispatcher_->subscribe<WindowCloseEvent>(BIND_EVENT_METHOD(on_window_close));
   dispatcher_->subscribe<WindowResizeEvent>(BIND_EVENT_METHOD(on_window_resize));
+  dispatcher_->subscribe<WindowFocusEvent>(BIND_EVENT_METHOD(on_window_focus));
 
   {
     WindowProperties properties;
-    properties.eventDispatcher = *dispatcher_;
+    properties.eventQueue = *event_queue_;
 
     window_ = std::make_unique<Window>(std::move(properties));
   }
+
+  update_frame_time();
 }
 
 void Resin::run() {
-  using clock = std::chrono::high_resolution_clock;
+  using clock = std::chrono::steady_clock;
+
+  UpdateLoopState update_state;
+  // Stopped and joined when the loop ends
+  std::jthread update_thread;
+  if (pipelined_) {
+    update_thread = std::jthread([this](std::stop_token stop_token) { run_updates(std::move(stop_token)); });
+    Logger::info("Running updates on a separate thread");
+  }
 
-  duration_t lag(0ns);
   duration_t second(0ns);
   auto previous_time = clock::now();
-
-  uint16_t frames = 0U;
-  uint16_t ticks  = 0U;
+  uint16_t frames    = 0U;
+  TimingStats frame_times;
 
   while (running_) {
     auto current_time = clock::now();
-    auto delta        = current_time - previous_time;
-    previous_time     = current_time;
+    frame_times.record(current_time - previous_time);
+    second += current_time - previous_time;
+    previous_time = current_time;
 
-    lag += std::chrono::duration_cast<duration_t>(delta);
-    second += std::chrono::duration_cast<duration_t>(delta);
+    // Events are handled also when the window is minimized, otherwise it could never be restored
+    window_->poll_events();
+    event_queue_->dispatch(*dispatcher_);
 
-    // TODO(SDF-73): handle events when event bus present
-
-    while (lag >= kTickTime) {
-      update(kTickTime);
-
-      lag -= kTickTime;
-      time_ += kTickTime;
-      ++ticks;
+    if (!pipelined_) {
+      advance(update_state, frame_scheduler_.frame_time());
     }
 
+    // In the pipelined mode the state may be a few ticks old, interpolating further would extrapolate
+    frame_states_.update();
+    const FrameState& state = frame_states_.read_buffer();
+    const auto since_tick   = state.lag + (clock::now() - state.published_at);
+    const float alpha       = std::min(std::chrono::duration<float>(since_tick) / kTickTime, 1.0F);
+
     ++frames;
     if (!minimized_) {
-      render();
+      render(state, alpha);
     }
 
     if (second > 1s) {
       uint16_t seconds = static_cast<uint16_t>(std::chrono::duration_cast<std::chrono::seconds>(second).count());
 
-      fps_   = static_cast<uint16_t>(frames / seconds);
-      tps_   = static_cast<uint16_t>(ticks / seconds);
-      frames = 0;
-      ticks  = 0;
-      second = 0ns;
+      frame_stats_.fps        = static_cast<uint16_t>(frames / seconds);
+      frame_stats_.frame_time = frame_times.summarize();
+      frame_stats_.ticks      = state.tick_stats;
+      frame_stats_.time       = state.time;
+      frames                  = 0;
+      second                  = 0ns;
+      frame_times.reset();
+
+      update_title();
     }
+
+    frame_scheduler_.wait_for_next_frame();
+  }
+}
+
+void Resin::run_updates(std::stop_token stop_token) {
+  UpdateLoopState state;
+  FrameScheduler tick_scheduler(kTickTime);
+  while (!stop_token.stop_requested()) {
+    advance(state, tick_scheduler.frame_time());
+    tick_scheduler.wait_for_next_frame();
   }
 }
 
-void Resin::update(duration_t) {
-  window_->set_title(std::format("Resin [{} FPS {} TPS] running for: {}", fps_, tps_,
-                                 std::chrono::duration_cast<std::chrono::seconds>(time_)));
+void Resin::advance(UpdateLoopState& state, duration_t frame_time) {
+  using clock = std::chrono::steady_clock;
+
+  const auto current_time = clock::now();
+  const auto delta        = current_time - state.previous_time;
+  state.previous_time     = current_time;
+  state.lag += delta;
+  state.second += delta;
+
+  // The ticks due within the frame time are not catching up, a throttled frame is expected to run several of them
+  const auto due_ticks     = static_cast<uint16_t>((frame_time + kTickTime - 1ns) / kTickTime);
+  const uint16_t max_ticks = static_cast<uint16_t>(due_ticks + max_catch_up_ticks());
+  const duration_t budget  = tick_budget();
+
+  for (uint16_t frame_ticks = 0; state.lag >= kTickTime && frame_ticks < max_ticks; ++frame_ticks) {
+    const auto tick_start = clock::now();
+    update(kTickTime);
+
+    state.lag -= kTickTime;
+    time_ += kTickTime;
+    ++state.ticks;
+
+    const auto tick_time = clock::now() - tick_start;
+    state.tick_times.record(tick_time);
+    if (tick_time > budget) {
+      ++state.late_ticks;
+      break;
+    }
+  }
+
+  // Whatever could not be caught up with in this frame is dropped, otherwise the next frames would have even more
+  // ticks to run and fall further behind
+  if (state.lag >= kTickTime) {
+    state.dropped_ticks = static_cast<uint16_t>(state.dropped_ticks + state.lag / kTickTime);
+    state.lag %= kTickTime;
+  }
+
+  if (state.second > 1s) {
+    uint16_t seconds = static_cast<uint16_t>(std::chrono::duration_cast<std::chrono::seconds>(state.second).count());
+
+    state.stats.tps         = static_cast<uint16_t>(state.ticks / seconds);
+    state.stats.dropped_tps = static_cast<uint16_t>(state.dropped_ticks / seconds);
+    state.stats.late_tps    = static_cast<uint16_t>(state.late_ticks / seconds);
+    state.stats.tick_time   = state.tick_times.summarize();
+    if (state.dropped_ticks > 0) {
+      Logger::warn("Falling behind: dropped {} ticks, {} ticks over the budget of {}", state.dropped_ticks,
+                   state.late_ticks, std::chrono::duration_cast<std::chrono::microseconds>(budget));
+    }
+
+    state.ticks         = 0;
+    state.dropped_ticks = 0;
+    state.late_ticks    = 0;
+    state.second        = 0ns;
+    state.tick_times.reset();
+  }
+
+  FrameState& frame_state  = frame_states_.write_buffer();
+  frame_state.time         = time_;
+  frame_state.lag          = state.lag;
+  frame_state.published_at = current_time;
+  frame_state.tick_stats   = state.stats;
+  frame_states_.publish();
 }
 
-void Resin::render() { window_->on_update(); }
+void Resin::update(duration_t) {}
+
+void Resin::render(const FrameState&, float) { window_->on_update(); }
 
 bool Resin::on_window_close(WindowCloseEvent&) {
   running_ = false;
@@ -82,14 +184,50 @@ bool Resin::on_window_close(WindowCloseEvent&) {
 
 bool Resin::on_window_resize(WindowResizeEvent& e) {
   Logger::debug("Handling resize: {}!", e);
-  if (e.width() == 0 || e.height() == 0) {
-    minimized_ = true;
+  minimized_ = e.width() == 0 || e.height() == 0;
+  update_frame_time();
+  if (minimized_) {
     return true;
   }
 
-  minimized_ = false;
   // TODO(SDF-28): set viewport
   return false;
 }
 
+bool Resin::on_window_focus(WindowFocusEvent& e) {
+  focused_ = e.focused();
+  update_frame_time();
+  return false;
+}
+
+void Resin::update_title() {
+  static constexpr size_t kTitleBufferSize = 160;
+  const auto ms = [](duration_t duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+  // Formatted on the stack and compared first, since setting the title copies it and goes through the window system
+  std::array<char, kTitleBufferSize> buffer;
+  const FrameStats& stats = frame_stats_;
+  const auto result       = std::format_to_n(
+      buffer.data(), static_cast<std::ptrdiff_t>(buffer.size()),
+      "Resin [{} FPS {} TPS, {} dropped {} late | frame {:.2f} ms p99 {:.2f} ms | tick {:.2f} ms p99 {:.2f} ms] "
+      "running for: {}",
+      stats.fps, stats.ticks.tps, stats.ticks.dropped_tps, stats.ticks.late_tps, ms(stats.frame_time.mean),
+      ms(stats.frame_time.p99), ms(stats.ticks.tick_time.mean), ms(stats.ticks.tick_time.p99),
+      std::chrono::duration_cast<std::chrono::seconds>(stats.time));
+
+  const std::string_view title(buffer.data(), result.out);
+  if (title != window_->title()) {
+    window_->set_title(title);
+  }
+}
+
+void Resin::update_frame_time() {
+  // Buffer swaps already wait for the vertical sync, unless nothing is rendered
+  if (minimized_ || !focused_) {
+    frame_scheduler_.set_frame_time(kBackgroundFrameTime);
+  } else {
+    frame_scheduler_.set_frame_time(window_->vsync() ? duration_t::zero() : kFrameTime);
+  }
+}
+
 }  // namespace resin
\ No newline at end of file
@@ -1,12 +1,20 @@
 #ifndef RESIN_HPP
 #define RESIN_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <libresin/utils/job_system.hpp>
+#include <libresin/utils/timing_stats.hpp>
+#include <libresin/utils/triple_buffer.hpp>
 #include <memory>
+#include <resin/core/frame_scheduler.hpp>
 #include <resin/core/window.hpp>
 #include <resin/event/event.hpp>
+#include <resin/event/event_queue.hpp>
 #include <resin/event/window_events.hpp>
+#include <stop_token>
 
 int main();
 
@@ -15,9 +23,59 @@ namespace resin {
 using namespace std::chrono_literals;
 using duration_t = std::chrono::nanoseconds;
 
+// Statistics of the ticks in the last second
+struct TickStats {
+  uint16_t tps = 0, dropped_tps = 0, late_tps = 0;
+  TimingSummary tick_time;
+};
+
+// Statistics of the application loop in the last second
+struct FrameStats {
+  uint16_t fps = 0;
+  TimingSummary frame_time;
+  TickStats ticks;
+  duration_t time = 0ns;
+};
+
+/*
+  State of the simulation after an update, which is rendered. The snapshot of the scene (transforms, camera, SDF
+  parameters) belongs here, so that rendering never reads the state the next update is changing.
+*/
+struct FrameState {
+  duration_t time = 0ns;
+  // Time accumulated towards the next tick when the state was published, to interpolate with
+  duration_t lag = 0ns;
+  std::chrono::steady_clock::time_point published_at;
+
+  TickStats tick_stats;
+};
+
 class Resin {
  public:
   Window& main_window() const { return *window_; }
+  // Updated once per second by the application loop.
+  const FrameStats& frame_stats() const { return frame_stats_; }
+  // Jobs may be scheduled from any thread, the main thread runs them too while it waits for them.
+  JobSystem& job_system() const { return *job_system_; }
+
+  // Maximum number of ticks run in a single frame to catch up with the real time, on top of the ticks due within the
+  // frame time itself (e.g. of a frame throttled to `kBackgroundFrameTime`). The ticks above it are dropped, so a long
+  // frame slows the simulation down instead of making every next frame longer.
+  void set_max_catch_up_ticks(uint16_t ticks) {
+    max_catch_up_ticks_.store(std::max<uint16_t>(ticks, 1), std::memory_order_relaxed);
+  }
+  uint16_t max_catch_up_ticks() const { return max_catch_up_ticks_.load(std::memory_order_relaxed); }
+
+  // A tick that takes longer than its budget is reported as late and ends the catching up in the current frame.
+  void set_tick_budget(duration_t budget) { tick_budget_.store(budget, std::memory_order_relaxed); }
+  duration_t tick_budget() const { return tick_budget_.load(std::memory_order_relaxed); }
+
+  // Runs the updates on their own thread, so that the update of the next frame overlaps with rendering the previous
+  // one. The main thread keeps the events and the graphics context. Has to be set before the application runs. Not
+  // exposed to the users until `FrameState` holds a snapshot of the scene, rendering would race with the updates.
+  void set_pipelined(bool pipelined) { pipelined_ = pipelined; }
+  bool pipelined() const { return pipelined_; }
+
   static Resin& instance() {
     static Resin instance;
     return instance;
@@ -32,25 +90,64 @@ class Resin {
   Resin();
   ~Resin() = default;
 
+  // Accumulated on the thread that runs the updates
+  struct UpdateLoopState {
+    std::chrono::steady_clock::time_point previous_time = std::chrono::steady_clock::now();
+    duration_t lag                                      = 0ns;
+    duration_t second                                   = 0ns;
+    uint16_t ticks = 0, dropped_ticks = 0, late_ticks = 0;
+    TimingStats tick_times;
+    TickStats stats;
+  };
+
   void run();
+  void run_updates(std::stop_token stop_token);
+  // Runs the ticks due since the previous call and publishes the resulting frame state. `frame_time` is the interval
+  // the calls are paced to.
+  void advance(UpdateLoopState& state, duration_t frame_time);
   void update(duration_t delta);
-  void render();
+  // Renders only the published `state`, never the one being updated. `alpha` in [0, 1] is the part of a tick elapsed
+  // since the state was published, to interpolate with. It stays at 1 while the state is late, e.g. in the pipelined
+  // mode.
+  void render(const FrameState& state, float alpha);
 
   bool on_window_close(WindowCloseEvent& e);
   bool on_window_resize(WindowResizeEvent& e);
+  bool on_window_focus(WindowFocusEvent& e);
+
+  void update_frame_time();
+  // Sets the window title to the statistics, only if they have changed.
+  void update_title();
 
  public:
-  static constexpr duration_t kTickTime = 16666us;  // 60 TPS = 16.6(6) ms/t
+  static constexpr duration_t kTickTime            = 16666us;  // 60 TPS = 16.6(6) ms/t
+  static constexpr duration_t kFrameTime           = 6944us;   // 144 FPS cap when vsync is off
+  static constexpr duration_t kBackgroundFrameTime = 100ms;    // 10 FPS when minimized or unfocused
+
+  static constexpr uint16_t kDefaultMaxCatchUpTicks = 5;
+  static constexpr duration_t kDefaultTickBudget    = kTickTime / 2;
 
  private:
+  std::unique_ptr<JobSystem> job_system_;
   std::unique_ptr<Window> window_;
   std::unique_ptr<EventDispatcher> dispatcher_;
+  std::unique_ptr<EventQueue> event_queue_;
+  FrameScheduler frame_scheduler_{kFrameTime};
+  TripleBuffer<FrameState> frame_states_;
 
   bool running_   = true;
+  bool pipelined_ = false;
   bool minimized_ = false;
+  bool focused_   = true;
 
+  // Set on the main thread, read by the thread that runs the updates
+  std::atomic<uint16_t> max_catch_up_ticks_ = kDefaultMaxCatchUpTicks;
+  std::atomic<duration_t> tick_budget_      = kDefaultTickBudget;
+
+  // Owned by the thread that runs the updates
   duration_t time_ = 0ns;
-  uint16_t fps_ = 0, tps_ = 0;
+
+  FrameStats frame_stats_;
   friend int ::main();
 };
 